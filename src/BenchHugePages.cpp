@@ -0,0 +1,181 @@
+/*
+ * TLB pressure of large buffers with and without huge pages
+ *
+ * Walks a multi-second sized IQ buffer the way a waterfall or STFT history is
+ * read (strided row reads) and counts dTLB load misses with perf_event_open.
+ * Without perf access (containers, perf_event_paranoid) only timings are shown.
+ */
+
+#include "BufferMemory.h"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <complex>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using Sample = std::complex<float>;
+
+static constexpr size_t BUFFER_BYTES = size_t(256) << 20;
+static constexpr size_t ROW_SAMPLES = 4097;		// Waterfall row, 8192 point FFT
+static constexpr int PASSES = 8;
+
+static volatile float g_sink;
+
+struct Result {
+	double seconds;
+	long long tlb_misses;	// -1 if unavailable
+	size_t huge_kb;			// Huge page backed kB reported by smaps
+};
+
+class TlbCounter {
+public:
+	TlbCounter() {
+#ifdef __linux__
+		perf_event_attr attr;
+		std::memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HW_CACHE;
+		attr.config = PERF_COUNT_HW_CACHE_DTLB |
+			(PERF_COUNT_HW_CACHE_OP_READ << 8) |
+			(PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+		attr.disabled = 1;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+	}
+	~TlbCounter() {
+#ifdef __linux__
+		if (fd_ >= 0) close(fd_);
+#endif
+	}
+	void Start() {
+#ifdef __linux__
+		if (fd_ < 0) return;
+		ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+		ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+	}
+	long long Stop() {
+#ifdef __linux__
+		if (fd_ < 0) return -1;
+		ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+		long long count = 0;
+		if (read(fd_, &count, sizeof(count)) != sizeof(count)) return -1;
+		return count;
+#else
+		return -1;
+#endif
+	}
+private:
+	int fd_ = -1;
+};
+
+// AnonHugePages + hugetlb size for the mapping containing addr
+static size_t HugeKb(const void* addr) {
+	std::ifstream smaps("/proc/self/smaps");
+	std::string line;
+	uintptr_t target = reinterpret_cast<uintptr_t>(addr);
+	bool in_range = false;
+	size_t kb = 0;
+	while (std::getline(smaps, line)) {
+		uintptr_t lo, hi;
+		char dash;
+		std::istringstream header(line);
+		if (header >> std::hex >> lo >> dash >> hi && dash == '-') {
+			in_range = target >= lo && target < hi;
+			continue;
+		}
+		if (!in_range) continue;
+		std::istringstream field(line);
+		std::string key;
+		size_t value = 0;
+		field >> key >> value;
+		if (key == "AnonHugePages:" || key == "Private_Hugetlb:" || key == "Shared_Hugetlb:") {
+			kb += value;
+		}
+	}
+	return kb;
+}
+
+static Result Run(const MemoryPolicy& policy) {
+	void* memory = BufferMemory::allocate(BUFFER_BYTES, policy);
+	if (!memory) {
+		return {0.0, -1, 0};
+	}
+	Sample* samples = static_cast<Sample*>(memory);
+	size_t count = BUFFER_BYTES / sizeof(Sample);
+	for (size_t i = 0; i < count; ++i) {
+		samples[i] = Sample(float(i & 1023), 0.0f);
+	}
+
+	// Column reads across rows, as when building a waterfall column or an
+	// STFT frame from history: one touch per row, rows a page or more apart
+	size_t rows = count / ROW_SAMPLES;
+	TlbCounter counter;
+	float sink = 0.0f;
+	auto start = std::chrono::steady_clock::now();
+	counter.Start();
+	for (int pass = 0; pass < PASSES; ++pass) {
+		for (size_t column = 0; column < ROW_SAMPLES; column += 61) {
+			for (size_t row = 0; row < rows; ++row) {
+				sink += samples[row * ROW_SAMPLES + column].real();
+			}
+		}
+	}
+	long long misses = counter.Stop();
+	double seconds = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - start).count();
+	size_t huge_kb = HugeKb(memory);
+	BufferMemory::deallocate(memory, BUFFER_BYTES, policy);
+	g_sink = sink;	// Keep the loop alive
+	return {seconds, misses, huge_kb};
+}
+
+static void Print(const char* name, const Result& r) {
+	std::cout << "  " << std::left << std::setw(10) << name << std::right
+		<< std::fixed << std::setprecision(3) << std::setw(8) << r.seconds << " s   ";
+	if (r.tlb_misses >= 0) {
+		std::cout << std::setw(12) << r.tlb_misses << " dTLB misses   ";
+	} else {
+		std::cout << std::setw(12) << "n/a" << " dTLB misses   ";
+	}
+	std::cout << std::setw(8) << r.huge_kb / 1024 << " MB on huge pages" << std::endl;
+}
+
+int main() {
+	std::cout << "=== Huge page buffers (" << (BUFFER_BYTES >> 20)
+		<< " MB, strided row reads) ===" << std::endl;
+
+	MemoryPolicy small;
+	small.numa_node = MemoryPolicy::NUMA_LOCAL;
+	MemoryPolicy huge2m = MemoryPolicy::largeBuffer();
+	MemoryPolicy huge1g = MemoryPolicy::largeBuffer();
+	huge1g.page_size = MemoryPolicy::PageSize::Huge1G;
+
+	Result base = Run(small);
+	Print("4K", base);
+	Result r2m = Run(huge2m);
+	Print("2M", r2m);
+	Result r1g = Run(huge1g);
+	Print("1G", r1g);
+
+	if (base.tlb_misses > 0 && r2m.tlb_misses >= 0) {
+		std::cout << "  dTLB miss reduction (2M): " << std::setprecision(1)
+			<< 100.0 * (1.0 - double(r2m.tlb_misses) / base.tlb_misses) << "%" << std::endl;
+	}
+	std::cout << "  Time speedup (2M): " << std::setprecision(2)
+		<< base.seconds / r2m.seconds << "x" << std::endl;
+	return 0;
+}
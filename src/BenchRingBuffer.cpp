@@ -0,0 +1,85 @@
+/*
+ * Throughput of CircularBuffer vs SPSCRingBuffer on the IQ path
+ *
+ * Producer mimics the RX thread pushing complex<float> blocks as fast as it
+ * can, the reader mimics the GUI/STFT thread copying the retained window and
+ * polling Size() in a loop.
+ */
+
+#include "CircularBuffer.h"
+#include "SPSCRingBuffer.h"
+#include <iostream>
+#include <iomanip>
+#include <complex>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+using Sample = std::complex<float>;
+
+static constexpr size_t CAPACITY = 131072;
+static constexpr size_t BLOCK = 4096;
+static constexpr size_t WINDOW = 61952;		// STFT window in SignalGui
+static constexpr double DURATION_S = 2.0;
+
+struct Result {
+	double producer_msps;
+	size_t reader_copies;
+};
+
+template<typename Buffer>
+Result Run() {
+	Buffer buffer(CAPACITY);
+	std::atomic<bool> stop{false};
+	std::atomic<size_t> copies{0};
+
+	std::thread reader([&]() {
+		std::vector<Sample> window(WINDOW);
+		while (!stop.load(std::memory_order_relaxed)) {
+			if (buffer.Size() >= WINDOW) {
+				buffer.CopyLatest(window.data(), WINDOW);
+				copies.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+	});
+
+	std::vector<Sample> block(BLOCK, Sample(1.0f, -1.0f));
+	size_t pushed = 0;
+	auto start = std::chrono::steady_clock::now();
+	auto deadline = start + std::chrono::duration<double>(DURATION_S);
+	while (std::chrono::steady_clock::now() < deadline) {
+		for (int i = 0; i < 64; ++i) {
+			buffer.PushBulk(block.data(), BLOCK);
+		}
+		pushed += 64 * BLOCK;
+	}
+	double seconds = std::chrono::duration<double>(
+			std::chrono::steady_clock::now() - start).count();
+	stop.store(true);
+	reader.join();
+
+	return {pushed / seconds / 1e6, copies.load()};
+}
+
+static void Print(const char* name, const Result& r) {
+	std::cout << "  " << std::left << std::setw(16) << name
+		<< std::right << std::fixed << std::setprecision(1)
+		<< std::setw(10) << r.producer_msps << " MS/s   "
+		<< std::setw(8) << r.reader_copies << " window copies" << std::endl;
+}
+
+int main() {
+	std::cout << "=== Ring buffer throughput (complex<float>, block "
+		<< BLOCK << ", window " << WINDOW << ") ===" << std::endl;
+
+	Result locked = Run<CircularBuffer<Sample>>();
+	Print("CircularBuffer", locked);
+
+	Result lockfree = Run<SPSCRingBuffer<Sample>>();
+	Print("SPSCRingBuffer", lockfree);
+
+	std::cout << "  Speedup: " << std::setprecision(2)
+		<< lockfree.producer_msps / locked.producer_msps << "x" << std::endl;
+	return 0;
+}
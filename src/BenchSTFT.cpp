@@ -0,0 +1,114 @@
+/*
+ * STFT batching and frame parallelism
+ *
+ * First times the serial batched STFTSpectrogram against the old per-frame
+ * path (PerFrameSTFT) on the 1024 x 120 display tile and the 1024 x 1024
+ * tile the RFML model takes, checking both produce the same bits. Then
+ * computes the 1024 x 1024 tile with 2..N pool workers and reports time per
+ * tile, speedup and parallel efficiency, each checked bit for bit against
+ * the serial one. Numbers are only meaningful linked against the real PFFFT.
+ */
+
+#include "STFTSpectrogram.h"
+#include "STFTReference.h"
+#include "WorkStealingPool.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <complex>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+static constexpr int FFT_SIZE = 1024;
+static constexpr int FFT_STRIDE = 512;
+static constexpr int TIME_FRAMES = 1024;
+static constexpr int REPEATS = 10;
+
+// Best of REPEATS, in milliseconds per call
+template<typename Run>
+static double BestOf(Run run) {
+	double best = 1e30;
+	for (int r = 0; r < REPEATS; ++r) {
+		auto start = std::chrono::steady_clock::now();
+		run();
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		best = std::min(best, elapsed.count());
+	}
+	return best;
+}
+
+static double TimeTile(STFTSpectrogram& stft, const std::vector<std::complex<float>>& iq,
+					   std::vector<float>& tile) {
+	return BestOf([&]() {
+		float* out = tile.data();
+		int bins = 0;
+		int frames = 0;
+		stft.computeSpectrogram(iq.data(), iq.size(), &out, &bins, &frames);
+	});
+}
+
+// Serial per-frame vs batched on one tile size; false if the images differ
+static bool CompareBatched(const std::vector<std::complex<float>>& all_iq, int time_frames) {
+	size_t num_samples = FFT_SIZE + static_cast<size_t>(time_frames - 1) * FFT_STRIDE;
+	std::vector<std::complex<float>> iq(all_iq.begin(), all_iq.begin() + num_samples);
+	STFTSpectrogram stft(FFT_SIZE, FFT_STRIDE, 1e6f);
+	PerFrameSTFT reference(FFT_SIZE, FFT_STRIDE);
+	std::vector<float> batched(static_cast<size_t>(FFT_SIZE) * time_frames);
+	std::vector<float> per_frame(batched.size());
+
+	double old_ms = BestOf([&]() { reference.compute(iq.data(), iq.size(), per_frame.data()); });
+	double new_ms = TimeTile(stft, iq, batched);
+	bool same = std::memcmp(batched.data(), per_frame.data(), batched.size() * sizeof(float)) == 0;
+	std::cout << std::fixed << std::setprecision(2)
+			  << "  " << FFT_SIZE << " x " << std::setw(4) << time_frames << "  per-frame "
+			  << std::setw(8) << old_ms << " ms  batched " << std::setw(8) << new_ms << " ms  "
+			  << std::setw(5) << old_ms / new_ms << "x" << (same ? "" : "  OUTPUT DIFFERS")
+			  << std::endl;
+	return same;
+}
+
+int main(int argc, char** argv) {
+	size_t max_workers = std::max(8u, std::thread::hardware_concurrency());
+	if (argc > 1) {
+		max_workers = std::stoul(argv[1]);
+	}
+
+	size_t num_samples = FFT_SIZE + static_cast<size_t>(TIME_FRAMES - 1) * FFT_STRIDE;
+	std::vector<std::complex<float>> iq(num_samples);
+	std::mt19937 rng(1);
+	std::normal_distribution<float> noise(0.0f, 1.0f);
+	for (auto& sample : iq) {
+		sample = std::complex<float>(noise(rng), noise(rng));
+	}
+
+	std::cout << "Serial, batched vs per-frame" << std::endl;
+	bool identical = CompareBatched(iq, 120);
+	identical &= CompareBatched(iq, TIME_FRAMES);
+
+	STFTSpectrogram stft(FFT_SIZE, FFT_STRIDE, 1e6f);
+	std::vector<float> serial(static_cast<size_t>(FFT_SIZE) * TIME_FRAMES);
+	std::vector<float> parallel(serial.size());
+
+	std::cout << "STFT tile " << FFT_SIZE << " x " << TIME_FRAMES << ", "
+			  << std::thread::hardware_concurrency() << " hardware threads" << std::endl;
+	double serial_ms = TimeTile(stft, iq, serial);
+	std::cout << std::fixed << std::setprecision(2)
+			  << "  serial      " << std::setw(8) << serial_ms << " ms" << std::endl;
+
+	for (size_t workers = 2; workers <= max_workers; workers *= 2) {
+		WorkStealingPool pool(workers);
+		stft.setThreadPool(&pool);
+		double ms = TimeTile(stft, iq, parallel);
+		bool same = std::memcmp(serial.data(), parallel.data(), serial.size() * sizeof(float)) == 0;
+		identical &= same;
+		double speedup = serial_ms / ms;
+		std::cout << "  " << std::setw(2) << workers << " workers  " << std::setw(8) << ms << " ms  "
+				  << std::setw(5) << speedup << "x  " << std::setw(5) << 100.0 * speedup / workers
+				  << "% efficiency  " << pool.steals() << " steals"
+				  << (same ? "" : "  OUTPUT DIFFERS") << std::endl;
+		stft.setThreadPool(nullptr);
+	}
+	return identical ? 0 : 1;
+}
@@ -0,0 +1,322 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+#include "MirroredBuffer.h"
+#include "BufferStats.h"
+
+/**
+ * Single writer, multi reader broadcast ring
+ *
+ * One producer writes each sample block once; every consumer (time view,
+ * STFT, analyzer, recorder, ...) gets its own Reader with a private cursor
+ * into the same sample memory. The writer never waits for readers: a reader
+ * that falls more than a ring behind loses the oldest data, which shows up in
+ * its Overruns() counter instead of stalling the RX thread.
+ *
+ * Same indexing and validation scheme as SPSCRingBuffer: power-of-two
+ * capacity, free running counters, and a post-copy check against the
+ * producer's reservation so a read that raced an overwrite is never trusted.
+ *
+ * Storage is a MirroredBuffer, so when the double mapping is available every
+ * View is a single contiguous chunk and the STFT / framing code can run
+ * straight on ring memory. IsMirrored() tells callers whether they still need
+ * to handle the two chunk case.
+ */
+template<typename T>
+class BroadcastRing {
+	static_assert(std::is_trivially_copyable<T>::value,
+			"BroadcastRing requires trivially copyable elements");
+
+public:
+	// Read-only view into the ring, at most two contiguous chunks
+	// (always one when the ring is mirrored)
+	struct View {
+		const T* first = nullptr;
+		size_t first_size = 0;
+		const T* second = nullptr;
+		size_t second_size = 0;
+		size_t start = 0;	// Stream index of the first element
+		size_t Size() const { return first_size + second_size; }
+		bool Contiguous() const { return second_size == 0; }
+		const T& operator[](size_t i) const {
+			return i < first_size ? first[i] : second[i - first_size];
+		}
+	};
+
+	/**
+	 * Consumer handle, owned and used by a single thread. Lag() and
+	 * Overruns() may be polled from any thread for diagnostics.
+	 */
+	class Reader {
+	public:
+		// Unread samples still present in the ring
+		size_t Available() const {
+			size_t head = ring_->head_.load(std::memory_order_acquire);
+			return head - std::min(head, std::max(Cursor(), ring_->OldestValid()));
+		}
+
+		// Samples written but not yet consumed, including ones already lost
+		size_t Lag() const {
+			return ring_->head_.load(std::memory_order_acquire) - Cursor();
+		}
+
+		// Samples overwritten before this reader got to them
+		size_t Overruns() const {
+			return overruns_.load(std::memory_order_relaxed);
+		}
+
+		// Backlog and loss for this consumer; fill is Available()
+		BufferStats Stats() const {
+			BufferStats stats;
+			stats.capacity = ring_->capacity_;
+			stats.fill = Available();
+			stats.high_water = high_water_.load(std::memory_order_relaxed);
+			stats.dropped = Overruns();
+			return stats;
+		}
+
+		// Consume up to count samples into dest, returns number read
+		size_t Read(T* dest, size_t count) {
+			while (true) {
+				View view = Peek(count);
+				ring_->CopyOut(view, dest);
+				if (Consume(view.Size())) {
+					return view.Size();
+				}
+			}
+		}
+
+		/**
+		 * Zero-copy access to the next count unread samples (fewer if not
+		 * available). The view must be released with Consume(), and whatever
+		 * was computed from it is only valid if Consume() returns true
+		 */
+		View Peek(size_t count) {
+			size_t head = ring_->head_.load(std::memory_order_acquire);
+			CatchUp(head);
+			size_t cursor = Cursor();
+			if (head - cursor > high_water_.load(std::memory_order_relaxed)) {
+				high_water_.store(head - cursor, std::memory_order_relaxed);
+			}
+			return ring_->MakeView(cursor, std::min(count, head - cursor));
+		}
+
+		// Advance past n samples of the last Peek(). Returns false if the
+		// producer overwrote them while they were being used
+		bool Consume(size_t n) {
+			size_t cursor = Cursor();
+			if (!ring_->StillValid(cursor)) {
+				CatchUp(ring_->head_.load(std::memory_order_acquire));
+				return false;
+			}
+			cursor_.store(cursor + n, std::memory_order_release);
+			return true;
+		}
+
+		// Non-consuming copy of the newest count samples, zero padded
+		void CopyLatest(T* dest, size_t count) const {
+			size_t copy_count = 0;
+			while (true) {
+				size_t head = ring_->head_.load(std::memory_order_acquire);
+				size_t available = head - std::min(head, ring_->OldestValid());
+				copy_count = std::min(count, available);
+				View view = ring_->MakeView(head - copy_count, copy_count);
+				ring_->CopyOut(view, dest);
+				if (ring_->StillValid(head - copy_count)) { break; }
+			}
+			std::fill(dest + copy_count, dest + count, T{});
+		}
+
+		/**
+		 * Zero-copy, non-consuming view of the newest count samples (fewer if
+		 * the ring has not seen that many). Results derived from it are only
+		 * trustworthy if Intact() still holds once the caller is done
+		 */
+		View PeekLatest(size_t count) const {
+			size_t head = ring_->head_.load(std::memory_order_acquire);
+			size_t available = head - std::min(head, ring_->OldestValid());
+			count = std::min(count, available);
+			return ring_->MakeView(head - count, count);
+		}
+
+		// True if the producer has not overwritten any part of view yet
+		bool Intact(const View& view) const {
+			return ring_->StillValid(view.start);
+		}
+
+		// Drop everything unread except the newest keep samples
+		void SkipToLatest(size_t keep = 0) {
+			size_t head = ring_->head_.load(std::memory_order_acquire);
+			size_t backlog = head - std::min(head, std::max(Cursor(), ring_->OldestValid()));
+			if (backlog > high_water_.load(std::memory_order_relaxed)) {
+				high_water_.store(backlog, std::memory_order_relaxed);
+			}
+			size_t target = head - std::min(head, keep);
+			cursor_.store(std::max(Cursor(), target), std::memory_order_release);
+		}
+
+	private:
+		friend class BroadcastRing;
+
+		explicit Reader(const BroadcastRing* ring)
+			: ring_(ring)
+			, cursor_(ring->head_.load(std::memory_order_acquire)) {
+		}
+
+		size_t Cursor() const {
+			return cursor_.load(std::memory_order_relaxed);
+		}
+
+		// Jump over anything the producer has reclaimed, counting the loss
+		void CatchUp(size_t head) {
+			size_t cursor = Cursor();
+			size_t oldest = std::min(ring_->OldestValid(), head);
+			if (oldest > cursor) {
+				overruns_.fetch_add(oldest - cursor, std::memory_order_relaxed);
+				cursor_.store(oldest, std::memory_order_release);
+			}
+		}
+
+		const BroadcastRing* ring_;
+		std::atomic<size_t> cursor_;
+		std::atomic<size_t> overruns_{0};
+		std::atomic<size_t> high_water_{0};	// Largest backlog seen when reading
+	};
+
+private:
+	static constexpr size_t CACHE_LINE = 64;
+
+	MirroredBuffer storage_;
+	T* data_;
+	size_t capacity_;	// Power of two
+	size_t mask_;
+
+	// Producer owned: committed write count and reserved (in flight) count
+	alignas(CACHE_LINE) std::atomic<size_t> head_{0};
+	std::atomic<size_t> reserved_{0};
+
+	static size_t RoundUpPow2(size_t n) {
+		size_t p = 1;
+		while (p < n) { p <<= 1; }
+		return p;
+	}
+
+	View MakeView(size_t start, size_t count) const {
+		size_t idx = start & mask_;
+		size_t first = storage_.isMirrored() ? count : std::min(count, capacity_ - idx);
+		View view;
+		view.start = start;
+		view.first = data_ + idx;
+		view.first_size = first;
+		if (count > first) {
+			view.second = data_;
+			view.second_size = count - first;
+		}
+		return view;
+	}
+
+	static void CopyOut(const View& view, T* dest) {
+		std::memcpy(dest, view.first, view.first_size * sizeof(T));
+		if (view.second_size) {
+			std::memcpy(dest + view.first_size, view.second, view.second_size * sizeof(T));
+		}
+	}
+
+	// Oldest element the producer has not reserved for overwriting yet
+	size_t OldestValid() const {
+		size_t reserved = reserved_.load(std::memory_order_acquire);
+		return reserved > capacity_ ? reserved - capacity_ : 0;
+	}
+
+	// True if [start, ...) has not been handed back to the producer since
+	// the copy started; must be called after the copy
+	bool StillValid(size_t start) const {
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return reserved_.load(std::memory_order_relaxed) - start <= capacity_;
+	}
+
+public:
+	explicit BroadcastRing(size_t capacity, const MemoryPolicy& memory = MemoryPolicy())
+		: storage_(RoundUpPow2(std::max<size_t>(capacity, 1)) * sizeof(T), memory)
+		, data_(static_cast<T*>(storage_.data()))
+		, capacity_(storage_.size() / sizeof(T))
+		, mask_(capacity_ - 1) {
+		std::fill(data_, data_ + capacity_, T{});
+	}
+
+	BroadcastRing(const BroadcastRing&) = delete;
+	BroadcastRing& operator=(const BroadcastRing&) = delete;
+
+	// New reader positioned at the current write position
+	Reader MakeReader() const {
+		return Reader(this);
+	}
+
+	// Writable, contiguous producer span
+	struct WriteSpan {
+		T* data = nullptr;
+		size_t size = 0;
+	};
+
+	/**
+	 * Reserve up to count elements to fill in place, e.g. as a device recv()
+	 * target. The span is the full request when mirrored, otherwise it stops
+	 * at the wrap. Nothing is visible to readers until Commit()
+	 */
+	WriteSpan Reserve(size_t count) {
+		size_t head = head_.load(std::memory_order_relaxed);
+		size_t idx = head & mask_;
+		count = std::min(count, storage_.isMirrored() ? capacity_ : capacity_ - idx);
+		size_t reserved = std::max(reserved_.load(std::memory_order_relaxed), head + count);
+		reserved_.store(reserved, std::memory_order_relaxed);
+		// Readers that observe any write to the span must also observe reserved_
+		std::atomic_thread_fence(std::memory_order_release);
+		return {data_ + idx, count};
+	}
+
+	// Publish the first count elements of the last Reserve()
+	void Commit(size_t count) {
+		size_t head = head_.load(std::memory_order_relaxed);
+		count = std::min(count, reserved_.load(std::memory_order_relaxed) - head);
+		head_.store(head + count, std::memory_order_release);
+	}
+
+	// Bulk push, the only copy a sample block makes on its way in
+	void PushBulk(const T* items, size_t count) {
+		if (count > capacity_) {
+			items += count - capacity_;
+			count = capacity_;
+		}
+		size_t head = head_.load(std::memory_order_relaxed);
+		size_t reserved = std::max(reserved_.load(std::memory_order_relaxed), head + count);
+		reserved_.store(reserved, std::memory_order_relaxed);
+		// Readers that observe any write below must also observe reserved_
+		std::atomic_thread_fence(std::memory_order_release);
+
+		size_t idx = head & mask_;
+		size_t first = storage_.isMirrored() ? count : std::min(count, capacity_ - idx);
+		std::memcpy(data_ + idx, items, first * sizeof(T));
+		if (count > first) {
+			std::memcpy(data_, items + first, (count - first) * sizeof(T));
+		}
+		head_.store(head + count, std::memory_order_release);
+	}
+
+	size_t Capacity() const {
+		return capacity_;
+	}
+
+	// Views never wrap; false means the double mapping was not available
+	bool IsMirrored() const {
+		return storage_.isMirrored();
+	}
+
+	// Total number of elements ever written
+	size_t TotalWritten() const {
+		return head_.load(std::memory_order_acquire);
+	}
+};
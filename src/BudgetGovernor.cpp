@@ -0,0 +1,112 @@
+#include "BudgetGovernor.h"
+#include <algorithm>
+#include <cstdio>
+
+BudgetGovernor::BudgetGovernor()
+    : BudgetGovernor(Settings()) {
+}
+
+BudgetGovernor::BudgetGovernor(const Settings& settings)
+    : settings_(settings)
+    , calm_needed_(settings.calm_evaluations) {
+}
+
+const std::vector<BudgetLevel>& BudgetGovernor::levels() {
+    // Quality first, then whole views in order of priority: 3D, STFT, time plot
+    static const std::vector<BudgetLevel> ladder = {
+        {"full",                 1, 50, 0, true,  true,  true},
+        {"display decimation 2", 2, 50, 0, true,  true,  true},
+        {"STFT overlap 0%",      2, 0,  0, true,  true,  true},
+        {"analyzer FFT 1/2",     2, 0,  1, true,  true,  true},
+        {"3D view shed",         2, 0,  1, false, true,  true},
+        {"display decimation 4", 4, 0,  1, false, true,  true},
+        {"analyzer FFT 1/4",     4, 0,  2, false, true,  true},
+        {"STFT shed",            4, 0,  2, false, false, true},
+        {"display decimation 8", 8, 0,  2, false, false, true},
+        {"time plot shed",       8, 0,  2, false, false, false},
+    };
+    return ladder;
+}
+
+bool BudgetGovernor::evaluate(const BudgetSample& sample) {
+    if (!have_baseline_ || sample.time_ns <= previous_.time_ns) {
+        previous_ = sample;
+        have_baseline_ = true;
+        return false;
+    }
+
+    double elapsed = static_cast<double>(sample.time_ns - previous_.time_ns);
+    thread_load_ = 0.0;
+    for (size_t i = 0; i < BudgetSample::MAX_THREADS; ++i) {
+        int64_t busy = sample.busy_ns[i] - previous_.busy_ns[i];
+        if (busy < 0) {
+            // Counters were reset under us, start over from here
+            previous_ = sample;
+            return false;
+        }
+        thread_load_ = std::max(thread_load_, busy / elapsed);
+    }
+    frame_load_ = settings_.frame_budget_ns > 0
+        ? static_cast<double>(sample.frame_ns) / settings_.frame_budget_ns : 0.0;
+    bool lost = sample.lost_samples > previous_.lost_samples;
+    previous_ = sample;
+
+    char why[96];
+    bool overloaded = true;
+    if (lost) {
+        std::snprintf(why, sizeof(why), "analyzer lost samples");
+    } else if (thread_load_ > settings_.high_load) {
+        std::snprintf(why, sizeof(why), "thread load %.0f%%", 100.0 * thread_load_);
+    } else if (frame_load_ > settings_.high_load) {
+        std::snprintf(why, sizeof(why), "frame time %.1f ms", sample.frame_ns / 1e6);
+    } else {
+        overloaded = false;
+    }
+
+    if (overloaded) {
+        calm_ = 0;
+        if (just_recovered_) {
+            // The level above doesn't hold, wait longer before trying it again
+            calm_needed_ = std::min(calm_needed_ * 2, settings_.max_calm_evaluations);
+        }
+        just_recovered_ = false;
+        if (level_ + 1 < static_cast<int>(levels().size())) {
+            ++level_;
+            reason_ = why;
+            return true;
+        }
+        return false;
+    }
+
+    if (just_recovered_) {
+        // The step up held, relax the backoff
+        calm_needed_ = std::max(calm_needed_ / 2, settings_.calm_evaluations);
+        just_recovered_ = false;
+    }
+    if (thread_load_ >= settings_.low_load || frame_load_ >= settings_.low_load) {
+        calm_ = 0;
+        return false;
+    }
+    if (++calm_ < calm_needed_ || level_ == 0) {
+        return false;
+    }
+    --level_;
+    calm_ = 0;
+    just_recovered_ = true;
+    reason_ = "headroom";
+    return true;
+}
+
+int BudgetGovernor::pickFFTSize(double sample_rate, const std::vector<int>& candidates,
+                                double budget, const std::function<int64_t(int)>& frame_cost_ns) {
+    std::vector<int> sizes = candidates;
+    std::sort(sizes.rbegin(), sizes.rend());
+    for (int size : sizes) {
+        double frames_per_second = sample_rate / size;
+        double load = frame_cost_ns(size) * frames_per_second / 1e9;
+        if (load <= budget) {
+            return size;
+        }
+    }
+    return sizes.empty() ? 0 : sizes.back();
+}
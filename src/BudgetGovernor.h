@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * One step on the governor's degradation ladder
+ * Lower levels cost more; each level keeps the cuts of the ones before it
+ */
+struct BudgetLevel {
+    const char* name;
+    int display_decimation;     // Analyzer computes 1 of n frames, displays refresh n times slower
+    int stft_overlap_percent;   // RFML spectrogram overlap over a fixed time span
+    int fft_size_shift;         // Analyzer FFT size halved this many times, fewer bins to draw
+    bool show_3d;
+    bool run_stft;
+    bool show_time;
+};
+
+/**
+ * Cumulative counters the governor differentiates between evaluations
+ */
+struct BudgetSample {
+    static constexpr size_t MAX_THREADS = 3;
+
+    int64_t time_ns = 0;
+    std::array<int64_t, MAX_THREADS> busy_ns{};     // Per processing thread, sum of stage run times
+    int64_t frame_ns = 0;       // Render thread's average frame (Update()) time
+    uint64_t lost_samples = 0;  // Samples the analyzer's reader was overrun by
+};
+
+/**
+ * Keeps the display pipeline inside its real-time budget
+ *
+ * evaluate() is fed cumulative busy times of the processing threads and the
+ * render thread's frame time. A thread busier than high_load of a core, a
+ * frame longer than high_load of the frame budget, or samples lost to the
+ * analyzer step one level down the ladder; every level only trades display
+ * quality, so acquisition (RX and the IQ ring) is never touched. After
+ * calm_evaluations in a row below low_load it steps back up one level. A
+ * step up that overloads again at once doubles the calm time required next.
+ *
+ * Not thread-safe, lives on the GUI thread.
+ */
+class BudgetGovernor {
+public:
+    struct Settings {
+        double high_load = 0.85;
+        double low_load = 0.5;
+        int64_t frame_budget_ns = 16666667;     // 60 fps
+        int calm_evaluations = 4;
+        int max_calm_evaluations = 64;
+    };
+
+    BudgetGovernor();
+    explicit BudgetGovernor(const Settings& settings);
+
+    /**
+     * Compare against the previous sample and adjust the level
+     * @return true if the level changed
+     */
+    bool evaluate(const BudgetSample& sample);
+
+    // Forget the previous sample, e.g. after the counters were reset
+    void resetBaseline() { have_baseline_ = false; }
+
+    int level() const { return level_; }
+    const BudgetLevel& current() const { return levels()[level_]; }
+    // Why the level last changed
+    const std::string& reason() const { return reason_; }
+    // Measured at the last evaluation: busiest thread's share of a core,
+    // frame time over the frame budget
+    double threadLoad() const { return thread_load_; }
+    double frameLoad() const { return frame_load_; }
+
+    static const std::vector<BudgetLevel>& levels();
+
+    /**
+     * Largest FFT size whose analyzer cost fits the budget at this rate
+     * @param candidates FFT sizes to try, any order
+     * @param budget Share of one core the analyzer may use
+     * @param frame_cost_ns Cost of one analyzer frame at a given size
+     * @return Smallest candidate if none fits
+     */
+    static int pickFFTSize(double sample_rate, const std::vector<int>& candidates,
+                           double budget, const std::function<int64_t(int)>& frame_cost_ns);
+
+private:
+    Settings settings_;
+    int level_ = 0;
+    int calm_ = 0;
+    int calm_needed_;
+    bool just_recovered_ = false;
+    bool have_baseline_ = false;
+    BudgetSample previous_;
+    double thread_load_ = 0.0;
+    double frame_load_ = 0.0;
+    std::string reason_ = "start";
+};
@@ -0,0 +1,183 @@
+#include "BufferMemory.h"
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/mman.h>
+#include <linux/mempolicy.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr size_t SMALL_PAGE = 4096;
+constexpr size_t HUGE_2M = size_t(2) << 20;
+constexpr size_t HUGE_1G = size_t(1) << 30;
+constexpr size_t HEAP_ALIGNMENT = 64;
+
+size_t roundUp(size_t bytes, size_t page) {
+    return (bytes + page - 1) / page * page;
+}
+
+// Length of every live mapping, which depends on the fallback that made it.
+// Built on first use so it outlives buffers with static storage
+struct Mappings {
+    std::mutex mutex;
+    std::unordered_map<const void*, size_t> lengths;
+};
+
+Mappings& mappings() {
+    static Mappings table;
+    return table;
+}
+
+#ifdef __linux__
+void* mapHugetlb(size_t len, int size_flag) {
+    void* ptr = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | size_flag, -1, 0);
+    return ptr == MAP_FAILED ? nullptr : ptr;
+}
+
+// Regular pages, aligned to 2M so transparent huge pages can back all of it
+void* mapTransparent(size_t len) {
+    size_t span = len + HUGE_2M;
+    void* raw = mmap(nullptr, span, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return nullptr;
+    }
+    uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+    uintptr_t aligned = roundUp(start, HUGE_2M);
+    if (aligned > start) {
+        munmap(raw, aligned - start);
+    }
+    size_t tail = (start + span) - (aligned + len);
+    if (tail > 0) {
+        munmap(reinterpret_cast<void*>(aligned + len), tail);
+    }
+    void* ptr = reinterpret_cast<void*>(aligned);
+    madvise(ptr, len, MADV_HUGEPAGE);
+    return ptr;
+}
+#endif
+}
+
+size_t BufferMemory::pageBytes(MemoryPolicy::PageSize page_size) {
+    switch (page_size) {
+    case MemoryPolicy::PageSize::Huge2M: return HUGE_2M;
+    case MemoryPolicy::PageSize::Huge1G: return HUGE_1G;
+    default: return SMALL_PAGE;
+    }
+}
+
+size_t BufferMemory::mappedSize(const void* ptr) {
+    Mappings& table = mappings();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    auto it = table.lengths.find(ptr);
+    return it == table.lengths.end() ? 0 : it->second;
+}
+
+void* BufferMemory::allocate(size_t bytes, const MemoryPolicy& policy) {
+    if (bytes == 0) {
+        bytes = 1;
+    }
+#ifdef __linux__
+    if (policy.isDefault()) {
+        return ::operator new(bytes, std::align_val_t(HEAP_ALIGNMENT), std::nothrow);
+    }
+
+    // Each attempt only rounds to its own page size, so a 1G request that
+    // falls back doesn't map a whole gigabyte of small pages
+    size_t len = 0;
+    void* ptr = nullptr;
+    if (policy.page_size == MemoryPolicy::PageSize::Huge1G) {
+        len = roundUp(bytes, HUGE_1G);
+        ptr = mapHugetlb(len, MAP_HUGE_1GB);
+    }
+    if (!ptr && policy.page_size != MemoryPolicy::PageSize::Default) {
+        len = roundUp(bytes, HUGE_2M);
+        ptr = mapHugetlb(len, MAP_HUGE_2MB);
+        if (!ptr) {
+            ptr = mapTransparent(len);
+        }
+    }
+    if (!ptr) {
+        len = roundUp(bytes, SMALL_PAGE);
+        void* raw = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        ptr = raw == MAP_FAILED ? nullptr : raw;
+    }
+    if (ptr) {
+        applyPolicy(ptr, len, MemoryPolicy{MemoryPolicy::PageSize::Default, policy.numa_node});
+        Mappings& table = mappings();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        table.lengths[ptr] = len;
+    }
+    return ptr;
+#else
+    (void)policy;
+    return ::operator new(bytes, std::align_val_t(HEAP_ALIGNMENT), std::nothrow);
+#endif
+}
+
+void BufferMemory::deallocate(void* ptr, size_t bytes, const MemoryPolicy& policy) {
+    (void)bytes;    // Mappings are looked up, the heap doesn't need it
+    if (!ptr) return;
+#ifdef __linux__
+    if (!policy.isDefault()) {
+        Mappings& table = mappings();
+        size_t len = 0;
+        {
+            std::lock_guard<std::mutex> lock(table.mutex);
+            auto it = table.lengths.find(ptr);
+            if (it != table.lengths.end()) {
+                len = it->second;
+                table.lengths.erase(it);
+            }
+        }
+        if (len > 0) {
+            munmap(ptr, len);
+        }
+        return;
+    }
+#else
+    (void)policy;
+#endif
+    ::operator delete(ptr, std::align_val_t(HEAP_ALIGNMENT));
+}
+
+void BufferMemory::applyPolicy(void* addr, size_t bytes, const MemoryPolicy& policy) {
+#ifdef __linux__
+    if (policy.page_size != MemoryPolicy::PageSize::Default) {
+        madvise(addr, bytes, MADV_HUGEPAGE);
+    }
+    if (policy.numa_node == MemoryPolicy::NUMA_ANY) {
+        return;
+    }
+    int node = policy.numa_node == MemoryPolicy::NUMA_LOCAL ?
+        currentNumaNode() : policy.numa_node;
+    if (node < 0 || node >= 64) {
+        return;
+    }
+    // Raw syscall so we don't need libnuma; fails harmlessly without NUMA
+    unsigned long mask = 1UL << node;
+    syscall(SYS_mbind, addr, bytes, MPOL_BIND, &mask, sizeof(mask) * 8, 0);
+#else
+    (void)addr;
+    (void)bytes;
+    (void)policy;
+#endif
+}
+
+int BufferMemory::currentNumaNode() {
+#ifdef __linux__
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) {
+        return static_cast<int>(node);
+    }
+#endif
+    return 0;
+}
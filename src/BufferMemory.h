@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <limits>
+
+/**
+ * Page size and NUMA placement for one large buffer
+ * Defaults keep plain heap allocation so small buffers are unaffected.
+ */
+struct MemoryPolicy {
+    enum class PageSize {
+        Default,    // Regular 4K pages from the heap
+        Huge2M,     // hugetlbfs 2M pages, falls back to transparent huge pages
+        Huge1G      // hugetlbfs 1G pages, falls back to Huge2M
+    };
+
+    static constexpr int NUMA_ANY = -1;     // Leave placement to the kernel
+    static constexpr int NUMA_LOCAL = -2;   // Node of the allocating thread
+
+    PageSize page_size = PageSize::Default;
+    int numa_node = NUMA_ANY;
+
+    // Sample rings and spectrogram histories, allocated by their consumer
+    static MemoryPolicy largeBuffer() {
+        MemoryPolicy policy;
+        policy.page_size = PageSize::Huge2M;
+        policy.numa_node = NUMA_LOCAL;
+        return policy;
+    }
+
+    bool isDefault() const {
+        return page_size == PageSize::Default && numa_node == NUMA_ANY;
+    }
+    bool operator==(const MemoryPolicy& other) const {
+        return page_size == other.page_size && numa_node == other.numa_node;
+    }
+    bool operator!=(const MemoryPolicy& other) const { return !(*this == other); }
+};
+
+/**
+ * Allocation layer for large sample and spectrogram buffers
+ *
+ * Tries hugetlbfs pages first (MAP_HUGETLB), then a huge-page aligned
+ * mapping with madvise(MADV_HUGEPAGE), then regular pages, and binds the
+ * result to the requested NUMA node with mbind(). Every step is best effort:
+ * missing huge page reservations or a non-NUMA kernel only lose the
+ * optimization, never the allocation.
+ */
+class BufferMemory {
+public:
+    // nullptr only if no mapping at all could be made
+    static void* allocate(size_t bytes, const MemoryPolicy& policy);
+    static void deallocate(void* ptr, size_t bytes, const MemoryPolicy& policy);
+
+    /**
+     * Apply huge page advice and NUMA binding to an existing mapping
+     * (used by MirroredBuffer, which maps its own memory)
+     */
+    static void applyPolicy(void* addr, size_t bytes, const MemoryPolicy& policy);
+
+    /**
+     * Bytes mapped for a pointer allocate() returned, rounded to the page
+     * size of whichever fallback backs it; 0 for heap allocations
+     */
+    static size_t mappedSize(const void* ptr);
+    static size_t pageBytes(MemoryPolicy::PageSize page_size);
+
+    // NUMA node the calling thread is running on, 0 if unknown
+    static int currentNumaNode();
+};
+
+/**
+ * Stateful STL allocator over BufferMemory, for std::vector backed buffers
+ * e.g. std::vector<float, BufferAllocator<float>> v(BufferAllocator<float>(policy));
+ */
+template<typename T>
+class BufferAllocator {
+public:
+    using value_type = T;
+
+    BufferAllocator() = default;
+    explicit BufferAllocator(const MemoryPolicy& policy) : policy_(policy) {}
+    template<typename U>
+    BufferAllocator(const BufferAllocator<U>& other) : policy_(other.policy()) {}
+
+    T* allocate(size_t n) {
+        if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        void* ptr = BufferMemory::allocate(n * sizeof(T), policy_);
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        BufferMemory::deallocate(ptr, n * sizeof(T), policy_);
+    }
+
+    const MemoryPolicy& policy() const { return policy_; }
+
+    template<typename U>
+    bool operator==(const BufferAllocator<U>& other) const { return policy_ == other.policy(); }
+    template<typename U>
+    bool operator!=(const BufferAllocator<U>& other) const { return policy_ != other.policy(); }
+
+private:
+    MemoryPolicy policy_;
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * Occupancy and loss counters for one buffer in the sample pipeline
+ * Snapshot only, the owning buffer keeps the live values in atomics
+ */
+struct BufferStats {
+	size_t capacity = 0;
+	size_t fill = 0;		// Items currently buffered (unread for ring readers)
+	size_t high_water = 0;	// Largest fill seen since the last reset
+	size_t dropped = 0;		// Items discarded or overwritten before being read
+};
+
+// What a bounded buffer does with new items when it is full
+enum class OverflowPolicy {
+	OverwriteOldest,	// Evict the oldest items, counted as dropped
+	DropNewest,			// Reject the incoming items, counted as dropped
+	Block				// Wait for a consumer to make room, drop on timeout
+};
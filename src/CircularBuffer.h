@@ -2,61 +2,128 @@
 
 #include <vector>
 #include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <condition_variable>
+#include "BufferStats.h"
+#include "BufferMemory.h"
 
 template<typename T>
 class CircularBuffer{
 private:
-	std::vector<T> data_;
+	std::vector<T, BufferAllocator<T>> data_;
 	size_t head_;	  // Current pos
 	size_t tail_;	  // Read pos
 	size_t size_;	  // Number of elements
 	size_t capacity_; // Max number of elements
 	mutable std::mutex mutex_;
+	std::condition_variable not_full_;
+
+	OverflowPolicy policy_;
+	std::chrono::milliseconds block_timeout_;
+
+	// Readable without the lock, e.g. from the GUI status bar
+	std::atomic<size_t> fill_{0};
+	std::atomic<size_t> high_water_{0};
+	std::atomic<size_t> dropped_{0};
+
+	// Caller holds mutex_
+	void WriteOne(const T& item) {
+		data_[head_] = item;
+		head_ = (head_ + 1) % capacity_;
+		if (size_ < capacity_) { ++size_; }
+		else { tail_ = (tail_ + 1) % capacity_; }
+	}
+
+	void UpdateFill() {
+		fill_.store(size_, std::memory_order_relaxed);
+		if (size_ > high_water_.load(std::memory_order_relaxed)) {
+			high_water_.store(size_, std::memory_order_relaxed);
+		}
+	}
 
 public:
-	explicit CircularBuffer(size_t capacity)
-        : data_(capacity)
+	explicit CircularBuffer(size_t capacity,
+			OverflowPolicy policy = OverflowPolicy::OverwriteOldest,
+			std::chrono::milliseconds block_timeout = std::chrono::milliseconds(100),
+			const MemoryPolicy& memory = MemoryPolicy())
+        : data_(capacity, T(), BufferAllocator<T>(memory))
         , head_(0)
         , tail_(0)
         , size_(0)
-        , capacity_(capacity) {
+        , capacity_(capacity)
+        , policy_(policy)
+        , block_timeout_(block_timeout) {
     }
 
-	// Bulk push
-	void PushBulk(const T* items, size_t count) {
-		std::lock_guard<std::mutex> lock(mutex_);
-		for (size_t i = 0; i < count; i++) {
-			data_[head_] = items[i];
-			head_ = (head_ + 1) % capacity_;
-			if (size_ < capacity_) { ++size_; }
-			else { tail_ = (tail_ + 1) % capacity_; }
+	/**
+	 * Bulk push, full-buffer behaviour depends on the overflow policy
+	 * @return Number of items accepted; the rest were counted as dropped
+	 */
+	size_t PushBulk(const T* items, size_t count) {
+		std::unique_lock<std::mutex> lock(mutex_);
+		size_t accepted = 0;
+		switch (policy_) {
+		case OverflowPolicy::OverwriteOldest: {
+			size_t free_space = capacity_ - size_;
+			if (count > free_space) {
+				dropped_.fetch_add(count - free_space, std::memory_order_relaxed);
+			}
+			for (size_t i = 0; i < count; i++) { WriteOne(items[i]); }
+			accepted = count;
+			break;
+		}
+		case OverflowPolicy::DropNewest:
+			accepted = std::min(count, capacity_ - size_);
+			for (size_t i = 0; i < accepted; i++) { WriteOne(items[i]); }
+			break;
+		case OverflowPolicy::Block:
+			while (accepted < count) {
+				if (size_ == capacity_ &&
+						!not_full_.wait_for(lock, block_timeout_,
+							[this]() { return size_ < capacity_; })) {
+					break;	// Consumer stalled, give up on the rest
+				}
+				size_t n = std::min(count - accepted, capacity_ - size_);
+				for (size_t i = 0; i < n; i++) { WriteOne(items[accepted + i]); }
+				accepted += n;
+				UpdateFill();
+			}
+			break;
 		}
+		if (accepted < count) {
+			dropped_.fetch_add(count - accepted, std::memory_order_relaxed);
+		}
+		UpdateFill();
+		return accepted;
 	}
 
-	// Push an element to the buffer
-	void Push(const T& item) {
-		std::lock_guard<std::mutex> lock(mutex_);
-		data_[head_] = item;
-		head_ = (head_ + 1) % capacity_;
-		if (size_ < capacity_) { ++size_; }
-		else { tail_ = (tail_ + 1) % capacity_; }
+	// Push an element to the buffer, false if it was dropped
+	bool Push(const T& item) {
+		return PushBulk(&item, 1) == 1;
 	}
 
 	// Pop an element off the buffer
 	bool Pop(T& item) {
-		std::lock_guard<std::mutex> lock(mutex_);
-		if (size_ == 0) { return false; }
-		item = data_[tail_];
-		tail_ = (tail_ + 1) % capacity_;
-		--size_;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (size_ == 0) { return false; }
+			item = data_[tail_];
+			tail_ = (tail_ + 1) % capacity_;
+			--size_;
+			fill_.store(size_, std::memory_order_relaxed);
+		}
+		not_full_.notify_one();
 		return true;
 	}
 
 	void CopyLatest(T* dest, size_t count) {
 		std::lock_guard<std::mutex> lock(mutex_);
 		size_t copy_count = std::min(count, size_);
+		size_t start = tail_ + size_ - copy_count;	// Newest copy_count items
 		for ( size_t i = 0; i < copy_count; ++i ) {
-			size_t idx = (tail_ + i) % capacity_;
+			size_t idx = (start + i) % capacity_;
 			dest[i] = data_[idx];
 		}
 		for ( size_t i = copy_count; i < count; ++i ) {
@@ -88,9 +155,46 @@ public:
 	}
 
 	// Clear buffer when full
-	void clear() const {
+	void clear() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			head_ = tail_ = size_ = 0;
+			fill_.store(0, std::memory_order_relaxed);
+		}
+		not_full_.notify_all();
+	}
+
+	OverflowPolicy Policy() const {
+		return policy_;
+	}
+
+	// Lock-free counters, safe to poll from any thread
+	size_t Fill() const {
+		return fill_.load(std::memory_order_relaxed);
+	}
+
+	size_t HighWaterMark() const {
+		return high_water_.load(std::memory_order_relaxed);
+	}
+
+	size_t Dropped() const {
+		return dropped_.load(std::memory_order_relaxed);
+	}
+
+	BufferStats Stats() const {
+		BufferStats stats;
+		stats.capacity = capacity_;
+		stats.fill = Fill();
+		stats.high_water = HighWaterMark();
+		stats.dropped = Dropped();
+		return stats;
+	}
+
+	// Restart drop and high-water accounting, e.g. after a retune
+	void ResetStats() {
 		std::lock_guard<std::mutex> lock(mutex_);
-		head_ = tail_ = size_ = 0;
+		dropped_.store(0, std::memory_order_relaxed);
+		high_water_.store(size_, std::memory_order_relaxed);
 	}
 };
 
@@ -0,0 +1,140 @@
+#include "DeviceCommandQueue.h"
+#include "SDRDevice.h"
+#include "Logger.h"
+#include <iostream>
+#include <pthread.h>
+
+DeviceCommandQueue::DeviceCommandQueue(SDRDevice& device)
+    : device_(device) {
+}
+
+DeviceCommandQueue::~DeviceCommandQueue() {
+    stop();
+}
+
+bool DeviceCommandQueue::start() {
+    if (isRunning()) {
+        return true;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = false;
+    }
+    try {
+        thread_ = std::thread(&DeviceCommandQueue::run, this);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to start device control thread: " << e.what() << std::endl;
+        return false;
+    }
+    pthread_setname_np(thread_.native_handle(), "osprey-devctl");
+    return true;
+}
+
+void DeviceCommandQueue::stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+
+    // Nobody left to run these
+    std::deque<Entry> dropped;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        dropped.swap(queue_);
+    }
+    for (auto& entry : dropped) {
+        for (auto& waiter : entry.waiters) {
+            waiter.set_value(false);
+        }
+    }
+}
+
+std::future<bool> DeviceCommandQueue::submit(const std::string& key, Command command) {
+    std::promise<bool> promise;
+    std::future<bool> result = promise.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!key.empty()) {
+            for (auto& entry : queue_) {
+                if (entry.key == key) {
+                    // Superseded before it ran: take its place in the queue
+                    entry.command = std::move(command);
+                    entry.waiters.push_back(std::move(promise));
+                    coalesced_.fetch_add(1, std::memory_order_relaxed);
+                    return result;
+                }
+            }
+        }
+        Entry entry;
+        entry.key = key;
+        entry.command = std::move(command);
+        entry.waiters.push_back(std::move(promise));
+        queue_.push_back(std::move(entry));
+    }
+    wake_.notify_one();
+    return result;
+}
+
+std::future<bool> DeviceCommandQueue::setFrequency(double freq_hz) {
+    return submit("frequency", [freq_hz](SDRDevice& device) {
+        return device.setFrequency(freq_hz);
+    });
+}
+
+std::future<bool> DeviceCommandQueue::setSampleRate(double rate_sps) {
+    return submit("sample_rate", [rate_sps](SDRDevice& device) {
+        return device.setSampleRate(rate_sps);
+    });
+}
+
+std::future<bool> DeviceCommandQueue::setGain(double gain_db) {
+    return submit("gain", [gain_db](SDRDevice& device) {
+        return device.setGain(gain_db);
+    });
+}
+
+std::future<bool> DeviceCommandQueue::setBandwidth(double bandwidth_hz) {
+    return submit("bandwidth", [bandwidth_hz](SDRDevice& device) {
+        return device.setBandwidth(bandwidth_hz);
+    });
+}
+
+size_t DeviceCommandQueue::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+void DeviceCommandQueue::run() {
+    while (true) {
+        Entry entry;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+            if (stop_) {
+                return;
+            }
+            entry = std::move(queue_.front());
+            queue_.pop_front();
+            busy_.store(true, std::memory_order_relaxed);
+        }
+
+        // Device calls happen outside the lock so submit() never waits on them
+        bool success = false;
+        try {
+            success = entry.command(device_);
+        } catch (const std::exception& e) {
+            LOG_ERROR("Device command '{}' failed: {}", entry.key, e.what());
+        }
+        busy_.store(false, std::memory_order_relaxed);
+        executed_.fetch_add(1, std::memory_order_relaxed);
+
+        for (auto& waiter : entry.waiters) {
+            waiter.set_value(success);
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class SDRDevice;
+
+/**
+ * Device control thread: setters run here, never on the GUI or RX thread
+ *
+ * A retune on a USRP is a blocking UHD call (tens of ms, more for a rate
+ * change), so callers submit() and get a future instead of waiting. Commands
+ * carry a key naming the setting they change; a new command replaces a
+ * still-queued one with the same key, and every future of the replaced
+ * command resolves with the result of the one that actually ran. Dragging a
+ * frequency slider so costs one retune per command the device finishes, not
+ * one per frame. Commands with an empty key are never coalesced.
+ *
+ * The device applies changes between RX blocks and flags the first block
+ * after with SampleMetadata::RETUNED, so consumers know where they begin.
+ */
+class DeviceCommandQueue {
+public:
+    using Command = std::function<bool(SDRDevice&)>;
+
+    explicit DeviceCommandQueue(SDRDevice& device);
+    ~DeviceCommandQueue();
+
+    DeviceCommandQueue(const DeviceCommandQueue&) = delete;
+    DeviceCommandQueue& operator=(const DeviceCommandQueue&) = delete;
+
+    bool start();
+    // Runs the command in flight to completion; queued ones resolve false
+    void stop();
+    bool isRunning() const { return thread_.joinable(); }
+
+    /**
+     * Queue command for the control thread
+     * @param key Setting the command changes, "" = never coalesced
+     * @return Resolves with the command's result (false if it threw or the
+     *         queue stopped first)
+     */
+    std::future<bool> submit(const std::string& key, Command command);
+
+    // The usual setters, keyed by setting
+    std::future<bool> setFrequency(double freq_hz);
+    std::future<bool> setSampleRate(double rate_sps);
+    std::future<bool> setGain(double gain_db);
+    std::future<bool> setBandwidth(double bandwidth_hz);
+
+    // Waiting commands, not counting one in flight
+    size_t pending() const;
+    // A command is running on the device right now
+    bool busy() const { return busy_.load(std::memory_order_relaxed); }
+    uint64_t executed() const { return executed_.load(std::memory_order_relaxed); }
+    uint64_t coalesced() const { return coalesced_.load(std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        std::string key;
+        Command command;
+        std::vector<std::promise<bool>> waiters;    // Own plus replaced commands'
+    };
+
+    SDRDevice& device_;
+    std::thread thread_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<Entry> queue_;
+    bool stop_ = false;
+
+    std::atomic<bool> busy_{false};
+    std::atomic<uint64_t> executed_{0};
+    std::atomic<uint64_t> coalesced_{0};
+
+    void run();
+};
@@ -0,0 +1,75 @@
+#include "DspWorker.h"
+#include <iostream>
+#include <pthread.h>
+
+DspWorker::DspWorker(const std::string& name, Task task, const ThreadPolicy& policy)
+    : name_(name)
+    , task_(std::move(task))
+    , policy_(policy) {
+}
+
+DspWorker::~DspWorker() {
+    stop();
+}
+
+bool DspWorker::start() {
+    if (running_.load()) {
+        return true;
+    }
+    stop_.store(false);
+    pending_.store(0);
+    peak_pending_.store(0);
+    try {
+        thread_ = std::thread(&DspWorker::run, this);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to start DSP worker " << name_ << ": " << e.what() << std::endl;
+        return false;
+    }
+    // Shows up in top/perf; the kernel limit is 15 characters
+    pthread_setname_np(thread_.native_handle(), name_.substr(0, 15).c_str());
+    running_.store(true);
+    return true;
+}
+
+void DspWorker::stop() {
+    if (!thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_.store(true);
+    }
+    wake_.notify_one();
+    thread_.join();
+    running_.store(false);
+}
+
+void DspWorker::notify() {
+    size_t queued = pending_.fetch_add(1) + 1;
+    if (queued > peak_pending_.load(std::memory_order_relaxed)) {
+        peak_pending_.store(queued, std::memory_order_relaxed);
+    }
+    // Worker checks pending_ under the lock after raising sleeping_, so either
+    // it sees this increment or we see it asleep and wake it
+    if (sleeping_.load()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wake_.notify_one();
+    }
+}
+
+void DspWorker::run() {
+    applyThreadPolicy(policy_, name_);
+    while (!stop_.load()) {
+        if (pending_.exchange(0) == 0) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            sleeping_.store(true);
+            wake_.wait_for(lock, IDLE_TIMEOUT, [this]() {
+                return pending_.load() > 0 || stop_.load();
+            });
+            sleeping_.store(false);
+            continue;
+        }
+        task_();
+        runs_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "ThreadTuning.h"
+
+/**
+ * Processing thread woken by the RX path whenever new samples are committed
+ *
+ * The RX thread only calls notify(): an atomic increment, plus a short
+ * uncontended lock if the worker is asleep, so it never waits on analysis.
+ * Notifications that arrive while the task runs are coalesced into the next
+ * run; the task is expected to drain everything available, as ring readers
+ * do, so a slow worker falls behind in its ring rather than stalling recv().
+ */
+class DspWorker {
+public:
+    using Task = std::function<void()>;
+
+    DspWorker(const std::string& name, Task task, const ThreadPolicy& policy = ThreadPolicy());
+    ~DspWorker();
+
+    DspWorker(const DspWorker&) = delete;
+    DspWorker& operator=(const DspWorker&) = delete;
+
+    bool start();
+    void stop();
+    bool isRunning() const { return running_.load(); }
+
+    // Announce new input, called by the producer (RX) thread
+    void notify();
+
+    // Notifications not yet picked up by a run, i.e. blocks queued
+    size_t queued() const { return pending_.load(std::memory_order_relaxed); }
+    size_t peakQueued() const { return peak_pending_.load(std::memory_order_relaxed); }
+    uint64_t runs() const { return runs_.load(std::memory_order_relaxed); }
+    const std::string& name() const { return name_; }
+
+private:
+    // Safety net only, notify() never loses a wakeup
+    static constexpr std::chrono::milliseconds IDLE_TIMEOUT{100};
+
+    std::string name_;
+    Task task_;
+    ThreadPolicy policy_;
+    std::thread thread_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> stop_{false};
+    std::atomic<bool> sleeping_{false};
+
+    std::atomic<size_t> pending_{0};
+    std::atomic<size_t> peak_pending_{0};
+    std::atomic<uint64_t> runs_{0};
+
+    void run();
+};
@@ -0,0 +1,101 @@
+#include "FFTPlanCache.h"
+#include "BufferMemory.h"
+#include "Logger.h"
+#include <pffft.h>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+FFTPlan::FFTPlan(int size, FFTMode mode)
+    : setup_(nullptr)
+    , size_(size)
+    , mode_(mode) {
+    if (size > 0) {
+        setup_ = pffft_new_setup(size, mode == FFTMode::Complex ? PFFFT_COMPLEX : PFFFT_REAL);
+    }
+    if (!setup_) {
+        throw std::runtime_error("Failed to create PFFFT setup for size " + std::to_string(size));
+    }
+}
+
+FFTPlan::~FFTPlan() {
+    pffft_destroy_setup(setup_);
+}
+
+FFTPlanCache& FFTPlanCache::instance() {
+    static FFTPlanCache cache;
+    return cache;
+}
+
+template<typename Key, typename T, typename Build>
+std::shared_ptr<const T> FFTPlanCache::getOrBuild(std::map<Key, Entry<T>>& entries, const Key& key,
+                                                  Build build) {
+    std::promise<std::shared_ptr<const T>> promise;
+    Entry<T> existing;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries.find(key);
+        if (it != entries.end()) {
+            existing = it->second;
+        } else {
+            entries.emplace(key, promise.get_future().share());
+        }
+    }
+    if (existing.valid()) {
+        return existing.get();      // Waits if another thread is still building it
+    }
+
+    // Built outside the lock, other keys aren't held up
+    try {
+        std::shared_ptr<const T> value = build();
+        promise.set_value(value);
+        return value;
+    } catch (...) {
+        promise.set_exception(std::current_exception());
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries.erase(key);     // Let a later request try again
+        throw;
+    }
+}
+
+std::shared_ptr<const FFTPlan> FFTPlanCache::plan(int size, FFTMode mode) {
+    return getOrBuild(plans_, std::make_pair(size, mode), [&]() {
+        auto plan = std::make_shared<const FFTPlan>(size, mode);
+        plans_built_.fetch_add(1);
+        return plan;
+    });
+}
+
+std::shared_ptr<const WindowTable> FFTPlanCache::window(WindowType type, int size) {
+    return getOrBuild(windows_, std::make_pair(type, size), [&]() {
+        return std::make_shared<const WindowTable>(makeWindowTable(type, size));
+    });
+}
+
+bool FFTPlanCache::hasPlan(int size, FFTMode mode) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = plans_.find(std::make_pair(size, mode));
+    return it != plans_.end() &&
+           it->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+std::future<void> FFTPlanCache::prewarm(std::vector<int> sizes, FFTMode mode, WindowType window) {
+    return std::async(std::launch::async, [this, sizes = std::move(sizes), mode, window]() {
+        for (int size : sizes) {
+            try {
+                plan(size, mode);
+                this->window(window, size);
+            } catch (const std::exception& e) {
+                LOG_WARN("FFT plan cache: skipping size {}: {}", size, e.what());
+            }
+        }
+    });
+}
+
+float* FFTPlanCache::scratch(size_t floats) {
+    thread_local std::vector<float, BufferAllocator<float>> buffer;
+    if (buffer.size() < floats) {
+        buffer.resize(floats);
+    }
+    return buffer.data();
+}
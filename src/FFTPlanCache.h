@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "Window.h"
+
+// Forward declare PFFFT types
+typedef struct PFFFT_Setup PFFFT_Setup;
+
+/**
+ * Real: one-sided spectrum of real input, fft_size/2 + 1 bins from DC to Nyquist
+ * Complex: two-sided spectrum of IQ input, fft_size fftshifted bins from
+ * -Fs/2 to +Fs/2 with DC at fft_size/2
+ */
+enum class FFTMode {
+    Real,
+    Complex
+};
+
+/**
+ * One PFFFT setup (factorization and twiddles). Immutable once built, so
+ * any number of threads may transform with it at once, each with its own
+ * work buffer.
+ */
+class FFTPlan {
+public:
+    FFTPlan(int size, FFTMode mode);
+    ~FFTPlan();
+
+    FFTPlan(const FFTPlan&) = delete;
+    FFTPlan& operator=(const FFTPlan&) = delete;
+
+    PFFFT_Setup* setup() const { return setup_; }
+    int size() const { return size_; }
+    FFTMode mode() const { return mode_; }
+
+    // Floats of work buffer pffft_transform needs
+    size_t workFloats() const { return mode_ == FFTMode::Complex ? 2 * size_ : size_; }
+
+private:
+    PFFFT_Setup* setup_;
+    int size_;
+    FFTMode mode_;
+};
+
+/**
+ * Process-wide cache of FFT plans and window tables
+ *
+ * Analyzers and STFTs share one setup per (size, mode) and one table per
+ * (window, size) instead of building their own, so replacing an analyzer
+ * with one of another FFT size costs only its frame buffers once the plan
+ * exists. prewarm() builds the sizes the UI offers in the background at
+ * startup. Entries live as long as the process.
+ *
+ * Thread-safe: concurrent requests for an entry being built wait for that
+ * build rather than starting a second one.
+ */
+class FFTPlanCache {
+public:
+    static FFTPlanCache& instance();
+
+    // Throws std::runtime_error if PFFFT can't do this size
+    std::shared_ptr<const FFTPlan> plan(int size, FFTMode mode);
+
+    // Tables use WindowTable::DEFAULT_KAISER_BETA
+    std::shared_ptr<const WindowTable> window(WindowType type, int size);
+
+    /**
+     * Build plans and window tables for these sizes on a background thread
+     * Sizes PFFFT rejects are skipped
+     * @return Done once all are built; waits on destruction like any std::async future
+     */
+    std::future<void> prewarm(std::vector<int> sizes, FFTMode mode, WindowType window);
+
+    // True if the plan is built (a plan() call would not block on a build)
+    bool hasPlan(int size, FFTMode mode);
+    size_t plansBuilt() const { return plans_built_.load(); }
+
+    /**
+     * Calling thread's 64 byte aligned work buffer of at least floats,
+     * grown on demand and never shrunk, so transforms allocate nothing
+     * after the largest size has been seen once. Valid until the next call
+     * on the same thread with more floats
+     */
+    static float* scratch(size_t floats);
+
+private:
+    FFTPlanCache() = default;
+
+    template<typename T>
+    using Entry = std::shared_future<std::shared_ptr<const T>>;
+
+    template<typename Key, typename T, typename Build>
+    std::shared_ptr<const T> getOrBuild(std::map<Key, Entry<T>>& entries, const Key& key, Build build);
+
+    std::mutex mutex_;
+    std::map<std::pair<int, FFTMode>, Entry<FFTPlan>> plans_;
+    std::map<std::pair<WindowType, int>, Entry<WindowTable>> windows_;
+    std::atomic<size_t> plans_built_{0};
+};
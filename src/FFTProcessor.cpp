@@ -1,43 +1,28 @@
 #include "FFTProcessor.h"
+#include "SpectrumKernels.h"
 #include <pffft.h>
 #include <iostream>
 #include <cmath>
 #include <algorithm>
 #include <cstring>
 
-FFTProcessor::FFTProcessor(int fft_size) 
-    : setup_(nullptr)
-    , fft_size_(fft_size) {
-    
-    // Initialize PFFFT for real to complex forward FFT
-    setup_ = pffft_new_setup(fft_size, PFFFT_REAL);
-    if (!setup_) {
-        throw std::runtime_error("Failed to create PFFFT setup for size " + std::to_string(fft_size));
-    }
-    
-    // Allocate work buffer
-    work_buffer_.resize(fft_size);
+FFTProcessor::FFTProcessor(int fft_size, FFTMode mode) 
+    : plan_(FFTPlanCache::instance().plan(fft_size, mode))
+    , fft_size_(fft_size)
+    , mode_(mode) {
     
-    std::cout << "FFTProcessor initialized with PFFFT, size=" << fft_size << std::endl;
+    std::cout << "FFTProcessor initialized with PFFFT, size=" << fft_size
+              << (mode == FFTMode::Complex ? ", complex" : ", real") << std::endl;
 }
 
-FFTProcessor::~FFTProcessor() {
-    cleanup();
-}
-
-void FFTProcessor::cleanup() {
-    if (setup_) {
-        pffft_destroy_setup(setup_);
-        setup_ = nullptr;
-    }
-}
+FFTProcessor::~FFTProcessor() = default;
 
 void FFTProcessor::forwardFFT(const float* input_buffer, float* output_buffer) {
     // Perform the forward FFT, must be ordered for the result to make sense
-    pffft_transform_ordered(setup_, 
+    pffft_transform_ordered(plan_->setup(), 
                            input_buffer, 
                            output_buffer, 
-                           work_buffer_.data(), 
+                           FFTPlanCache::scratch(plan_->workFloats()), 
                            PFFFT_FORWARD);
 }
 
@@ -45,27 +30,39 @@ void FFTProcessor::complexToReal(float* real_buffer,
                                 const float* complex_buffer,
                                 int real_buffer_len,
                                 bool normalize) {
+    if (mode_ == FFTMode::Complex) {
+        // Two-sided, ascending from -Fs/2; amplitude is 1/N of the magnitude
+        for (int i = 0; i < real_buffer_len; ++i) {
+            int k = shiftedIndex(i);
+            float real = complex_buffer[2 * k];
+            float imag = complex_buffer[2 * k + 1];
+            float magnitude = sqrtf(real * real + imag * imag);
+            real_buffer[i] = normalize ? magnitude / (fft_size_ * coherent_gain_) : magnitude;
+        }
+        return;
+    }
+
     // Filling in the buffer with magnitude in ascending frequency order
-    
+    // Normalized to 1/2N to get amplitude (1/2N because of one-sided FFT)
+    const float norm = normalize ? 1.0f / (2 * fft_size_ * coherent_gain_) : 1.0f;
+
     // complex_buffer[0] = DC
-    real_buffer[0] = complex_buffer[0];
-    
-    // complex_buffer[1] = Nyquist
-    if (real_buffer_len >= fft_size_ / 2 + 1) {
-        real_buffer[fft_size_ / 2] = complex_buffer[1];
-    }
+    real_buffer[0] = std::fabs(complex_buffer[0]) * norm;
 
     // The rest of the complex_buffer is interleaved real and imaginary parts
-    // For loop starts with i = 1, i.e. complex_buffer[2] 
-    for (int i = 1; i < real_buffer_len; ++i) {
+    // For loop starts with i = 1, i.e. complex_buffer[2]; it stops before
+    // N/2, whose slot in the pair layout is past the end of the buffer
+    const int inner_end = std::min(real_buffer_len, fft_size_ / 2);
+    for (int i = 1; i < inner_end; ++i) {
         // Real and imaginary parts are interleaved in the output array
         float real = complex_buffer[2 * i];
         float imag = complex_buffer[2 * i + 1];
-        float magnitude = sqrtf(real * real + imag * imag);
+        real_buffer[i] = sqrtf(real * real + imag * imag) * norm;
+    }
 
-        // Filling in the buffer
-        // Normalized to 1/2N to get amplitude (1/2N because of one-sided FFT)
-        real_buffer[i] = normalize ? magnitude / (2 * fft_size_) : magnitude;
+    // complex_buffer[1] = Nyquist
+    if (real_buffer_len >= fft_size_ / 2 + 1) {
+        real_buffer[fft_size_ / 2] = std::fabs(complex_buffer[1]) * norm;
     }
 }
 
@@ -74,40 +71,40 @@ void FFTProcessor::complexToRealDB(float* real_buffer,
                                   int real_buffer_len,
                                   bool scale,
                                   float floor_db) {
-    float floor_db_neg = -std::fabs(floor_db);
-    const float epsilon = 1e-20f;
+    const SpectrumKernels& kernels = spectrumKernels();
 
 	// Amplitude in dB
 	// dynamic when sim, simple when usrp because i cant fucking fix it
-	const float fft_len_float = static_cast<float>(fft_size_);
-	//const float fft_len_log10 = 20.0f * log10f(fft_len_float);
+	//const float fft_len_log10 = 20.0f * log10f(static_cast<float>(fft_size_));
 	const float fft_len_log10 = 20.0f;
 
-    // DC component
-    float magnitude_squared = complex_buffer[0] * complex_buffer[0];
-    magnitude_squared = fmaxf(magnitude_squared, epsilon);
-    float dB = 10.0f * log10f(magnitude_squared) - fft_len_log10;
-    dB = fmaxf(dB, floor_db_neg);
-    real_buffer[0] = scale ? 1.0f - dB / floor_db_neg : dB;
-
-    // Nyquist component
-    if (real_buffer_len >= fft_size_ / 2 + 1) {
-        magnitude_squared = complex_buffer[1] * complex_buffer[1];
-        magnitude_squared = fmaxf(magnitude_squared, epsilon);
-        dB = 10.0f * log10f(magnitude_squared) - fft_len_log10;
-        dB = fmaxf(dB, floor_db_neg);
-        real_buffer[fft_size_ / 2] = scale ? 1.0f - dB / floor_db_neg : dB;
+    // The window's coherent gain is taken back out so tones keep their level
+    DbScale db;
+    db.min_power = 1e-20f;
+    db.offset_db = -fft_len_log10 - 20.0f * std::log10(coherent_gain_);
+    db.floor_db = -std::fabs(floor_db);
+    db.display = scale;
+
+    if (mode_ == FFTMode::Complex) {
+        // Two-sided, fftshifted: negative frequencies first, bin fft_size/2 is DC
+        convertShifted(real_buffer, complex_buffer, real_buffer_len, [&](const float* iq, float* out, size_t n) {
+            kernels.powerDecibels(iq, out, n, 1.0f, db);
+        });
+        return;
     }
 
+    // DC and Nyquist are packed as two real values in the first pair
+    float edges[2] = {complex_buffer[0] * complex_buffer[0], complex_buffer[1] * complex_buffer[1]};
+    kernels.decibels(edges, edges, 2, db);
+    real_buffer[0] = edges[0];
+
     // Process the rest of the frequencies
-    for (int i = 1; i < real_buffer_len; ++i) {
-        float real = complex_buffer[2 * i];
-        float imag = complex_buffer[2 * i + 1];
-        magnitude_squared = real * real + imag * imag;
-        magnitude_squared = fmaxf(magnitude_squared, epsilon);
-        dB = 10.0f * log10f(magnitude_squared) - fft_len_log10;
-        dB = fmaxf(dB, floor_db_neg);
-        real_buffer[i] = scale ? 1.0f - dB / floor_db_neg : dB;
+    int inner = std::min(real_buffer_len, fft_size_ / 2) - 1;
+    if (inner > 0) {
+        kernels.powerDecibels(complex_buffer + 2, real_buffer + 1, inner, 1.0f, db);
+    }
+    if (real_buffer_len >= fft_size_ / 2 + 1) {
+        real_buffer[fft_size_ / 2] = edges[1];
     }
 }
 
@@ -117,59 +114,45 @@ void FFTProcessor::complexToPSD(float* psd_buffer,
                                float sample_rate,
                                bool db_scale,
                                float floor_db) {
-
+    const SpectrumKernels& kernels = spectrumKernels();
     const float epsilon = 1e-20f; // Small value to avoid log(0)
 
-    // PSD normalization factor: 1 / (Fs * N)
-    // For one-sided PSD, we multiply by 2 (except for DC and Nyquist)
-    float psd_scale = 1.0f / (sample_rate * fft_size_);
-
-    // DC component (index 0 in complex_buffer)
-    float power = complex_buffer[0] * complex_buffer[0];
-    float psd = power * psd_scale; // No factor of 2 for DC
-    psd = fmaxf(psd, epsilon);
-
-    if (db_scale) {
-        float psd_db = 10.0f * log10f(psd);
-        psd_db = fmaxf(psd_db, -floor_db);
-        psd_buffer[0] = psd_db;
-    } else {
-        psd_buffer[0] = psd;
-    }
-
-    // Nyquist component (index 1 in complex_buffer, maps to fft_size_/2)
-    if (psd_buffer_len >= fft_size_ / 2 + 1) {
-        power = complex_buffer[1] * complex_buffer[1];
-        psd = power * psd_scale; // No factor of 2 for Nyquist
-        psd = fmaxf(psd, epsilon);
+    // PSD normalization factor: 1 / (Fs * sum(w^2)), 1 / (Fs * N) unwindowed
+    float psd_scale = 1.0f / (sample_rate * fft_size_ * power_gain_);
 
+    DbScale db;
+    db.min_power = epsilon;
+    db.floor_db = -floor_db;
+    auto convert = [&](const float* iq, float* out, size_t n, float power_scale) {
         if (db_scale) {
-            float psd_db = 10.0f * log10f(psd);
-            psd_db = fmaxf(psd_db, -floor_db);
-            psd_buffer[fft_size_ / 2] = psd_db;
+            kernels.powerDecibels(iq, out, n, power_scale, db);
         } else {
-            psd_buffer[fft_size_ / 2] = psd;
+            kernels.power(iq, out, n, power_scale, epsilon);
         }
+    };
+
+    if (mode_ == FFTMode::Complex) {
+        // Two-sided PSD: every bin is its own frequency, no doubling
+        convertShifted(psd_buffer, complex_buffer, psd_buffer_len, [&](const float* iq, float* out, size_t n) {
+            convert(iq, out, n, psd_scale);
+        });
+        return;
     }
 
-    // Process the rest of the frequencies (positive frequencies only)
-    // These get factor of 2 for one-sided PSD
-    for (int i = 1; i < fft_size_ / 2 && i < psd_buffer_len; ++i) {
-        float real = complex_buffer[2 * i];
-        float imag = complex_buffer[2 * i + 1];
-        power = real * real + imag * imag;
-
-        // Factor of 2 for one-sided PSD (double the power from negative frequencies)
-        psd = 2.0f * power * psd_scale;
-        psd = fmaxf(psd, epsilon);
+    // DC and Nyquist (packed in the first pair) get no factor of 2
+    const float edges_iq[4] = {complex_buffer[0], 0.0f, complex_buffer[1], 0.0f};
+    float edges[2];
+    convert(edges_iq, edges, 2, psd_scale);
+    psd_buffer[0] = edges[0];
+    if (psd_buffer_len >= fft_size_ / 2 + 1) {
+        psd_buffer[fft_size_ / 2] = edges[1];
+    }
 
-        if (db_scale) {
-            float psd_db = 10.0f * log10f(psd);
-            psd_db = fmaxf(psd_db, -floor_db);
-            psd_buffer[i] = psd_db;
-        } else {
-            psd_buffer[i] = psd;
-        }
+    // Positive frequencies get factor of 2 for one-sided PSD (double the
+    // power from negative frequencies)
+    int inner = std::min(psd_buffer_len, fft_size_ / 2) - 1;
+    if (inner > 0) {
+        convert(complex_buffer + 2, psd_buffer + 1, inner, 2.0f * psd_scale);
     }
 }
 
@@ -183,7 +166,12 @@ void FFTProcessor::generateFrequencyArray(float* freq_array,
                                          double center_freq) const {
     float bin_width = binWidth(sample_freq);
     
-    if (center_freq == 0.0) {
+    if (mode_ == FFTMode::Complex) {
+        // -Fs/2 to +Fs/2 around the center, matching the fftshifted bins
+        for (int i = 0; i < freq_len; ++i) {
+            freq_array[i] = center_freq + (i - fft_size_ / 2) * bin_width;
+        }
+    } else if (center_freq == 0.0) {
         // Traditional baseband display: 0 to Nyquist
         for (int i = 0; i < freq_len; ++i) {
             freq_array[i] = i * bin_width;
@@ -198,110 +186,127 @@ void FFTProcessor::generateFrequencyArray(float* freq_array,
 
 // SpectrogramAnalyzer implementation
 
-SpectrogramAnalyzer::SpectrogramAnalyzer(int fft_size, float sample_rate)
-    : sample_rate_(sample_rate)
+static SpectrumFrame makeSpectrumFrame(int num_bins) {
+    SpectrumFrame frame;
+    frame.magnitude_db.resize(num_bins);
+    frame.psd.resize(num_bins);
+    return frame;
+}
+
+SpectrogramAnalyzer::SpectrogramAnalyzer(int fft_size, float sample_rate, FFTMode mode,
+                                         WindowType window)
+    : fft_processor_(std::make_unique<FFTProcessor>(fft_size, mode))
+    , window_(FFTPlanCache::instance().window(window, fft_size))
+    , kernels_(spectrumKernels())
+    , spectra_(makeSpectrumFrame(fft_processor_->getNumBins()))
+    , sample_rate_(sample_rate)
     , fft_size_(fft_size)
-    , write_pos_(0)
-    , spectrum_ready_(false)
-	, psd_ready_(false) {
-    
-    fft_processor_ = std::make_unique<FFTProcessor>(fft_size);
+    , channels_(mode == FFTMode::Complex ? 2 : 1) {
     
-    // Allocate buffers
-    input_buffer_.resize(fft_size * 2);
-    fft_output_.resize(fft_size);
-    magnitude_buffer_.resize(fft_processor_->getNumBins());
-	psd_buffer_.resize(fft_processor_->getNumBins());
+    // Allocate buffers, interleaved real/imag in complex mode
+    pending_.resize(fft_size);
+    frame_buffer_.resize(fft_size * channels_);
+    fft_output_.resize(fft_size * channels_);
+    fft_processor_->setWindowGains(window_->coherent_gain, window_->power_gain);
     
     std::cout << "SpectrogramAnalyzer initialized: FFT=" << fft_size 
-              << ", bins=" << fft_processor_->getNumBins() << std::endl;
+              << ", bins=" << fft_processor_->getNumBins()
+              << ", window=" << windowName(window) << std::endl;
 }
 
 void SpectrogramAnalyzer::processSamples(const float* samples, size_t count) {
-    for (size_t i = 0; i < count; ++i) {
-        input_buffer_[write_pos_] = samples[i];
-        write_pos_ = (write_pos_ + 1) % input_buffer_.size();
-        
-        // Process frame when we have enough samples
-        if (write_pos_ % fft_size_ == 0) {
-            processFrame();
+    size_t i = 0;
+    while (i < count) {
+        size_t n = std::min(count - i, fft_size_ - pending_count_);
+        for (size_t j = 0; j < n; ++j) {
+            pending_[pending_count_ + j] = std::complex<float>(samples[i + j], 0.0f);
         }
+        pending_count_ += n;
+        i += n;
+        flushPending();
     }
 }
 
 void SpectrogramAnalyzer::processSamples(const std::complex<float>* samples, size_t count) {
-    // Extract real part from complex samples for now
-    // TODO: Could be enhanced to use complex FFT
-    for (size_t i = 0; i < count; ++i) {
-        input_buffer_[write_pos_] = samples[i].real();
-        write_pos_ = (write_pos_ + 1) % input_buffer_.size();
-        
-        // Process frame when we have enough samples
-        if (write_pos_ % fft_size_ == 0) {
-            processFrame();
+    size_t i = 0;
+    while (i < count) {
+        // Whole frames are windowed straight from the caller's buffer
+        if (pending_count_ == 0 && count - i >= static_cast<size_t>(fft_size_)) {
+            frameSamples(samples + i, fft_size_, 0);
+            computeSpectrum();
+            i += fft_size_;
+            continue;
         }
+        size_t n = std::min(count - i, fft_size_ - pending_count_);
+        std::copy(samples + i, samples + i + n, pending_.begin() + pending_count_);
+        pending_count_ += n;
+        i += n;
+        flushPending();
     }
 }
 
-void SpectrogramAnalyzer::processFrame() {
-    // Extract latest frame from circular buffer
-    std::vector<float> frame(fft_size_);
-    size_t read_pos = (write_pos_ + input_buffer_.size() - fft_size_) % input_buffer_.size();
-    
-    for (int i = 0; i < fft_size_; ++i) {
-        frame[i] = input_buffer_[read_pos];
-        read_pos = (read_pos + 1) % input_buffer_.size();
+void SpectrogramAnalyzer::flushPending() {
+    if (pending_count_ == static_cast<size_t>(fft_size_)) {
+        frameSamples(pending_.data(), fft_size_, 0);
+        pending_count_ = 0;
+        computeSpectrum();
     }
-    
+}
+
+void SpectrogramAnalyzer::frameSamples(const std::complex<float>* samples, size_t count, size_t offset) {
+    // Real mode keeps the real part only
+    const float* iq = reinterpret_cast<const float*>(samples);
+    const float* window = window_->coefficients.data() + offset;
+    if (channels_ == 2) {
+        kernels_.windowComplex(iq, window, frame_buffer_.data() + 2 * offset, count);
+    } else {
+        kernels_.windowReal(iq, window, frame_buffer_.data() + offset, count);
+    }
+}
+
+void SpectrogramAnalyzer::processSamples(BroadcastRing<std::complex<float>>::Reader& reader) {
+    int decimation = frame_decimation_.load(std::memory_order_relaxed);
+    while (reader.Available() >= static_cast<size_t>(fft_size_)) {
+        if (skipped_frames_ + 1 < decimation) {
+            reader.Consume(fft_size_);
+            ++skipped_frames_;
+            continue;
+        }
+        skipped_frames_ = 0;
+        // A frame across the ring's wrap is framed in two pieces, no unwrap copy
+        auto view = reader.Peek(fft_size_);
+        frameSamples(view.first, view.first_size, 0);
+        if (!view.Contiguous()) {
+            frameSamples(view.second, view.second_size, view.first_size);
+        }
+        // Frame was overwritten while being read; the reader has skipped ahead
+        if (!reader.Consume(fft_size_)) {
+            continue;
+        }
+        computeSpectrum();
+    }
+}
+
+void SpectrogramAnalyzer::computeSpectrum() {
     // Perform FFT
-    fft_processor_->forwardFFT(frame.data(), fft_output_.data());
+    fft_processor_->forwardFFT(frame_buffer_.data(), fft_output_.data());
     
-    // Convert to dB magnitude
-    fft_processor_->complexToRealDB(magnitude_buffer_.data(), 
+    // Both results go straight into the mailbox slot the GUI can't see yet
+    SpectrumFrame& out = spectra_.WriteBuffer();
+    fft_processor_->complexToRealDB(out.magnitude_db.data(), 
                                    fft_output_.data(),
-                                   magnitude_buffer_.size(),
+                                   out.magnitude_db.size(),
                                    true,	// scale
                                    80.0f);
 
-	fft_processor_->complexToPSD(psd_buffer_.data(),
+	fft_processor_->complexToPSD(out.psd.data(),
                                 fft_output_.data(),
-                                psd_buffer_.size(),
+                                out.psd.size(),
                                 sample_rate_,
                                 false,		// scale
                                 80.0f);
     
-    spectrum_ready_ = true;
-	psd_ready_ = true;
-}
-
-bool SpectrogramAnalyzer::getLatestSpectrum(float* output, int output_len) {
-    if (!spectrum_ready_) {
-        return false;
-    }
-    
-    int copy_len = std::min(output_len, static_cast<int>(magnitude_buffer_.size()));
-    std::memcpy(output, magnitude_buffer_.data(), copy_len * sizeof(float));
-    
-    spectrum_ready_ = false;  // Mark as consumed
-    return true;
-}
-
-bool SpectrogramAnalyzer::getLatestPSD(float* output, int output_len, bool db_scale) {
-    if (!psd_ready_) {
-        return false;
-    }
-    if (db_scale) {
-        int copy_len = std::min(output_len, static_cast<int>(psd_buffer_.size()));
-        std::memcpy(output, psd_buffer_.data(), copy_len * sizeof(float));
-    } else {
-        // Convert from dB back to linear if needed
-        // For now, just copy dB values - linear conversion can be added later if needed
-        int copy_len = std::min(output_len, static_cast<int>(psd_buffer_.size()));
-        std::memcpy(output, psd_buffer_.data(), copy_len * sizeof(float));
-    }
-
-    psd_ready_ = false;  // Mark as consumed
-    return true;
+    spectra_.Publish();
 }
 
 void SpectrogramAnalyzer::getFrequencyArray(float* freq_array, int freq_len, double center_freq) {
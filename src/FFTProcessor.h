@@ -1,19 +1,27 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <vector>
 #include <memory>
 #include <complex>
+#include "BroadcastRing.h"
+#include "BufferMemory.h"
+#include "FFTPlanCache.h"
+#include "TripleBuffer.h"
+#include "Window.h"
 
-// Forward declare PFFFT types
-typedef struct PFFFT_Setup PFFFT_Setup;
+struct SpectrumKernels;
 
 /**
  * Simple FFT processor based on Spectrolysis implementation
- * Uses PFFFT for high-performance real-to-complex transforms
+ * Uses PFFFT for high-performance real-to-complex and complex transforms,
+ * with the setup shared through FFTPlanCache and the calling thread's
+ * scratch as work buffer, so construction is cheap once the plan exists
  */
 class FFTProcessor {
 public:
-    explicit FFTProcessor(int fft_size);
+    explicit FFTProcessor(int fft_size, FFTMode mode = FFTMode::Real);
     ~FFTProcessor();
     
     // Delete copy constructor and assignment operator
@@ -21,9 +29,11 @@ public:
     FFTProcessor& operator=(const FFTProcessor&) = delete;
     
     /**
-     * Perform forward FFT on real input
-     * @param input_buffer Real input samples (size = fft_size)
-     * @param output_buffer Complex output (size = fft_size, interleaved real/imag)
+     * Perform forward FFT
+     * @param input_buffer Real: fft_size samples. Complex: fft_size interleaved
+     *        real/imag samples (2 * fft_size floats)
+     * @param output_buffer Complex output, interleaved real/imag; fft_size
+     *        floats for real input, 2 * fft_size for complex
      */
     void forwardFFT(const float* input_buffer, float* output_buffer);
     
@@ -31,8 +41,8 @@ public:
      * Convert complex FFT output to real magnitude values
      * @param real_buffer Output magnitude buffer
      * @param complex_buffer Complex FFT output from forwardFFT
-     * @param real_buffer_len Length of output buffer (usually fft_size/2 + 1)
-     * @param normalize If true, normalize by 1/2N for amplitude
+     * @param real_buffer_len Length of output buffer (usually getNumBins())
+     * @param normalize If true, normalize for amplitude (1/2N one-sided, 1/N two-sided)
      */
     void complexToReal(float* real_buffer, 
                       const float* complex_buffer,
@@ -43,7 +53,7 @@ public:
      * Convert complex FFT output to dB magnitude values
      * @param real_buffer Output dB buffer
      * @param complex_buffer Complex FFT output from forwardFFT
-     * @param real_buffer_len Length of output buffer (usually fft_size/2 + 1)
+     * @param real_buffer_len Length of output buffer (usually getNumBins())
      * @param scale If true, scale dB values 0-1 for display
      * @param floor_db Noise floor level in dB (positive value, will be made negative)
      */
@@ -57,7 +67,7 @@ public:
      * Convert complex FFT output to Power Spectral Density (PSD) values
      * @param psd_buffer Output PSD buffer
      * @param complex_buffer Complex FFT output from forwardFFT
-     * @param psd_buffer_len Length of output buffer (usually fft_size/2 + 1)
+     * @param psd_buffer_len Length of output buffer (usually getNumBins())
      * @param sample_rate Sampling frequency in Hz
      * @param db_scale If true, return PSD in dB (10*log10), otherwise linear
      * @param floor_db Noise floor level in dB for dB scale (positive value)
@@ -88,24 +98,68 @@ public:
                                int freq_len,
                                double center_freq = 0.0) const;
     
+    /**
+     * Gains of the window the input was multiplied by, so dB magnitudes and
+     * PSD come out as without one: magnitudes are divided by the coherent
+     * gain, PSD by the power gain. Both 1 (rectangular) by default
+     */
+    void setWindowGains(float coherent_gain, float power_gain) {
+        coherent_gain_ = coherent_gain;
+        power_gain_ = power_gain;
+    }
+    
     int getFFTSize() const { return fft_size_; }
-    int getNumBins() const { return fft_size_ / 2 + 1; }
+    int getNumBins() const { return mode_ == FFTMode::Complex ? fft_size_ : fft_size_ / 2 + 1; }
+    FFTMode getMode() const { return mode_; }
     
 private:
-    PFFFT_Setup* setup_;
-    std::vector<float> work_buffer_;
+    std::shared_ptr<const FFTPlan> plan_;
     int fft_size_;
-    
-    void cleanup();
+    FFTMode mode_;
+    float coherent_gain_ = 1.0f;
+    float power_gain_ = 1.0f;
+
+    // FFT index shown at fftshifted bin i (complex mode)
+    int shiftedIndex(int i) const {
+        return i < fft_size_ / 2 ? i + fft_size_ / 2 : i - fft_size_ / 2;
+    }
+
+    // convert(iq, out, n) over both halves of the FFT so out is fftshifted
+    template<typename Convert>
+    void convertShifted(float* out, const float* complex_buffer, int len, Convert convert) const {
+        const int half = fft_size_ / 2;
+        int upper = std::min(len, half);
+        if (upper > 0) {
+            convert(complex_buffer + 2 * half, out, upper);
+        }
+        if (len > half) {
+            convert(complex_buffer, out + half, len - half);
+        }
+    }
+};
+
+/**
+ * Magnitude and PSD of the same FFT frame, handed to the GUI as one unit
+ */
+struct SpectrumFrame {
+    std::vector<float> magnitude_db;    // Scaled 0-1 dB magnitude
+    std::vector<float> psd;             // Linear PSD
 };
 
 /**
  * Simple spectrogram analyzer that processes audio samples
  * and generates magnitude spectra for display
+ * Complex mode (default) shows the whole captured band of IQ input; real
+ * mode transforms the real part only, the old half-band view
+ *
+ * Framing is one pass per frame: window multiply, deinterleave (real mode)
+ * and the copy into the aligned FFT input, straight from wherever the
+ * samples are. Nothing is allocated per frame.
  */
 class SpectrogramAnalyzer {
 public:
-    SpectrogramAnalyzer(int fft_size, float sample_rate);
+    SpectrogramAnalyzer(int fft_size, float sample_rate, FFTMode mode = FFTMode::Complex,
+                        WindowType window = WindowType::Blackman);
     ~SpectrogramAnalyzer() = default;
     
     /**
@@ -115,23 +169,26 @@ public:
      */
     void processSamples(const float* samples, size_t count);
     void processSamples(const std::complex<float>* samples, size_t count);
-    
+
     /**
-     * Get the latest magnitude spectrum in dB
-     * @param output Output buffer for magnitude spectrum
-     * @param output_len Length of output buffer
-     * @return true if new data is available
+     * Consume whole frames straight out of a shared IQ ring (no staging copy)
+     * @param reader This analyzer's cursor into the ring
      */
-    bool getLatestSpectrum(float* output, int output_len);
+    void processSamples(BroadcastRing<std::complex<float>>::Reader& reader);
     
     /**
-     * Get the latest PSD spectrum
-     * @param output Output buffer for PSD spectrum
-     * @param output_len Length of output buffer
-     * @param db_scale If true, return PSD in dB
-     * @return true if new data is available
+     * Switch to the newest spectrum, called from the GUI thread. Wait-free
+     * against the analyzer, which keeps producing on the RX thread
+     * @return true if a new frame arrived since the last call
      */
-    bool getLatestPSD(float* output, int output_len, bool db_scale = true);
+    bool updateSpectrum() { return spectra_.Update(); }
+
+    /**
+     * Frame picked up by the last updateSpectrum(); complete and untouched
+     * by the producer until the next call, so it can be drawn in place
+     */
+    const SpectrumFrame& latestSpectrum() const { return spectra_.Read(); }
+    bool hasSpectrum() const { return spectra_.Published() > 0; }
     
     /**
      * Get frequency array for the spectrum bins
@@ -142,19 +199,39 @@ public:
     void getFrequencyArray(float* freq_array, int freq_len, double center_freq = 0.0);
     
     int getNumBins() const { return fft_processor_->getNumBins(); }
+    FFTMode getMode() const { return fft_processor_->getMode(); }
+    int getFFTSize() const { return fft_size_; }
+    WindowType getWindowType() const { return window_->type; }
+    const WindowTable& getWindow() const { return *window_; }
+
+    /**
+     * Compute only 1 of every n frames from the ring, the rest are consumed
+     * unread; for displays that refresh slower than frames arrive. Any thread
+     */
+    void setFrameDecimation(int n) { frame_decimation_.store(n < 1 ? 1 : n); }
+    int getFrameDecimation() const { return frame_decimation_.load(); }
     
 private:
+    using AlignedBuffer = std::vector<float, BufferAllocator<float>>;  // 64 byte aligned
+
     std::unique_ptr<FFTProcessor> fft_processor_;
-    std::vector<float> input_buffer_;
-    std::vector<float> fft_output_;
-    std::vector<float> magnitude_buffer_;
-    std::vector<float> psd_buffer_;
+    std::shared_ptr<const WindowTable> window_;    // Shared through FFTPlanCache
+    const SpectrumKernels& kernels_;
+    std::vector<std::complex<float>> pending_;     // Partial frame from pointer input
+    size_t pending_count_ = 0;
+    AlignedBuffer frame_buffer_;                    // Windowed FFT input
+    AlignedBuffer fft_output_;
+    TripleBuffer<SpectrumFrame> spectra_;
     
     float sample_rate_;
     int fft_size_;
-    size_t write_pos_;
-    bool spectrum_ready_;
-    bool psd_ready_;
-    
-    void processFrame();
+    int channels_;          // Floats per sample: 2 for complex, 1 for real
+    std::atomic<int> frame_decimation_{1};
+    int skipped_frames_ = 0;
+    
+    // Window count samples into the frame starting at sample offset
+    void frameSamples(const std::complex<float>* samples, size_t count, size_t offset);
+    // Frame pending_ once it holds fft_size samples
+    void flushPending();
+    void computeSpectrum();
 };
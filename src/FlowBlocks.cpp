@@ -0,0 +1,170 @@
+#include "FlowBlocks.h"
+#include "SDRDevice.h"
+#include "SpectrumKernels.h"
+#include <algorithm>
+#include <iostream>
+
+// DeviceSourceBlock
+
+bool DeviceSourceBlock::start(SDRDevice& device, size_t buffer_size) {
+    if (!out.connected()) {
+        std::cerr << "DeviceSourceBlock: output not connected" << std::endl;
+        return false;
+    }
+    return device.startReceivingInto(this, buffer_size);
+}
+
+RxBufferProvider::Span DeviceSourceBlock::acquire(size_t max_samples) {
+    auto span = out.edge()->Reserve(max_samples);
+    return {span.data, span.size};
+}
+
+void DeviceSourceBlock::commit(size_t count, const SampleMetadata& metadata) {
+    out.edge()->Commit(count);
+    last_metadata_.Store(metadata);
+    // No work of its own, only counts and the edge fill
+    probe_.record(0, count, out.edge()->Stats());
+    wake();
+}
+
+SampleMetadata DeviceSourceBlock::lastMetadata() const {
+    return last_metadata_.Load();
+}
+
+// DecimateBlock
+
+DecimateBlock::DecimateBlock(size_t factor)
+    : FlowBlock("decimate")
+    , factor_(std::max<size_t>(factor, 1)) {
+}
+
+size_t DecimateBlock::work(size_t max_items) {
+    FlowEdge<std::complex<float>>* input = in.edge();
+    FlowEdge<std::complex<float>>* output = out.edge();
+
+    size_t outputs = std::min(input->Available(), std::max(max_items, factor_)) / factor_;
+    auto span = output->Reserve(outputs);
+    outputs = span.size;
+    if (outputs == 0) {
+        return 0;
+    }
+
+    const std::complex<float>* samples = input->Window(outputs * factor_);
+    const float scale = 1.0f / factor_;
+    for (size_t o = 0; o < outputs; ++o) {
+        std::complex<float> sum(0.0f, 0.0f);
+        for (size_t i = 0; i < factor_; ++i) {
+            sum += samples[o * factor_ + i];
+        }
+        span.data[o] = sum * scale;
+    }
+    output->Commit(outputs);
+    input->Consume(outputs * factor_);
+    return outputs * factor_;
+}
+
+size_t DecimateBlock::backlog() const {
+    return in.edge()->Available();
+}
+
+BufferStats DecimateBlock::inputStats() const {
+    return in.edge()->Stats();
+}
+
+// FFTBlock
+
+FFTBlock::FFTBlock(int fft_size, bool scale, float floor_db, WindowType window)
+    : FlowBlock("fft")
+    , fft_(fft_size, FFTMode::Complex)
+    , window_(FFTPlanCache::instance().window(window, fft_size))
+    , kernels_(spectrumKernels())
+    , scale_(scale)
+    , floor_db_(floor_db)
+    , frame_(2 * fft_size)
+    , spectrum_(2 * fft_size) {
+    fft_.setWindowGains(window_->coherent_gain, window_->power_gain);
+}
+
+size_t FFTBlock::work(size_t max_items) {
+    FlowEdge<std::complex<float>>* input = in.edge();
+    FlowEdge<float>* output = out.edge();
+    const size_t fft_size = window_->coefficients.size();
+    const size_t bins = fft_.getNumBins();
+
+    // At least one frame per call even if the batch is smaller than a frame
+    size_t frames = std::max<size_t>(max_items / fft_size, 1);
+    frames = std::min(frames, input->Available() / fft_size);
+
+    size_t done = 0;
+    for (; done < frames; ++done) {
+        auto span = output->ReserveRecord(bins);
+        if (span.size == 0) {
+            break;      // Downstream is backed up
+        }
+        // Window multiply is the only pass over the input
+        const float* iq = reinterpret_cast<const float*>(input->Window(fft_size));
+        kernels_.windowComplex(iq, window_->coefficients.data(), frame_.data(), fft_size);
+        input->Consume(fft_size);
+
+        fft_.forwardFFT(frame_.data(), spectrum_.data());
+        fft_.complexToRealDB(span.data, spectrum_.data(), bins, scale_, floor_db_);
+        output->Commit(bins);
+    }
+    return done * fft_size;
+}
+
+size_t FFTBlock::backlog() const {
+    return in.edge()->Available();
+}
+
+BufferStats FFTBlock::inputStats() const {
+    return in.edge()->Stats();
+}
+
+// STFTBlock
+
+STFTBlock::STFTBlock(int fft_size, int fft_stride, float sample_rate, int time_frames,
+                     size_t image_hop)
+    : FlowBlock("stft")
+    , stft_(fft_size, fft_stride, sample_rate)
+    , window_(fft_size + static_cast<size_t>(time_frames - 1) * fft_stride)
+    , hop_(image_hop ? image_hop : window_)
+    , image_size_(static_cast<size_t>(fft_size) * time_frames) {
+}
+
+size_t STFTBlock::work(size_t max_items) {
+    FlowEdge<std::complex<float>>* input = in.edge();
+    FlowEdge<float>* output = out.edge();
+
+    size_t images = std::max<size_t>(max_items / hop_, 1);
+    size_t done = 0;
+    for (; done < images; ++done) {
+        // A hop past the window skips input, which must be there to consume
+        if (input->Available() < std::max(window_, hop_)) {
+            break;
+        }
+        auto span = output->ReserveRecord(image_size_);
+        if (span.size == 0) {
+            break;
+        }
+        // Edge memory in, edge memory out
+        float* image = span.data;
+        int freq_bins = 0;
+        int time_frames = 0;
+        if (!stft_.computeSpectrogram(input->Window(window_), window_, &image,
+                                      &freq_bins, &time_frames)) {
+            break;
+        }
+        output->Commit(image_size_);
+        input->Consume(hop_);
+    }
+    return done * hop_;
+}
+
+size_t STFTBlock::backlog() const {
+    return in.edge()->Available();
+}
+
+BufferStats STFTBlock::inputStats() const {
+    return in.edge()->Stats();
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <complex>
+#include <memory>
+#include <vector>
+
+#include "FlowGraph.h"
+#include "FFTProcessor.h"
+#include "STFTSpectrogram.h"
+#include "RxBufferProvider.h"
+
+class SDRDevice;
+
+/**
+ * Device as the head of a flow graph
+ * The device's RX thread recv()s straight into the output edge through the
+ * RxBufferProvider interface; when the edge is full the device sees no room
+ * and counts an overflow, same as with the GUI's IQ ring.
+ */
+class DeviceSourceBlock : public FlowBlock, public RxBufferProvider {
+public:
+    DeviceSourceBlock() : FlowBlock("source") {}
+
+    OutputPort<std::complex<float>> out;
+
+    // Starts reception into out, which must be connected
+    bool start(SDRDevice& device, size_t buffer_size = 4096);
+
+    // Driven by the device thread, nothing for the pool to do
+    size_t work(size_t) override { return 0; }
+
+    // RxBufferProvider, device RX thread
+    Span acquire(size_t max_samples) override;
+    void commit(size_t count, const SampleMetadata& metadata) override;
+
+    // Metadata of the newest block, for the samples now at the edge's head
+    SampleMetadata lastMetadata() const;
+
+private:
+    Seqlock<SampleMetadata> last_metadata_;
+};
+
+/**
+ * Boxcar low-pass and decimation by an integer factor
+ * Each output sample is the mean of factor input samples
+ */
+class DecimateBlock : public FlowBlock {
+public:
+    explicit DecimateBlock(size_t factor);
+
+    InputPort<std::complex<float>> in;
+    OutputPort<std::complex<float>> out;
+
+    size_t work(size_t max_items) override;
+    size_t backlog() const override;
+    BufferStats inputStats() const override;
+
+private:
+    size_t factor_;
+};
+
+/**
+ * FFTProcessor as a block: one two-sided, fftshifted dB magnitude frame of
+ * fft_size floats per fft_size IQ samples, like SpectrogramAnalyzer's. Frames
+ * are windowed straight from the input edge and written into the output edge
+ */
+class FFTBlock : public FlowBlock {
+public:
+    FFTBlock(int fft_size, bool scale = true, float floor_db = 80.0f,
+             WindowType window = WindowType::Blackman);
+
+    InputPort<std::complex<float>> in;
+    OutputPort<float> out;              // num_bins floats per frame
+
+    size_t work(size_t max_items) override;
+    size_t backlog() const override;
+    BufferStats inputStats() const override;
+
+    int numBins() const { return fft_.getNumBins(); }
+
+private:
+    using AlignedBuffer = std::vector<float, BufferAllocator<float>>;  // 64 byte aligned
+
+    FFTProcessor fft_;
+    std::shared_ptr<const WindowTable> window_;    // Shared through FFTPlanCache
+    const SpectrumKernels& kernels_;
+    bool scale_;
+    float floor_db_;
+    AlignedBuffer frame_;               // Windowed IQ, interleaved
+    AlignedBuffer spectrum_;            // PFFFT output
+};
+
+/**
+ * STFTSpectrogram as a block: one freq_bins x time_frames dB image per
+ * window of input, computed from edge memory into edge memory
+ */
+class STFTBlock : public FlowBlock {
+public:
+    /**
+     * @param time_frames Frames per image
+     * @param image_hop Input samples between images, 0 = back to back; more than
+     *        windowSamples() skips the input in between
+     */
+    STFTBlock(int fft_size, int fft_stride, float sample_rate, int time_frames,
+              size_t image_hop = 0);
+
+    InputPort<std::complex<float>> in;
+    OutputPort<float> out;              // imageSize() floats per image
+
+    size_t work(size_t max_items) override;
+    size_t backlog() const override;
+    BufferStats inputStats() const override;
+
+    size_t windowSamples() const { return window_; }
+    size_t imageSize() const { return image_size_; }
+
+private:
+    STFTSpectrogram stft_;
+    size_t window_;
+    size_t hop_;
+    size_t image_size_;
+};
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+#include <type_traits>
+#include "MirroredBuffer.h"
+#include "BufferStats.h"
+
+/**
+ * Bounded single producer / single consumer ring connecting two flow blocks
+ *
+ * Unlike the IQ rings this one applies backpressure: the producer only gets
+ * free space, so a backed-up consumer slows its upstream block down instead of
+ * losing data. Storage is a MirroredBuffer, so both the producer's Reserve()
+ * span and the consumer's Window() are a single contiguous pointer into ring
+ * memory and blocks compute straight from one edge into the next. Without the
+ * double mapping, Reserve() stops at the wrap, ReserveRecord() stages the rare
+ * straddling record and Commit() copies it in, and Window() unwraps the rare
+ * straddling window into a scratch copy.
+ */
+template<typename T>
+class FlowEdge {
+	static_assert(std::is_trivially_copyable<T>::value,
+			"FlowEdge requires trivially copyable elements");
+
+public:
+	// mirror = false always takes the flat fallback, as without memfd
+	explicit FlowEdge(size_t capacity, const MemoryPolicy& memory = MemoryPolicy(),
+					  bool mirror = true)
+		: storage_(RoundUpPow2(std::max(capacity, MIN_BYTES / sizeof(T))) * sizeof(T), memory,
+				   mirror)
+		, data_(static_cast<T*>(storage_.data()))
+		, capacity_(storage_.size() / sizeof(T))
+		, mask_(capacity_ - 1) {
+		std::fill(data_, data_ + capacity_, T{});
+	}
+
+	FlowEdge(const FlowEdge&) = delete;
+	FlowEdge& operator=(const FlowEdge&) = delete;
+
+	/********************************PRODUCER**********************************/
+
+	struct WriteSpan {
+		T* data = nullptr;
+		size_t size = 0;
+	};
+
+	// Contiguous free space, at most count (size 0 when the edge is full)
+	WriteSpan Reserve(size_t count) {
+		size_t head = head_.load(std::memory_order_relaxed);
+		size_t idx = head & mask_;
+		count = std::min(count, Free());
+		if (!storage_.isMirrored()) {
+			count = std::min(count, capacity_ - idx);
+		}
+		staged_ = false;
+		return {data_ + idx, count};
+	}
+
+	/**
+	 * Exactly count elements as one pointer, size 0 if fewer are free. For
+	 * fixed-size records, which would otherwise never fit again once the head
+	 * parks short of an unmirrored wrap: such a record is written to a scratch
+	 * span and Commit() copies it into the ring in two pieces
+	 */
+	WriteSpan ReserveRecord(size_t count) {
+		if (count > Free()) {
+			return {};
+		}
+		size_t idx = head_.load(std::memory_order_relaxed) & mask_;
+		staged_ = !storage_.isMirrored() && idx + count > capacity_;
+		if (!staged_) {
+			return {data_ + idx, count};
+		}
+		stage_.resize(count);
+		return {stage_.data(), count};
+	}
+
+	// Publish the first count elements of the last Reserve() or ReserveRecord()
+	void Commit(size_t count) {
+		if (staged_) {
+			size_t idx = head_.load(std::memory_order_relaxed) & mask_;
+			size_t first = std::min(count, capacity_ - idx);
+			std::memcpy(data_ + idx, stage_.data(), first * sizeof(T));
+			std::memcpy(data_, stage_.data() + first, (count - first) * sizeof(T));
+			staged_ = false;
+		}
+		size_t head = head_.load(std::memory_order_relaxed) + count;
+		head_.store(head, std::memory_order_release);
+		size_t fill = head - tail_.load(std::memory_order_acquire);
+		if (fill > high_water_.load(std::memory_order_relaxed)) {
+			high_water_.store(fill, std::memory_order_relaxed);
+		}
+	}
+
+	size_t Free() const {
+		return capacity_ - (head_.load(std::memory_order_relaxed) -
+							tail_.load(std::memory_order_acquire));
+	}
+
+	/********************************CONSUMER**********************************/
+
+	size_t Available() const {
+		return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * The next count unread elements as one pointer, nullptr if fewer are
+	 * available. Stays valid until Consume(); the producer cannot reuse the
+	 * slots before that
+	 */
+	const T* Window(size_t count) {
+		if (count > Available()) {
+			return nullptr;
+		}
+		size_t idx = tail_.load(std::memory_order_relaxed) & mask_;
+		if (storage_.isMirrored() || idx + count <= capacity_) {
+			return data_ + idx;
+		}
+		size_t first = capacity_ - idx;
+		unwrap_.resize(count);
+		std::memcpy(unwrap_.data(), data_ + idx, first * sizeof(T));
+		std::memcpy(unwrap_.data() + first, data_, (count - first) * sizeof(T));
+		return unwrap_.data();
+	}
+
+	void Consume(size_t count) {
+		tail_.store(tail_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+	}
+
+	/*********************************COMMON***********************************/
+
+	// Nothing is ever dropped on an edge, fill is Available()
+	BufferStats Stats() const {
+		BufferStats stats;
+		stats.capacity = capacity_;
+		stats.fill = head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+		stats.high_water = high_water_.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	size_t Capacity() const {
+		return capacity_;
+	}
+
+	bool IsMirrored() const {
+		return storage_.isMirrored();
+	}
+
+private:
+	static constexpr size_t CACHE_LINE = 64;
+	static constexpr size_t MIN_BYTES = 4096;	// One page, the smallest mirrorable size
+
+	MirroredBuffer storage_;
+	T* data_;
+	size_t capacity_;	// Power of two
+	size_t mask_;
+
+	alignas(CACHE_LINE) std::atomic<size_t> head_{0};	// Producer owned
+	alignas(CACHE_LINE) std::atomic<size_t> tail_{0};	// Consumer owned
+	std::atomic<size_t> high_water_{0};
+	std::vector<T> unwrap_;		// Consumer scratch, only without the mirror
+	std::vector<T> stage_;		// Producer scratch, only without the mirror
+	bool staged_ = false;		// Last reservation is in stage_
+
+	static size_t RoundUpPow2(size_t n) {
+		size_t p = 1;
+		while (p < n) { p <<= 1; }
+		return p;
+	}
+};
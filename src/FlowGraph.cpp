@@ -0,0 +1,120 @@
+#include "FlowGraph.h"
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <pthread.h>
+#include <time.h>
+
+namespace {
+
+// Thread CPU time, so per-block accounting excludes time spent preempted
+int64_t threadCpuTimeNs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+// Safety net only, notify() never loses a wakeup
+constexpr std::chrono::milliseconds IDLE_TIMEOUT{100};
+
+}
+
+FlowGraph::FlowGraph(size_t min_batch, size_t max_batch)
+    : min_batch_(std::max<size_t>(min_batch, 1))
+    , max_batch_(std::max(max_batch, min_batch)) {
+}
+
+FlowGraph::~FlowGraph() {
+    stop();
+}
+
+bool FlowGraph::start(size_t num_threads) {
+    if (isRunning()) {
+        return true;
+    }
+    if (blocks_.empty()) {
+        std::cerr << "FlowGraph: nothing to run" << std::endl;
+        return false;
+    }
+    stop_.store(false);
+    num_threads = std::max<size_t>(num_threads, 1);
+    try {
+        for (size_t i = 0; i < num_threads; ++i) {
+            threads_.emplace_back(&FlowGraph::runThread, this, i);
+            std::string name = "osprey-flow" + std::to_string(i);
+            pthread_setname_np(threads_.back().native_handle(), name.c_str());
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "FlowGraph: failed to start pool: " << e.what() << std::endl;
+        stop();
+        return false;
+    }
+    return true;
+}
+
+void FlowGraph::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_.store(true);
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+    threads_.clear();
+}
+
+void FlowGraph::notify() {
+    epoch_.fetch_add(1);
+    // Sleepers re-check epoch_ under the lock after registering, so either
+    // they see this bump or we see them and wake them
+    if (sleepers_.load() > 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wake_.notify_all();
+    }
+}
+
+void FlowGraph::runThread(size_t index) {
+    const size_t n = blocks_.size();
+    while (!stop_.load()) {
+        uint64_t seen = epoch_.load();
+        bool progress = false;
+
+        // Start each thread at a different block so they spread out
+        for (size_t i = 0; i < n; ++i) {
+            FlowBlock& block = *blocks_[(index + i) % n];
+            if (block.busy_.exchange(true, std::memory_order_acquire)) {
+                continue;
+            }
+            progress |= runBlock(block);
+            block.busy_.store(false, std::memory_order_release);
+        }
+
+        if (progress) {
+            notify();   // Downstream blocks may have work now
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        sleepers_.fetch_add(1);
+        wake_.wait_for(lock, IDLE_TIMEOUT, [this, seen]() {
+            return epoch_.load() != seen || stop_.load();
+        });
+        sleepers_.fetch_sub(1);
+    }
+}
+
+bool FlowGraph::runBlock(FlowBlock& block) {
+    size_t batch = std::min(std::max(block.backlog(), min_batch_), max_batch_);
+    BufferStats input = block.inputStats();
+
+    int64_t start = monotonicTimeNs();
+    int64_t cpu_start = threadCpuTimeNs();
+    size_t items = block.work(batch);
+    if (items == 0) {
+        return false;
+    }
+    int64_t cpu = threadCpuTimeNs() - cpu_start;
+    block.probe_.record(monotonicTimeNs() - start, items, input, cpu);
+    return true;
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "FlowEdge.h"
+#include "Telemetry.h"
+
+class FlowGraph;
+
+/**
+ * Typed endpoints of a FlowEdge, members of the blocks that use them
+ * Wired up by FlowGraph::connect(); a block only touches its side of the edge
+ */
+template<typename T>
+class OutputPort {
+public:
+    bool connected() const { return edge_ != nullptr; }
+    FlowEdge<T>* edge() const { return edge_; }
+private:
+    friend class FlowGraph;
+    FlowEdge<T>* edge_ = nullptr;
+};
+
+template<typename T>
+class InputPort {
+public:
+    bool connected() const { return edge_ != nullptr; }
+    FlowEdge<T>* edge() const { return edge_; }
+private:
+    friend class FlowGraph;
+    FlowEdge<T>* edge_ = nullptr;
+};
+
+/**
+ * One processing step of a FlowGraph
+ *
+ * The scheduler calls work() from whichever pool thread is free, but never
+ * from two threads at once, so a block's own state needs no locking. Blocks
+ * read straight from their input edge's Window() and write into the output
+ * edge's Reserve() span; nothing is staged in between.
+ */
+class FlowBlock {
+public:
+    explicit FlowBlock(const std::string& name) : name_(name) {}
+    virtual ~FlowBlock() = default;
+
+    FlowBlock(const FlowBlock&) = delete;
+    FlowBlock& operator=(const FlowBlock&) = delete;
+
+    /**
+     * Process up to max_items input items, as far as inputs and output space
+     * allow. Called with a larger max_items when the block is backed up
+     * @return Input items consumed (or items produced, for sources), 0 if idle
+     */
+    virtual size_t work(size_t max_items) = 0;
+
+    // Items waiting on the inputs, sizes the next batch
+    virtual size_t backlog() const { return 0; }
+
+    // Fill of the main input, reported alongside the timings
+    virtual BufferStats inputStats() const { return BufferStats(); }
+
+    const std::string& name() const { return name_; }
+
+    // Runs, items, wall and CPU time of work(); readable from any thread
+    StageTelemetry stats() const { return probe_.snapshot(); }
+
+protected:
+    // Blocks driven from outside the pool (device sources) announce new data
+    void wake();
+
+    StageProbe probe_;
+
+private:
+    friend class FlowGraph;
+    std::string name_;
+    FlowGraph* graph_ = nullptr;
+    std::atomic<bool> busy_{false};     // Claimed by a pool thread
+};
+
+/**
+ * Owns blocks and the edges between them and runs them on a thread pool
+ *
+ * Pool threads sweep the blocks, each claiming whichever block is free and
+ * running it with a batch sized from its backlog: min_batch normally, up to
+ * max_batch when it has fallen behind, so a backed-up chain catches up with
+ * fewer, larger calls. Threads with nothing to do sleep until a block makes
+ * progress or a source wake()s the graph.
+ */
+class FlowGraph {
+public:
+    FlowGraph(size_t min_batch = 4096, size_t max_batch = 1 << 18);
+    ~FlowGraph();
+
+    FlowGraph(const FlowGraph&) = delete;
+    FlowGraph& operator=(const FlowGraph&) = delete;
+
+    // Construct a block owned by the graph; only before start()
+    template<typename B, typename... Args>
+    B& add(Args&&... args) {
+        auto block = std::make_unique<B>(std::forward<Args>(args)...);
+        B& ref = *block;
+        block->graph_ = this;
+        blocks_.push_back(std::move(block));
+        return ref;
+    }
+
+    /**
+     * Connect an output to an input with a new edge of capacity items
+     * @param mirror false forces the edge's unmirrored fallback
+     * @return false if either port is already connected
+     */
+    template<typename T>
+    bool connect(OutputPort<T>& out, InputPort<T>& in, size_t capacity,
+                 const MemoryPolicy& memory = MemoryPolicy(), bool mirror = true) {
+        if (out.edge_ || in.edge_) {
+            return false;
+        }
+        auto edge = std::make_shared<FlowEdge<T>>(capacity, memory, mirror);
+        out.edge_ = edge.get();
+        in.edge_ = edge.get();
+        edges_.push_back(std::move(edge));
+        return true;
+    }
+
+    bool start(size_t num_threads);
+    void stop();
+    bool isRunning() const { return !threads_.empty(); }
+
+    // Something changed outside the pool, re-run idle threads
+    void notify();
+
+    size_t numBlocks() const { return blocks_.size(); }
+    const FlowBlock& block(size_t index) const { return *blocks_[index]; }
+
+private:
+    size_t min_batch_;
+    size_t max_batch_;
+
+    std::vector<std::unique_ptr<FlowBlock>> blocks_;
+    std::vector<std::shared_ptr<void>> edges_;      // Type-erased ownership
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::atomic<bool> stop_{false};
+    std::atomic<uint64_t> epoch_{0};                // Bumped on every bit of progress
+    std::atomic<size_t> sleepers_{0};
+
+    void runThread(size_t index);
+    bool runBlock(FlowBlock& block);
+};
+
+inline void FlowBlock::wake() {
+    if (graph_) {
+        graph_->notify();
+    }
+}
@@ -0,0 +1,254 @@
+#include "Logger.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <pthread.h>
+
+/**
+ * Single-producer single-consumer ring of records, one per logging thread
+ * The owning thread fills slots, the logger thread drains them
+ */
+class LogQueue {
+public:
+    static constexpr size_t CAPACITY = Logger::QUEUE_RECORDS;
+
+    LogRecord* acquire() {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == CAPACITY) {
+            return nullptr;
+        }
+        return &records_[tail % CAPACITY];
+    }
+
+    void publish() {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void drainInto(std::vector<LogRecord>& out) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        for (; head != tail; ++head) {
+            out.push_back(records_[head % CAPACITY]);
+        }
+        head_.store(head, std::memory_order_release);
+    }
+
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    // Set when the owning thread exits; the queue goes once drained
+    std::atomic<bool> closed{false};
+
+private:
+    LogRecord records_[CAPACITY];
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+};
+
+namespace {
+
+constexpr auto DRAIN_INTERVAL = std::chrono::milliseconds(10);
+
+// Owns the calling thread's queue, closes it when the thread exits
+struct ThreadQueue {
+    std::shared_ptr<LogQueue> queue;
+    ~ThreadQueue() {
+        if (queue) {
+            queue->closed.store(true, std::memory_order_release);
+        }
+    }
+};
+
+thread_local ThreadQueue current_queue;
+
+void appendArg(std::ostringstream& out, const LogRecord& record, const LogRecord::Arg& arg) {
+    switch (arg.type) {
+        case LogRecord::Arg::INT:
+            out << arg.i;
+            break;
+        case LogRecord::Arg::UINT:
+            out << arg.u;
+            break;
+        case LogRecord::Arg::DOUBLE:
+            out << arg.d;
+            break;
+        case LogRecord::Arg::BOOL:
+            out << (arg.u ? "true" : "false");
+            break;
+        case LogRecord::Arg::CHAR:
+            out << static_cast<char>(arg.i);
+            break;
+        case LogRecord::Arg::TEXT:
+            out.write(record.text + arg.offset, arg.length);
+            break;
+    }
+}
+
+}
+
+Logger& Logger::instance() {
+    static Logger* logger = []() {
+        Logger* created = new Logger();
+        std::atexit([]() { Logger::instance().shutdown(); });
+        return created;
+    }();
+    return *logger;
+}
+
+Logger::Logger() {
+    thread_ = std::thread(&Logger::run, this);
+    pthread_setname_np(thread_.native_handle(), "osprey-log");
+}
+
+void Logger::setSink(Sink sink) {
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    sink_ = std::move(sink);
+}
+
+void Logger::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // A pass already running may have missed the caller's records, the one
+    // after it cannot have
+    uint64_t target = passes_ + 2;
+    flush_requested_ = true;
+    wake_.notify_one();
+    drained_.wait(lock, [&]() { return passes_ >= target || stopped_; });
+}
+
+std::string Logger::format(const LogRecord& record) {
+    std::ostringstream out;
+    size_t next = 0;
+    for (const char* p = record.site->format; *p; ++p) {
+        if (p[0] == '{' && p[1] == '}' && next < record.num_args) {
+            appendArg(out, record, record.args[next++]);
+            ++p;
+        } else {
+            out << *p;
+        }
+    }
+    if (record.suppressed > 0) {
+        out << " (" << record.suppressed << " similar suppressed)";
+    }
+    return out.str();
+}
+
+LogRecord* Logger::acquire() {
+    LogQueue* queue = current_queue.queue.get();
+    if (!queue) {
+        queue = registerThread();
+    }
+    LogRecord* record = queue->acquire();
+    if (!record) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return record;
+}
+
+void Logger::publish() {
+    current_queue.queue->publish();
+}
+
+LogQueue* Logger::registerThread() {
+    // First record from this thread: the only allocation and lock it pays
+    current_queue.queue = std::make_shared<LogQueue>();
+    std::lock_guard<std::mutex> lock(mutex_);
+    queues_.push_back(current_queue.queue);
+    return current_queue.queue.get();
+}
+
+void Logger::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait_for(lock, DRAIN_INTERVAL, [this]() { return stop_ || flush_requested_; });
+        bool stopping = stop_;
+        flush_requested_ = false;
+        lock.unlock();
+
+        drain();
+
+        lock.lock();
+        ++passes_;
+        drained_.notify_all();
+        if (stopping) {
+            stopped_ = true;
+            drained_.notify_all();
+            return;
+        }
+    }
+}
+
+void Logger::drain() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        active_.assign(queues_.begin(), queues_.end());
+    }
+
+    batch_.clear();
+    bool any_closed = false;
+    for (auto& queue : active_) {
+        // Closed before draining means nothing can follow what we take now
+        bool closed = queue->closed.load(std::memory_order_acquire);
+        queue->drainInto(batch_);
+        any_closed = any_closed || closed;
+    }
+    active_.clear();
+
+    if (any_closed) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queues_.erase(std::remove_if(queues_.begin(), queues_.end(),
+                                     [](const std::shared_ptr<LogQueue>& queue) {
+                                         return queue->closed.load(std::memory_order_acquire) &&
+                                                queue->empty();
+                                     }),
+                      queues_.end());
+    }
+
+    uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (batch_.empty() && dropped == reported_drops_) {
+        return;
+    }
+
+    std::stable_sort(batch_.begin(), batch_.end(), [](const LogRecord& a, const LogRecord& b) {
+        return a.time_ns < b.time_ns;
+    });
+
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    for (const auto& record : batch_) {
+        std::string line = format(record);
+        if (sink_) {
+            sink_(record.site->level, line);
+        } else if (record.site->level >= LogLevel::Warning) {
+            std::cerr << line << '\n';
+        } else {
+            std::cout << line << '\n';
+        }
+    }
+    if (dropped != reported_drops_) {
+        std::string line = "Logger: " + std::to_string(dropped - reported_drops_) +
+                           " records dropped, queue full";
+        reported_drops_ = dropped;
+        if (sink_) {
+            sink_(LogLevel::Warning, line);
+        } else {
+            std::cerr << line << '\n';
+        }
+    }
+    if (!sink_) {
+        std::cout.flush();
+        std::cerr.flush();
+    }
+}
+
+void Logger::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stop_) {
+            return;
+        }
+        stop_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "SampleMetadata.h"
+
+enum class LogLevel : uint8_t {
+    Debug,
+    Info,
+    Warning,
+    Error,
+};
+
+/**
+ * One logging call site, a static created by the LOG_* macros
+ *
+ * Holds the format string and the rate limit state: at most burst records
+ * per WINDOW_NS from this site, the rest are counted and the next record
+ * that gets through reports how many were suppressed.
+ */
+struct LogSite {
+    static constexpr uint32_t DEFAULT_BURST = 10;
+    static constexpr int64_t WINDOW_NS = 1000000000LL;
+
+    constexpr LogSite(const char* format_string, LogLevel log_level)
+        : format(format_string), level(log_level) {}
+
+    const char* format;
+    LogLevel level;
+    std::atomic<int64_t> window_start_ns{0};
+    std::atomic<uint32_t> window_count{0};
+    std::atomic<uint32_t> suppressed{0};
+
+    // Whether a record may be written now (burst 0 = unlimited);
+    // suppressed_out is the count to report
+    bool admit(int64_t now_ns, uint32_t burst, uint32_t& suppressed_out) {
+        if (burst == 0) {
+            suppressed_out = suppressed.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+        int64_t start = window_start_ns.load(std::memory_order_relaxed);
+        if (now_ns - start >= WINDOW_NS &&
+                window_start_ns.compare_exchange_strong(start, now_ns, std::memory_order_relaxed)) {
+            window_count.store(0, std::memory_order_relaxed);
+        }
+        if (window_count.fetch_add(1, std::memory_order_relaxed) >= burst) {
+            suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        suppressed_out = suppressed.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+};
+
+/**
+ * Fixed-size binary log record, formatted later by the logger thread
+ * Numbers are stored as values, strings are copied into text (truncated)
+ */
+struct LogRecord {
+    static constexpr size_t MAX_ARGS = 8;
+    static constexpr size_t TEXT_BYTES = 160;
+
+    struct Arg {
+        enum Type : uint8_t { INT, UINT, DOUBLE, BOOL, CHAR, TEXT } type;
+        uint8_t length;             // TEXT: bytes at text + offset
+        uint8_t offset;
+        union {
+            int64_t i;
+            uint64_t u;
+            double d;
+        };
+    };
+
+    int64_t time_ns;
+    const LogSite* site;
+    uint32_t suppressed;
+    uint8_t num_args;
+    uint8_t text_used;
+    Arg args[MAX_ARGS];
+    char text[TEXT_BYTES];
+
+    template<typename T>
+    void add(const T& value) {
+        if (num_args == MAX_ARGS) {
+            return;
+        }
+        Arg& arg = args[num_args++];
+        if constexpr (std::is_same<T, bool>::value) {
+            arg.type = Arg::BOOL;
+            arg.u = value;
+        } else if constexpr (std::is_same<T, char>::value) {
+            arg.type = Arg::CHAR;
+            arg.i = value;
+        } else if constexpr (std::is_enum<T>::value) {
+            arg.type = Arg::INT;
+            arg.i = static_cast<int64_t>(value);
+        } else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) {
+            arg.type = Arg::INT;
+            arg.i = value;
+        } else if constexpr (std::is_integral<T>::value) {
+            arg.type = Arg::UINT;
+            arg.u = value;
+        } else if constexpr (std::is_floating_point<T>::value) {
+            arg.type = Arg::DOUBLE;
+            arg.d = value;
+        } else if constexpr (std::is_array<T>::value) {
+            addText(arg, value, std::strlen(value));
+        } else if constexpr (std::is_convertible<T, const char*>::value) {
+            addText(arg, value, value ? std::strlen(value) : 0);
+        } else {
+            static_assert(std::is_same<T, std::string>::value,
+                          "LOG_* arguments are numbers, bools, chars and strings");
+            addText(arg, value.data(), value.size());
+        }
+    }
+
+    void addText(Arg& arg, const char* data, size_t size) {
+        size_t room = TEXT_BYTES - text_used;
+        size = std::min(size, room);
+        arg.type = Arg::TEXT;
+        arg.offset = text_used;
+        arg.length = static_cast<uint8_t>(size);
+        if (size > 0) {
+            std::memcpy(text + text_used, data, size);
+        }
+        text_used += static_cast<uint8_t>(size);
+    }
+};
+
+class LogQueue;
+
+/**
+ * Asynchronous logger for threads that must not block on a console
+ *
+ * Each producing thread gets its own lock-free SPSC queue of LogRecords on
+ * first use. A write is a rate-limit check and a record copy: no locks,
+ * allocation, formatting or syscalls. A queue that is full drops the record
+ * and counts it. The osprey-log thread collects the queues every few
+ * milliseconds, orders records by time, formats "{}" placeholders and writes
+ * Info and below to stdout, Warning and Error to stderr.
+ *
+ * Use the LOG_* macros, which supply the call site; the format must be a
+ * string literal.
+ */
+class Logger {
+public:
+    using Sink = std::function<void(LogLevel level, const std::string& line)>;
+
+    // Records a thread can have waiting before it starts dropping
+    static constexpr size_t QUEUE_RECORDS = 256;
+
+    // Process-wide instance, started on first use and flushed at exit
+    static Logger& instance();
+
+    template<typename... Args>
+    void write(LogSite& site, const Args&... args) {
+        if (site.level < min_level_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        int64_t now = monotonicTimeNs();
+        uint32_t suppressed = 0;
+        if (!site.admit(now, burst_.load(std::memory_order_relaxed), suppressed)) {
+            return;
+        }
+        LogRecord* record = acquire();
+        if (!record) {
+            return;
+        }
+        record->time_ns = now;
+        record->site = &site;
+        record->suppressed = suppressed;
+        record->num_args = 0;
+        record->text_used = 0;
+        (record->add(args), ...);
+        publish();
+    }
+
+    void setMinLevel(LogLevel level) { min_level_.store(level); }
+    // Records per second from any one call site, 0 = unlimited
+    void setRateLimit(uint32_t burst) { burst_.store(burst); }
+
+    // Replace the console output, e.g. in tests; nullptr restores it
+    void setSink(Sink sink);
+
+    // Returns once everything written before the call has reached the sink
+    void flush();
+
+    // Records lost to full queues since start
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    // Format a record the way the logger thread does
+    static std::string format(const LogRecord& record);
+
+private:
+    Logger();
+    ~Logger() = delete;         // Lives until exit, threads may log during teardown
+
+    // Calling thread's free slot, nullptr if its queue is full
+    LogRecord* acquire();
+    void publish();
+
+    LogQueue* registerThread();
+
+    void run();
+    void drain();
+    void shutdown();
+
+    std::atomic<LogLevel> min_level_{LogLevel::Debug};
+    std::atomic<uint32_t> burst_{LogSite::DEFAULT_BURST};
+    std::atomic<uint64_t> dropped_{0};
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable drained_;
+    std::vector<std::shared_ptr<LogQueue>> queues_;
+    uint64_t passes_ = 0;
+    bool flush_requested_ = false;
+    bool stop_ = false;
+    bool stopped_ = false;
+    std::thread thread_;
+
+    std::mutex sink_mutex_;
+    Sink sink_;
+
+    // Logger thread only
+    std::vector<std::shared_ptr<LogQueue>> active_;
+    std::vector<LogRecord> batch_;
+    uint64_t reported_drops_ = 0;
+};
+
+#define OSPREY_LOG(level, format, ...) \
+    do { \
+        static LogSite osprey_log_site_(format, level); \
+        Logger::instance().write(osprey_log_site_, ##__VA_ARGS__); \
+    } while (0)
+
+#define LOG_DEBUG(format, ...) OSPREY_LOG(LogLevel::Debug, format, ##__VA_ARGS__)
+#define LOG_INFO(format, ...) OSPREY_LOG(LogLevel::Info, format, ##__VA_ARGS__)
+#define LOG_WARN(format, ...) OSPREY_LOG(LogLevel::Warning, format, ##__VA_ARGS__)
+#define LOG_ERROR(format, ...) OSPREY_LOG(LogLevel::Error, format, ##__VA_ARGS__)
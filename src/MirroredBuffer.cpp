@@ -0,0 +1,114 @@
+#include "MirroredBuffer.h"
+#include <cstdint>
+#include <iostream>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <linux/memfd.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr size_t HUGE_2M = size_t(2) << 20;
+}
+
+MirroredBuffer::MirroredBuffer(size_t bytes, const MemoryPolicy& policy, bool mirror)
+    : size_(bytes)
+    , policy_(policy) {
+    bool want_huge = policy_.page_size != MemoryPolicy::PageSize::Default;
+    if (mirror && want_huge && size_ % HUGE_2M == 0 && mapMirrored(true)) {
+        return;
+    }
+    if (mirror && mapMirrored(false)) {
+        return;
+    }
+    data_ = BufferMemory::allocate(size_, policy_);
+    if (!data_) {
+        throw std::bad_alloc();
+    }
+}
+
+MirroredBuffer::~MirroredBuffer() {
+    if (!data_) return;
+#ifdef __linux__
+    if (mirrored_) {
+        munmap(data_, size_ * 2);
+        return;
+    }
+#endif
+    BufferMemory::deallocate(data_, size_, policy_);
+}
+
+bool MirroredBuffer::mapMirrored(bool hugetlb) {
+#ifdef __linux__
+    size_t page = hugetlb ? HUGE_2M : static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    if (page == 0 || size_ == 0 || size_ % page != 0) {
+        return false;
+    }
+
+    unsigned int fd_flags = MFD_CLOEXEC;
+    if (hugetlb) {
+        fd_flags |= MFD_HUGETLB | MFD_HUGE_2MB;
+    }
+    int fd = memfd_create("osprey-ring", fd_flags);
+    if (fd < 0) {
+        if (!hugetlb) {
+            std::cerr << "MirroredBuffer: memfd_create failed, using flat buffer" << std::endl;
+        }
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+        close(fd);
+        return false;
+    }
+
+    // Reserve twice the address space (plus slack to align it to the page
+    // size), then map the file into both halves
+    size_t span = size_ * 2 + page;
+    void* reserve = mmap(nullptr, span, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (reserve == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+    uintptr_t start = reinterpret_cast<uintptr_t>(reserve);
+    uintptr_t aligned = (start + page - 1) / page * page;
+    if (aligned > start) {
+        munmap(reserve, aligned - start);
+    }
+    size_t tail = (start + span) - (aligned + size_ * 2);
+    if (tail > 0) {
+        munmap(reinterpret_cast<void*>(aligned + size_ * 2), tail);
+    }
+
+    char* lower = reinterpret_cast<char*>(aligned);
+    void* first = mmap(lower, size_, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_FIXED, fd, 0);
+    void* second = mmap(lower + size_, size_, PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_FIXED, fd, 0);
+    close(fd);	// Mappings keep the memory alive
+
+    if (first != lower || second != lower + size_) {
+        // Without reserved huge pages this is the expected outcome
+        if (!hugetlb) {
+            std::cerr << "MirroredBuffer: double mapping failed, using flat buffer" << std::endl;
+        }
+        munmap(lower, size_ * 2);
+        return false;
+    }
+
+    // hugetlb pages need no advice, only placement
+    MemoryPolicy placement = policy_;
+    if (hugetlb) {
+        placement.page_size = MemoryPolicy::PageSize::Default;
+    }
+    BufferMemory::applyPolicy(lower, size_ * 2, placement);
+
+    data_ = lower;
+    mirrored_ = true;
+    hugetlb_ = hugetlb;
+    return true;
+#else
+    (void)hugetlb;
+    return false;
+#endif
+}
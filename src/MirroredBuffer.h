@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include "BufferMemory.h"
+
+/**
+ * Raw ring storage mapped twice back to back in virtual memory
+ *
+ * With the mirror, byte i and byte i + size() are the same physical memory,
+ * so any window of up to size() bytes starting anywhere in the first copy is
+ * one contiguous pointer and ring readers never have to unwrap. Uses a memfd
+ * mapped twice on Linux; if that fails (or size() is not a whole number of
+ * pages) it falls back to a plain allocation and isMirrored() is false, in
+ * which case callers must handle the wrap themselves.
+ *
+ * The memory policy picks huge pages (hugetlb memfd when size() is a multiple
+ * of 2M, otherwise shmem THP advice) and the NUMA node for both cases.
+ */
+class MirroredBuffer {
+public:
+    // mirror = false goes straight to the flat allocation
+    explicit MirroredBuffer(size_t bytes, const MemoryPolicy& policy = MemoryPolicy(),
+                            bool mirror = true);
+    ~MirroredBuffer();
+
+    MirroredBuffer(const MirroredBuffer&) = delete;
+    MirroredBuffer& operator=(const MirroredBuffer&) = delete;
+
+    void* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool isMirrored() const { return mirrored_; }
+    bool isHugetlb() const { return hugetlb_; }
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    MemoryPolicy policy_;
+    bool mirrored_ = false;
+    bool hugetlb_ = false;
+
+    bool mapMirrored(bool hugetlb);
+};
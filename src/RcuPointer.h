@@ -0,0 +1,178 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * Read-copy-update pointer to processing state that is replaced while in use
+ *
+ * The writer builds a new T off to the side and Publish()es it with one
+ * atomic exchange; the old T is retired, not deleted. Readers open a short
+ * read section per block of work, Read(), and keep using whatever version
+ * they got until the section ends, so a swap lands at the next block
+ * boundary of every reader and nobody ever waits for it. Reclaim() deletes
+ * retired versions once no reader section that could hold them is still
+ * open; it never blocks, versions still in use are simply kept for the next
+ * call.
+ *
+ * Readers are epoch based: opening a section records the current epoch in
+ * the reader's own slot, Publish() advances the epoch, and a version
+ * retired at epoch E is free once every open section started at E or
+ * later. A read section costs two loads and a store, no locks or
+ * refcounts.
+ *
+ * One writer thread (Publish, Reclaim, Current); up to MAX_READERS Reader
+ * handles, each used by one thread at a time.
+ */
+template<typename T>
+class RcuPointer {
+	static constexpr uint64_t IDLE = 0;
+
+	struct alignas(64) Slot {
+		std::atomic<uint64_t> epoch{IDLE};		// Epoch the open section started in
+		std::atomic<bool> taken{false};
+	};
+
+public:
+	static constexpr size_t MAX_READERS = 8;
+
+	explicit RcuPointer(std::unique_ptr<T> initial = nullptr)
+		: current_(initial.release()) {
+	}
+
+	// No Reader may be open any more
+	~RcuPointer() {
+		delete current_.load(std::memory_order_acquire);
+	}
+
+	RcuPointer(const RcuPointer&) = delete;
+	RcuPointer& operator=(const RcuPointer&) = delete;
+
+	/**
+	 * Open read section; the version it points to stays valid until the
+	 * guard goes away
+	 */
+	class ReadGuard {
+	public:
+		ReadGuard(ReadGuard&& other) noexcept
+			: value_(other.value_), slot_(other.slot_) {
+			other.slot_ = nullptr;
+		}
+		ReadGuard(const ReadGuard&) = delete;
+		ReadGuard& operator=(const ReadGuard&) = delete;
+		ReadGuard& operator=(ReadGuard&&) = delete;
+
+		~ReadGuard() {
+			if (slot_) {
+				slot_->epoch.store(IDLE, std::memory_order_release);
+			}
+		}
+
+		T* get() const { return value_; }
+		T* operator->() const { return value_; }
+		T& operator*() const { return *value_; }
+		explicit operator bool() const { return value_ != nullptr; }
+
+	private:
+		friend class RcuPointer;
+		ReadGuard(T* value, Slot* slot) : value_(value), slot_(slot) {}
+
+		T* value_;
+		Slot* slot_;
+	};
+
+	/**
+	 * A thread's registration as reader; throws if all slots are taken
+	 */
+	class Reader {
+	public:
+		explicit Reader(RcuPointer& rcu)
+			: rcu_(rcu), slot_(rcu.TakeSlot()) {
+		}
+		~Reader() {
+			slot_->taken.store(false, std::memory_order_release);
+		}
+
+		Reader(const Reader&) = delete;
+		Reader& operator=(const Reader&) = delete;
+
+		// Not nested: one open section per Reader
+		ReadGuard Read() {
+			// All seq_cst: a writer that sees this slot idle published before
+			// the pointer load below, so that load can't return what it frees
+			uint64_t epoch = rcu_.epoch_.load(std::memory_order_seq_cst);
+			slot_->epoch.store(epoch, std::memory_order_seq_cst);
+			return ReadGuard(rcu_.current_.load(std::memory_order_seq_cst), slot_);
+		}
+
+	private:
+		RcuPointer& rcu_;
+		Slot* slot_;
+	};
+
+	/*********************************WRITER***********************************/
+
+	// Newest version, for the writer's own use
+	T* Current() const {
+		return current_.load(std::memory_order_relaxed);
+	}
+
+	// Swap in next; the previous version is retired until Reclaim() frees it
+	void Publish(std::unique_ptr<T> next) {
+		T* previous = current_.exchange(next.release(), std::memory_order_seq_cst);
+		uint64_t retired_at = epoch_.fetch_add(1, std::memory_order_seq_cst) + 1;
+		if (previous) {
+			retired_.emplace_back(retired_at, std::unique_ptr<T>(previous));
+		}
+	}
+
+	// Free retired versions no open section can hold, returns how many remain
+	size_t Reclaim() {
+		if (retired_.empty()) {
+			return 0;
+		}
+		uint64_t oldest = UINT64_MAX;
+		for (auto& slot : slots_) {
+			uint64_t epoch = slot.epoch.load(std::memory_order_seq_cst);
+			if (epoch != IDLE && epoch < oldest) {
+				oldest = epoch;
+			}
+		}
+		size_t kept = 0;
+		for (auto& entry : retired_) {
+			if (entry.first > oldest) {
+				retired_[kept++] = std::move(entry);
+			}
+		}
+		retired_.resize(kept);
+		return kept;
+	}
+
+	size_t Retired() const { return retired_.size(); }
+
+	// Publishes so far
+	uint64_t Version() const {
+		return epoch_.load(std::memory_order_relaxed) - 1;
+	}
+
+private:
+	Slot* TakeSlot() {
+		for (auto& slot : slots_) {
+			bool expected = false;
+			if (slot.taken.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+				return &slot;
+			}
+		}
+		throw std::runtime_error("RcuPointer: no free reader slot");
+	}
+
+	std::atomic<T*> current_;
+	std::atomic<uint64_t> epoch_{1};
+	Slot slots_[MAX_READERS];
+	std::vector<std::pair<uint64_t, std::unique_ptr<T>>> retired_;	// Writer only
+};
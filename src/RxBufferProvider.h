@@ -0,0 +1,35 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+
+#include "SampleMetadata.h"
+
+/**
+ * Consumer-owned memory the device receives straight into
+ *
+ * Instead of recv() into a device buffer and a callback copying it into the
+ * app's ring, the device asks the consumer for a writable span, receives into
+ * it, and commits only the samples it actually got. Both calls come from the
+ * device RX thread. A span that is never committed (timeout, overflow) is
+ * simply reused by the next acquire().
+ */
+class RxBufferProvider {
+public:
+    struct Span {
+        std::complex<float>* data = nullptr;
+        size_t size = 0;
+    };
+
+    virtual ~RxBufferProvider() = default;
+
+    /**
+     * Writable space for up to max_samples, may be smaller
+     * @return Empty span if the consumer has no room; the device then
+     *         drops that block and flags a discontinuity
+     */
+    virtual Span acquire(size_t max_samples) = 0;
+
+    // Publish the first count samples of the last acquired span
+    virtual void commit(size_t count, const SampleMetadata& metadata) = 0;
+};
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <complex>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "RxBufferProvider.h"
+#include "SampleMetadata.h"
+
+/**
+ * Pull side of device reception
+ *
+ * The device RX thread receives straight into this ring through the
+ * RxBufferProvider interface and one consumer thread read()s samples out,
+ * so batch tools and benchmarks need no callback thread of their own.
+ * Samples and per-block metadata sit in two lock-free SPSC rings; commit()
+ * only takes a lock when the reader is asleep in read().
+ *
+ * A full ring is never overwritten: the device gets no room, drops that
+ * block and flags the next one DISCONTINUITY, so what was read stays
+ * exactly what was received.
+ */
+class RxStream : public RxBufferProvider {
+public:
+    struct ReadResult {
+        size_t count = 0;               // Samples written to dest
+        SampleMetadata metadata;        // sample_index is dest[0]'s; times are its block's
+        size_t block_offset = 0;        // dest[0]'s position in that block
+        bool end_of_stream = false;     // Closed and drained, nothing more will come
+    };
+
+    // Block boundaries a read stops at, so these flags always describe dest[0]
+    static constexpr uint32_t BREAK_FLAGS = SampleMetadata::DISCONTINUITY |
+                                            SampleMetadata::DEVICE_OVERFLOW |
+                                            SampleMetadata::RETUNED;
+
+    /**
+     * @param capacity Samples, rounded up to a power of two
+     * @param max_blocks Committed blocks the ring can track at once
+     */
+    explicit RxStream(size_t capacity = 1 << 20, size_t max_blocks = 4096)
+        : samples_(roundUpPow2(capacity))
+        , blocks_(roundUpPow2(max_blocks))
+        , capacity_(samples_.size()) {
+    }
+
+    RxStream(const RxStream&) = delete;
+    RxStream& operator=(const RxStream&) = delete;
+
+    /*******************************DEVICE THREAD******************************/
+
+    Span acquire(size_t max_samples) override {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t used = head - tail_.load(std::memory_order_acquire);
+        size_t blocks = block_head_.load(std::memory_order_relaxed) -
+                        block_tail_.load(std::memory_order_acquire);
+        Span span;
+        if (used == capacity_ || blocks == blocks_.size()) {
+            dropped_blocks_.fetch_add(1, std::memory_order_relaxed);
+            return span;
+        }
+        size_t idx = head & (capacity_ - 1);
+        span.data = samples_.data() + idx;
+        span.size = std::min({max_samples, capacity_ - used, capacity_ - idx});
+        return span;
+    }
+
+    void commit(size_t count, const SampleMetadata& metadata) override {
+        if (count == 0) {
+            return;
+        }
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t block = block_head_.load(std::memory_order_relaxed);
+        blocks_[block & (blocks_.size() - 1)] = {head, metadata};
+        block_head_.store(block + 1, std::memory_order_release);
+        // seq_cst pairs with the reader raising sleeping_ before its last check
+        head_.store(head + count, std::memory_order_seq_cst);
+        if (sleeping_.load()) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            wake_.notify_one();
+        }
+    }
+
+    /******************************CONSUMER THREAD*****************************/
+
+    /**
+     * Copy up to count samples into dest, waiting up to timeout for the
+     * first one. Returns whatever is there rather than waiting for count;
+     * stops short of a block with BREAK_FLAGS, so the samples of one read
+     * are always contiguous in the stream.
+     */
+    ReadResult read(std::complex<float>* dest, size_t count, std::chrono::microseconds timeout) {
+        ReadResult result;
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t head = head_.load(std::memory_order_acquire);
+        if (head == tail) {
+            head = waitForSamples(tail, timeout);
+            if (head == tail) {
+                result.end_of_stream = closed_.load();
+                return result;
+            }
+        }
+        if (count == 0) {
+            return result;
+        }
+
+        // Metadata of every block up to head is in place before head moved
+        size_t block_head = block_head_.load(std::memory_order_acquire);
+        size_t block_tail = block_tail_.load(std::memory_order_relaxed);
+        const size_t block_mask = blocks_.size() - 1;
+        while (block_tail != block_head && blocks_[block_tail & block_mask].position <= tail) {
+            current_ = blocks_[block_tail & block_mask];
+            ++block_tail;
+        }
+        result.block_offset = tail - current_.position;
+        result.metadata = current_.metadata;
+        result.metadata.sample_index += result.block_offset;
+        if (result.block_offset > 0) {
+            result.metadata.flags &= ~BREAK_FLAGS;     // Reported with the block's first sample
+        }
+
+        size_t n = std::min(count, head - tail);
+        for (size_t b = block_tail; b != block_head; ++b) {
+            const Block& next = blocks_[b & block_mask];
+            if (next.position >= tail + n) {
+                break;
+            }
+            if (next.metadata.flags & BREAK_FLAGS) {
+                n = next.position - tail;
+                break;
+            }
+        }
+
+        size_t idx = tail & (capacity_ - 1);
+        size_t first = std::min(n, capacity_ - idx);
+        std::memcpy(dest, samples_.data() + idx, first * sizeof(std::complex<float>));
+        std::memcpy(dest + first, samples_.data(), (n - first) * sizeof(std::complex<float>));
+        tail_.store(tail + n, std::memory_order_release);
+        result.count = n;
+
+        // Hand back the entries of blocks started in this read right away,
+        // small blocks would otherwise fill the table before the samples
+        while (block_tail != block_head && blocks_[block_tail & block_mask].position < tail + n) {
+            current_ = blocks_[block_tail & block_mask];
+            ++block_tail;
+        }
+        block_tail_.store(block_tail, std::memory_order_release);
+        return result;
+    }
+
+    /**********************************CONTROL*********************************/
+
+    // No more commits will come; wakes a waiting read()
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_.store(true);
+        wake_.notify_all();
+    }
+
+    // Empty and open again; no device may be receiving into it
+    void reset() {
+        head_.store(0);
+        tail_.store(0);
+        block_head_.store(0);
+        block_tail_.store(0);
+        dropped_blocks_.store(0);
+        current_ = Block();
+        closed_.store(false);
+    }
+
+    size_t available() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+    size_t capacity() const { return capacity_; }
+    bool isClosed() const { return closed_.load(); }
+
+    // acquire() calls that found the ring full, i.e. blocks the device dropped
+    uint64_t droppedBlocks() const { return dropped_blocks_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t CACHE_LINE = 64;
+
+    struct Block {
+        size_t position = 0;        // Ring write count at its first sample
+        SampleMetadata metadata;
+    };
+
+    static size_t roundUpPow2(size_t n) {
+        size_t p = 1;
+        while (p < n) { p <<= 1; }
+        return p;
+    }
+
+    // Returns head once it moved past tail, or on timeout/close
+    size_t waitForSamples(size_t tail, std::chrono::microseconds timeout) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        sleeping_.store(true);
+        wake_.wait_for(lock, timeout, [&]() {
+            return head_.load() != tail || closed_.load();
+        });
+        sleeping_.store(false);
+        return head_.load(std::memory_order_acquire);
+    }
+
+    std::vector<std::complex<float>> samples_;
+    std::vector<Block> blocks_;
+    size_t capacity_;
+
+    // Device thread owned
+    alignas(CACHE_LINE) std::atomic<size_t> head_{0};
+    std::atomic<size_t> block_head_{0};
+    std::atomic<uint64_t> dropped_blocks_{0};
+
+    // Reader owned
+    alignas(CACHE_LINE) std::atomic<size_t> tail_{0};
+    std::atomic<size_t> block_tail_{0};
+    Block current_;                 // Block holding the sample at tail
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::atomic<bool> sleeping_{false};
+    std::atomic<bool> closed_{false};
+};
@@ -7,6 +7,18 @@
 #include <atomic>
 #include <iostream>
 #include <vector>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+
+#include "SampleBlockPool.h"
+#include "SampleMetadata.h"
+#include "RxBufferProvider.h"
+#include "RxStream.h"
+#include "Telemetry.h"
+#include "ThreadTuning.h"
+#include "Window.h"
+#include "Logger.h"
 
 struct SDRConfig;
 struct SDRCapabilities;
@@ -18,7 +30,9 @@ struct SDRStatus;
  */
 class SDRDevice {
 public:
-    using SampleCallback = std::function<void(const std::complex<float>*, size_t)>;
+    using SampleCallback = std::function<void(const std::complex<float>*, size_t,
+                                              const SampleMetadata&)>;
+    using BlockCallback = std::function<void(const SampleBlockRef&)>;
     
     // Constructor/Destructor
     SDRDevice() = default;
@@ -33,6 +47,121 @@ public:
     virtual bool startReceiving(SampleCallback callback, size_t buffer_size = 4096) = 0;
     virtual void stopReceiving() = 0;
     virtual bool isReceiving() const = 0;
+
+    /**
+     * Zero-copy RX: samples arrive in pooled, refcounted blocks that
+     * consumers may keep after the callback returns. Devices that can't
+     * fill blocks directly fall back to one copy into the pool.
+     * @param num_blocks Pool size; blocks held downstream are unavailable
+     */
+    virtual bool startReceivingBlocks(BlockCallback callback, size_t buffer_size = 4096,
+                                      size_t num_blocks = 64) {
+        if (!prepareBlockPool(num_blocks, buffer_size)) {
+            return false;
+        }
+        SampleBlockPool* pool = block_pool_.get();
+        fallback_pending_flags_ = 0;
+        return startReceiving([this, pool, callback](const std::complex<float>* samples, size_t count,
+                                                     const SampleMetadata& metadata) {
+            SampleBlockRef block = pool->acquire();
+            if (!block) {
+                dropFallbackBlock();     // Every block still held downstream
+                return;
+            }
+            block->size = std::min(count, block->capacity);
+            block->metadata = metadata;
+            block->metadata.flags |= takeFallbackFlags();
+            std::memcpy(block->data, samples, block->size * sizeof(std::complex<float>));
+            callback(block);
+        }, buffer_size);
+    }
+
+    /**
+     * Receive straight into consumer memory, e.g. a ring's reserved span,
+     * and commit only what arrived. Devices without native support copy
+     * once from their own buffer into the provider's spans instead.
+     * @param provider Must outlive the reception
+     */
+    virtual bool startReceivingInto(RxBufferProvider* provider, size_t buffer_size = 4096) {
+        if (!provider) {
+            setError("No RX buffer provider");
+            return false;
+        }
+        fallback_pending_flags_ = 0;
+        return startReceiving([this, provider](const std::complex<float>* samples, size_t count,
+                                               const SampleMetadata& metadata) {
+            // A span may end early (ring wrap), keep going until all is placed
+            SampleMetadata part = metadata;
+            part.flags |= takeFallbackFlags();
+            size_t placed = 0;
+            while (placed < count) {
+                RxBufferProvider::Span span = provider->acquire(count - placed);
+                if (!span.data || span.size == 0) {
+                    dropFallbackBlock();     // Consumer has no room for the rest
+                    return;
+                }
+                size_t n = std::min(span.size, count - placed);
+                std::memcpy(span.data, samples + placed, n * sizeof(std::complex<float>));
+                provider->commit(n, part);
+                placed += n;
+                part.sample_index = metadata.sample_index + placed;
+                part.flags = 0;     // Continuation of the same block
+            }
+        }, buffer_size);
+    }
+
+    /**
+     * Pull RX: the device receives into an internal lock-free ring and the
+     * caller read()s it on its own thread, no callback hop. Devices receive
+     * into the ring the same way they do with startReceivingInto().
+     * @param ring_samples Ring size; once the reader is this far behind the
+     *        device drops blocks and the next read is flagged DISCONTINUITY
+     */
+    bool startStreaming(size_t buffer_size = 4096, size_t ring_samples = 1 << 20) {
+        if (isReceiving()) {
+            setError("Already receiving");
+            return false;
+        }
+        if (rx_stream_ && rx_stream_->capacity() >= ring_samples) {
+            rx_stream_->reset();
+        } else {
+            try {
+                rx_stream_ = std::make_unique<RxStream>(ring_samples);
+            } catch (const std::exception& e) {
+                setError("Failed to allocate RX stream: " + std::string(e.what()));
+                return false;
+            }
+        }
+        return startReceivingInto(rx_stream_.get(), buffer_size);
+    }
+
+    // Stop reception; read() reports end of stream once the ring is drained
+    void stopStreaming() {
+        stopReceiving();
+        if (rx_stream_) {
+            rx_stream_->close();
+        }
+    }
+
+    /**
+     * Copy up to count samples into dest, waiting up to timeout for the
+     * first; one reader thread at a time. See RxStream::read()
+     */
+    RxStream::ReadResult read(std::complex<float>* dest, size_t count,
+                              std::chrono::microseconds timeout = std::chrono::milliseconds(100)) {
+        if (!rx_stream_) {
+            RxStream::ReadResult result;
+            result.end_of_stream = true;
+            return result;
+        }
+        return rx_stream_->read(dest, count, timeout);
+    }
+
+    // Ring behind read(), nullptr until startStreaming()
+    const RxStream* getRxStream() const { return rx_stream_.get(); }
+
+    // Pool backing the block RX path, nullptr until startReceivingBlocks()
+    const SampleBlockPool* getBlockPool() const { return block_pool_.get(); }
     
     // Params
     virtual bool setFrequency(double freq_hz, size_t channel = 0) = 0;
@@ -56,6 +185,12 @@ public:
     
     // Statistics
     virtual SDRStatus getStatus() const = 0;
+
+    /**
+     * Consistent snapshot of tuning and RX counters, no locks or allocation
+     * Cheap enough to call every GUI frame from any thread
+     */
+    DeviceTelemetry getTelemetry() const { return telemetry_.Load(); }
     virtual size_t getTotalSamplesReceived() const = 0;
     virtual size_t getOverflowCount() const = 0;
     
@@ -65,10 +200,99 @@ public:
     
 protected:
     mutable std::string last_error_;
+    std::unique_ptr<SampleBlockPool> block_pool_;
+    std::unique_ptr<RxStream> rx_stream_;
+    Seqlock<DeviceTelemetry> telemetry_;
+    std::atomic<bool> retune_pending_{false};
+    // Copying fallbacks above: blocks dropped for lack of room, added to the
+    // overflow telemetry, and the flags owed to the next block delivered
+    std::atomic<size_t> fallback_drops_{0};
+    uint32_t fallback_pending_flags_ = 0;      // RX thread only
+
+    void dropFallbackBlock() {
+        fallback_pending_flags_ |= SampleMetadata::DISCONTINUITY | SampleMetadata::DEVICE_OVERFLOW;
+        fallback_drops_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint32_t takeFallbackFlags() {
+        uint32_t flags = fallback_pending_flags_;
+        fallback_pending_flags_ = 0;
+        return flags;
+    }
+
+    // Telemetry producers, called by the implementations
+    void publishTuning(double frequency, double sample_rate, double gain, double bandwidth) {
+        telemetry_.Update([&](DeviceTelemetry& t) {
+            t.frequency = frequency;
+            t.sample_rate = sample_rate;
+            t.gain = gain;
+            t.bandwidth = bandwidth;
+        });
+        retune_pending_.store(true, std::memory_order_release);
+    }
+
+    // RX thread, per block: RETUNED for the first block after publishTuning()
+    uint32_t takeRetuneFlag() {
+        if (!retune_pending_.load(std::memory_order_relaxed)) {
+            return 0;
+        }
+        return retune_pending_.exchange(false, std::memory_order_acq_rel) ? static_cast<uint32_t>(SampleMetadata::RETUNED) : 0u;
+    }
+
+    void publishState(bool initialized, bool receiving) {
+        int64_t now = monotonicTimeNs();
+        telemetry_.Update([&](DeviceTelemetry& t) {
+            if (receiving && !t.receiving) {
+                retune_pending_.store(false, std::memory_order_relaxed);
+                fallback_drops_.store(0, std::memory_order_relaxed);
+                t.samples_received = 0;
+                t.blocks_received = 0;
+                t.overflows = 0;
+                t.start_ns = now;
+            }
+            t.initialized = initialized;
+            t.receiving = receiving;
+        });
+    }
+
+    // RX thread, once per delivered block
+    void publishRxBlock(size_t count, size_t overflows, int64_t host_time_ns) {
+        telemetry_.Update([&](DeviceTelemetry& t) {
+            if (count > 0) {
+                t.samples_received += count;
+                t.blocks_received++;
+            }
+            t.overflows = overflows + fallback_drops_.load(std::memory_order_relaxed);
+            t.last_block_ns = host_time_ns;
+        });
+    }
+
+    // Status built from the telemetry snapshot, device_specific_status left empty
+    SDRStatus statusFromTelemetry() const;
+
+    // (Re)allocate the block pool; kept across restarts if the shape matches
+    bool prepareBlockPool(size_t num_blocks, size_t block_samples) {
+        if (block_pool_ && block_pool_->numBlocks() == num_blocks &&
+                block_pool_->blockSamples() == block_samples) {
+            return true;
+        }
+        if (block_pool_ && block_pool_->freeBlocks() != block_pool_->numBlocks()) {
+            setError("Sample blocks still held, cannot resize pool");
+            return false;
+        }
+        try {
+            block_pool_ = std::make_unique<SampleBlockPool>(num_blocks, block_samples);
+            return true;
+        } catch (const std::exception& e) {
+            setError("Failed to allocate sample block pool: " + std::string(e.what()));
+            return false;
+        }
+    }
+
     void setError(const std::string& error) const {
         last_error_ = error;
         if (!error.empty()) {
-			std::cerr << "ERROR: " << error << std::endl;
+			LOG_ERROR("ERROR: {}", error);
         }
     }
 };
@@ -95,6 +319,18 @@ struct SDRConfig {
     // Performance tuning
     size_t buffer_size = 4096;
     size_t num_buffers = 64;
+    size_t dsp_workers = 1;		// Spectral work off the RX thread; 0 = analyzer inline in the RX callback
+    int stft_interval_ms = 500;	// Time between RFML spectrogram images, computed off the render thread
+    size_t stft_threads = 0;	// Pool the STFT splits its frames across; 0/1 = serial
+    int fft_size = 0;			// Analyzer FFT size; 0 = largest that fits the budget at this rate
+    bool budget_governor = true;	// Trade display quality for staying real-time under load
+    WindowType window = WindowType::Blackman;	// Analyzer window
+
+    // Thread placement and scheduling
+    ThreadPolicy rx_thread;			// Device RX / generator thread
+    ThreadPolicy dsp_threads;		// DSP workers and the STFT pool
+    ThreadPolicy gui_thread;		// Render loop
+    bool uhd_thread_priority = false;	// uhd::set_thread_priority_safe() on the USRP RX thread
 };
 
 /**
@@ -144,3 +380,19 @@ struct SDRStatus {
     // status
     std::string device_specific_status;
 };
+
+inline SDRStatus SDRDevice::statusFromTelemetry() const {
+    DeviceTelemetry t = telemetry_.Load();
+    SDRStatus status;
+    status.initialized = t.initialized;
+    status.receiving = t.receiving;
+    status.current_frequency = t.frequency;
+    status.current_sample_rate = t.sample_rate;
+    status.current_gain = t.gain;
+    status.current_bandwidth = t.bandwidth;
+    status.samples_received = t.samples_received;
+    status.overflow_count = t.overflows;
+    status.has_overflow = t.overflows > 0;
+    status.reception_rate = t.receptionRate(monotonicTimeNs());
+    return status;
+}
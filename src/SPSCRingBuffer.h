@@ -0,0 +1,233 @@
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <cstring>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+
+/**
+ * Lock-free single producer / single consumer ring buffer
+ *
+ * Drop-in replacement for CircularBuffer on the IQ path. Capacity is rounded
+ * up to a power of two so indexing is a mask instead of a modulo, and indices
+ * are free running counters published with acquire/release ordering.
+ *
+ * The producer never blocks: when the ring is full the oldest samples are
+ * overwritten (same as CircularBuffer). Readers copy in at most two memcpy
+ * chunks and re-validate against the producer's reservation afterwards, so a
+ * read that raced an overwrite is retried instead of returning torn data.
+ * Slots inside an open reservation are not readable, so size the ring for the
+ * largest read window plus one producer block.
+ */
+template<typename T>
+class SPSCRingBuffer {
+	static_assert(std::is_trivially_copyable<T>::value,
+			"SPSCRingBuffer requires trivially copyable elements");
+
+public:
+	// Contiguous region of the ring
+	struct Span {
+		T* data = nullptr;
+		size_t size = 0;
+	};
+
+	// A reservation wraps at most once, so it is at most two spans
+	struct Spans {
+		Span first;
+		Span second;
+		size_t Size() const { return first.size + second.size; }
+	};
+
+private:
+	static constexpr size_t CACHE_LINE = 64;
+
+	std::vector<T> data_;
+	size_t capacity_;	// Power of two
+	size_t mask_;
+
+	// Producer owned: committed write count and reserved (in flight) count
+	alignas(CACHE_LINE) std::atomic<size_t> head_{0};
+	std::atomic<size_t> reserved_{0};
+
+	// Consumer owned: read count and samples lost to overwrite
+	alignas(CACHE_LINE) std::atomic<size_t> tail_{0};
+	std::atomic<size_t> overruns_{0};
+
+	static size_t RoundUpPow2(size_t n) {
+		size_t p = 1;
+		while (p < n) { p <<= 1; }
+		return p;
+	}
+
+	// Copy [start, start + count) out of the ring, at most two chunks
+	void CopyOut(size_t start, T* dest, size_t count) const {
+		size_t idx = start & mask_;
+		size_t first = std::min(count, capacity_ - idx);
+		std::memcpy(dest, data_.data() + idx, first * sizeof(T));
+		if (count > first) {
+			std::memcpy(dest + first, data_.data(), (count - first) * sizeof(T));
+		}
+	}
+
+	// Oldest element the producer has not reserved for overwriting yet
+	size_t OldestValid() const {
+		size_t reserved = reserved_.load(std::memory_order_acquire);
+		return reserved > capacity_ ? reserved - capacity_ : 0;
+	}
+
+	// True if [start, ...) has not been handed back to the producer since
+	// the copy started; must be called after the copy
+	bool StillValid(size_t start) const {
+		std::atomic_thread_fence(std::memory_order_acquire);
+		return reserved_.load(std::memory_order_relaxed) - start <= capacity_;
+	}
+
+public:
+	explicit SPSCRingBuffer(size_t capacity)
+		: data_(RoundUpPow2(std::max<size_t>(capacity, 1)))
+		, capacity_(data_.size())
+		, mask_(data_.size() - 1) {
+	}
+
+	SPSCRingBuffer(const SPSCRingBuffer&) = delete;
+	SPSCRingBuffer& operator=(const SPSCRingBuffer&) = delete;
+
+	/********************************PRODUCER**********************************/
+
+	// Reserve up to count writable elements (clamped to capacity). The spans
+	// stay private to the producer until Commit()
+	Spans Reserve(size_t count) {
+		count = std::min(count, capacity_);
+		size_t head = head_.load(std::memory_order_relaxed);
+		// Never shrinks: slots claimed by an earlier, partially committed
+		// reservation may already have been overwritten
+		size_t reserved = std::max(reserved_.load(std::memory_order_relaxed), head + count);
+		reserved_.store(reserved, std::memory_order_relaxed);
+		// Readers that observe any write below must also observe reserved_
+		std::atomic_thread_fence(std::memory_order_release);
+
+		size_t idx = head & mask_;
+		size_t first = std::min(count, capacity_ - idx);
+		Spans spans;
+		spans.first = {data_.data() + idx, first};
+		if (count > first) {
+			spans.second = {data_.data(), count - first};
+		}
+		return spans;
+	}
+
+	// Publish count elements of the last reservation
+	void Commit(size_t count) {
+		size_t head = head_.load(std::memory_order_relaxed);
+		count = std::min(count, reserved_.load(std::memory_order_relaxed) - head);
+		head_.store(head + count, std::memory_order_release);
+	}
+
+	// Bulk push
+	void PushBulk(const T* items, size_t count) {
+		// Only the newest capacity_ elements can survive anyway
+		if (count > capacity_) {
+			items += count - capacity_;
+			count = capacity_;
+		}
+		Spans spans = Reserve(count);
+		std::memcpy(spans.first.data, items, spans.first.size * sizeof(T));
+		if (spans.second.size) {
+			std::memcpy(spans.second.data, items + spans.first.size,
+					spans.second.size * sizeof(T));
+		}
+		Commit(count);
+	}
+
+	// Push an element to the buffer
+	void Push(const T& item) {
+		PushBulk(&item, 1);
+	}
+
+	/********************************CONSUMER**********************************/
+
+	// Pop an element off the buffer
+	bool Pop(T& item) {
+		return Read(&item, 1) == 1;
+	}
+
+	// Consume up to count of the oldest retained elements, returns number read
+	size_t Read(T* dest, size_t count) {
+		while (true) {
+			size_t head = head_.load(std::memory_order_acquire);
+			size_t tail = tail_.load(std::memory_order_relaxed);
+			size_t oldest = OldestValid();
+			if (oldest > tail) {
+				// reserved_ may be newer than head: count only what is skipped
+				// now, the rest is counted once head catches up
+				size_t skip_to = std::min(oldest, head);
+				overruns_.fetch_add(skip_to - tail, std::memory_order_relaxed);
+				tail = skip_to;
+				tail_.store(tail, std::memory_order_relaxed);
+			}
+			size_t n = std::min(count, head - tail);
+			CopyOut(tail, dest, n);
+			if (StillValid(tail)) {
+				tail_.store(tail + n, std::memory_order_release);
+				return n;
+			}
+		}
+	}
+
+	// Non-consuming copy of the newest count elements, zero padded when fewer
+	// are buffered. Same result as CircularBuffer once the buffer is full
+	void CopyLatest(T* dest, size_t count) const {
+		size_t copy_count = 0;
+		while (true) {
+			size_t head = head_.load(std::memory_order_acquire);
+			size_t tail = tail_.load(std::memory_order_relaxed);
+			size_t available = head - std::min(head, std::max(tail, OldestValid()));
+			copy_count = std::min(count, available);
+			size_t start = head - copy_count;
+			CopyOut(start, dest, copy_count);
+			if (StillValid(start)) { break; }
+		}
+		std::fill(dest + copy_count, dest + count, T{});
+	}
+
+	// Drop everything currently buffered (consumer side)
+	void clear() {
+		tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+	}
+
+	/*********************************STATE************************************/
+
+	// Get the current size of the buffer
+	size_t Size() const {
+		size_t head = head_.load(std::memory_order_acquire);
+		size_t tail = tail_.load(std::memory_order_acquire);
+		return head - std::min(head, std::max(tail, OldestValid()));
+	}
+
+	// Get the maximum number of allowable items in the buffer
+	size_t Capacity() const {
+		return capacity_;
+	}
+
+	// Check if buffer is empty
+	bool IsEmpty() const {
+		return Size() == 0;
+	}
+
+	// Is buffer currently full
+	bool IsFull() const {
+		return Size() == capacity_;
+	}
+
+	// Total number of elements ever committed
+	size_t TotalWritten() const {
+		return head_.load(std::memory_order_acquire);
+	}
+
+	// Elements overwritten before the consumer read them
+	size_t Overruns() const {
+		return overruns_.load(std::memory_order_relaxed);
+	}
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <complex>
+#include <utility>
+#include <vector>
+#include <pffft.h>
+#include "BufferMemory.h"
+#include "FFTPlanCache.h"
+#include "SpectrumKernels.h"
+
+/**
+ * STFTSpectrogram as it was before the batched passes, frame by frame:
+ * window into a staging buffer, transform out of place, scalar power,
+ * fftShift, scattered column store, then a dB pass over the whole image.
+ * Kept only as the reference the batched code is checked against bit for bit
+ * (TestWorkStealingPool) and timed against (bench_stft); serial, no pool.
+ */
+class PerFrameSTFT {
+public:
+    PerFrameSTFT(int fft_size, int fft_stride)
+        : fft_size_(fft_size)
+        , fft_stride_(fft_stride)
+        , plan_(FFTPlanCache::instance().plan(fft_size, FFTMode::Complex))
+        , window_(fft_size)
+        , fft_input_(2 * fft_size)
+        , fft_output_(2 * fft_size)
+        , power_(fft_size) {
+        // Same Blackman table as STFTSpectrogram::generateBlackmanWindow()
+        for (int n = 0; n < fft_size_; ++n) {
+            window_[n] = 0.42f
+                       - 0.5f * std::cos(2.0f * M_PI * n / (fft_size_ - 1))
+                       + 0.08f * std::cos(4.0f * M_PI * n / (fft_size_ - 1));
+        }
+    }
+
+    // freq_bins x time_frames dB into out; returns time_frames
+    int compute(const std::complex<float>* iq, size_t num_samples, float* out) {
+        const int frames = num_samples < static_cast<size_t>(fft_size_)
+                         ? 1 : static_cast<int>((num_samples - fft_size_) / fft_stride_) + 1;
+        float* work = FFTPlanCache::scratch(plan_->workFloats());
+        float max_power = 0.0f;
+
+        for (int frame = 0; frame < frames; ++frame) {
+            size_t offset = static_cast<size_t>(frame) * fft_stride_;
+            for (int n = 0; n < fft_size_; ++n) {
+                size_t i = offset + n;
+                fft_input_[2 * n] = i < num_samples ? iq[i].real() * window_[n] : 0.0f;
+                fft_input_[2 * n + 1] = i < num_samples ? iq[i].imag() * window_[n] : 0.0f;
+            }
+            pffft_transform_ordered(plan_->setup(), fft_input_.data(), fft_output_.data(), work,
+                                    PFFFT_FORWARD);
+            for (int k = 0; k < fft_size_; ++k) {
+                float re = fft_output_[2 * k];
+                float im = fft_output_[2 * k + 1];
+                power_[k] = re * re + im * im;
+                max_power = std::max(max_power, power_[k]);
+            }
+            fftShift();
+            for (int k = 0; k < fft_size_; ++k) {
+                out[static_cast<size_t>(fft_size_ - 1 - k) * frames + frame] = power_[k];
+            }
+        }
+
+        DbScale db;
+        db.min_power = max_power * std::sqrt(1e-20f);
+        db.floor_db = -FLT_MAX;
+        spectrumKernels().decibels(out, out, static_cast<size_t>(fft_size_) * frames, db);
+        return frames;
+    }
+
+private:
+    using AlignedBuffer = std::vector<float, BufferAllocator<float>>;
+
+    int fft_size_;
+    int fft_stride_;
+    std::shared_ptr<const FFTPlan> plan_;
+    std::vector<float> window_;
+    AlignedBuffer fft_input_;
+    AlignedBuffer fft_output_;
+    std::vector<float> power_;
+
+    void fftShift() {
+        int half = fft_size_ / 2;
+        for (int i = 0; i < half; ++i) {
+            std::swap(power_[i], power_[i + half]);
+        }
+        if (fft_size_ % 2 == 1) {
+            float last = power_[fft_size_ - 1];
+            for (int i = fft_size_ - 1; i > half; --i) {
+                power_[i] = power_[i - 1];
+            }
+            power_[half] = last;
+        }
+    }
+};
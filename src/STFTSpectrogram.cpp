@@ -1,5 +1,9 @@
 #include "STFTSpectrogram.h"
+#include "WorkStealingPool.h"
+#include "Logger.h"
+#include "SpectrumKernels.h"
 #include <pffft.h>
+#include <cfloat>
 #include <iostream>
 #include <cmath>
 #include <algorithm>
@@ -8,8 +12,7 @@
 STFTSpectrogram::STFTSpectrogram(int fft_size, int fft_stride, float sample_rate)
     : fft_size_(fft_size)
     , fft_stride_(fft_stride)
-    , sample_rate_(sample_rate)
-    , setup_(nullptr) {
+    , sample_rate_(sample_rate) {
     
     // Validate parameters
     if (fft_stride <= 0 || fft_stride > fft_size) {
@@ -31,13 +34,10 @@ STFTSpectrogram::~STFTSpectrogram() {
 
 bool STFTSpectrogram::initialize() {
     try {
-        // Initialize PFFFT for complex-to-complex transforms
-        setup_ = pffft_new_setup(fft_size_, PFFFT_COMPLEX);
-        if (!setup_) {
-            std::cerr << "Failed to create PFFFT setup for complex FFT, size=" << fft_size_ << std::endl;
-            return false;
-        }
-        work_buffer_.resize(fft_size_ * 2);
+        // PFFFT setup for complex-to-complex transforms, shared
+        plan_ = FFTPlanCache::instance().plan(fft_size_, FFTMode::Complex);
+        scratch_.resize(1);
+        setThreadPool(nullptr);
         generateBlackmanWindow();
         return true;
     } catch (const std::exception& e) {
@@ -47,12 +47,21 @@ bool STFTSpectrogram::initialize() {
 }
 
 void STFTSpectrogram::cleanup() {
-    if (setup_) {
-        pffft_destroy_setup(setup_);
-        setup_ = nullptr;
+    plan_.reset();
+}
+
+void STFTSpectrogram::setThreadPool(WorkStealingPool* pool) {
+    pool_ = pool;
+    scratch_.resize(pool ? pool->numWorkers() : std::max<size_t>(scratch_.size(), 1));
+    for (auto& scratch : scratch_) {
+        scratch.rows.resize(FRAME_GRAIN * rowStride());
     }
 }
 
+void STFTSpectrogram::setFFTStride(int fft_stride) {
+    fft_stride_ = std::clamp(fft_stride, 1, fft_size_);
+}
+
 void STFTSpectrogram::generateBlackmanWindow() {
     window_function_.resize(fft_size_);
     
@@ -80,8 +89,8 @@ bool STFTSpectrogram::computeSpectrogram(const std::complex<float>* iq_samples,
 		size_t num_samples, float** output_spectrogram,
 		int* output_freq_bins, int* output_time_frames) {
     
-    if (!setup_ || !iq_samples || !output_spectrogram || !output_freq_bins || !output_time_frames) {
-        std::cerr << "Invalid parameters for computeSpectrogram" << std::endl;
+    if (!plan_ || !iq_samples || !output_spectrogram || !output_freq_bins || !output_time_frames) {
+        LOG_ERROR("Invalid parameters for computeSpectrogram");
         return false;
     }
     
@@ -92,108 +101,99 @@ bool STFTSpectrogram::computeSpectrogram(const std::complex<float>* iq_samples,
     *output_freq_bins = freq_bins;
     *output_time_frames = num_frames;
     
-    std::vector<float> fft_input(fft_size_ * 2);
-    std::vector<float> fft_output(fft_size_ * 2);
-    
-    // Process each frame
-    for (int frame = 0; frame < num_frames; ++frame) {
-        int sample_offset = frame * fft_stride_;
-        
-        // Apply windowing to current frame
-        applyWindow(iq_samples, fft_input.data(), sample_offset, num_samples);
-        
-        // Perform FFT
-        pffft_transform_ordered(setup_, 
-                               fft_input.data(), 
-                               fft_output.data(), 
-                               work_buffer_.data(), 
-                               PFFFT_FORWARD);
-        
-        // Compute power spectrum and apply FFT shift
-        std::vector<float> power_spectrum(freq_bins);
-        for (int k = 0; k < freq_bins; ++k) {
-            float real = fft_output[2*k];
-            float imag = fft_output[2*k + 1];
-            power_spectrum[k] = real * real + imag * imag;
-        }
-        
-        // Apply FFT shift to center DC component
-        fftShift(power_spectrum.data(), freq_bins);
-        
-        // Store in output array (freq_bins x time_frames layout)
-        for (int k = 0; k < freq_bins; ++k) {
-            (*output_spectrogram)[k * num_frames + frame] = power_spectrum[k];
-        }
+    float* spectrogram_data = *output_spectrogram;
+    const size_t spectra_floats = static_cast<size_t>(num_frames) * 2 * fft_size_;
+    if (spectra_.size() < spectra_floats) {
+        spectra_.resize(spectra_floats);
     }
     
-    // Convert to decibels and reverse frequency bins
-    convertToDecibels(*output_spectrogram, freq_bins * num_frames);
-    reverseFrequencyBins(*output_spectrogram, freq_bins, num_frames);
-    
-    return true;
-}
-
-void STFTSpectrogram::applyWindow(const std::complex<float>* input, 
-		float* windowed_output, int offset, size_t input_size) {
+    for (auto& scratch : scratch_) {
+        scratch.max_power = 0.0f;
+    }
     
-    for (int n = 0; n < fft_size_; ++n) {
-        int sample_idx = offset + n;
-        
-        if (sample_idx >= 0 && sample_idx < static_cast<int>(input_size)) {
-            // Apply window function
-            float window_val = window_function_[n];
-            windowed_output[2*n]     = input[sample_idx].real() * window_val; // Real part
-            windowed_output[2*n + 1] = input[sample_idx].imag() * window_val; // Imag part
-        } else {
-            // Zero padding
-            windowed_output[2*n]     = 0.0f;
-            windowed_output[2*n + 1] = 0.0f;
-        }
+    // Frames are independent and each writes only its own spectrum and
+    // output columns, so the split changes nothing but which thread computes it
+    if (pool_) {
+        pool_->parallelFor(num_frames, FRAME_GRAIN, [&](size_t begin, size_t end, size_t worker) {
+            transformFrames(iq_samples, num_samples, begin, end, scratch_[worker]);
+        });
+    } else {
+        transformFrames(iq_samples, num_samples, 0, num_frames, scratch_[0]);
     }
-}
-
-void STFTSpectrogram::fftShift(float* data, int size) {
-    int half_size = size / 2;
     
-    for (int i = 0; i < half_size; ++i) {
-        std::swap(data[i], data[i + half_size]);
+    // dB relative to the global peak; max is exact in any order
+    float max_val = 0.0f;
+    for (const auto& scratch : scratch_) {
+        max_val = std::max(max_val, scratch.max_power);
     }
+    float epsilon = max_val * std::sqrt(1e-20f);
     
-    if (size % 2 == 1) {
-        float temp = data[size - 1];
-        for (int i = size - 1; i > half_size; --i) {
-            data[i] = data[i - 1];
-        }
-        data[half_size] = temp;
+    if (pool_) {
+        pool_->parallelFor(num_frames, FRAME_GRAIN, [&](size_t begin, size_t end, size_t worker) {
+            storeDecibels(spectrogram_data, num_frames, epsilon, begin, end, scratch_[worker]);
+        });
+    } else {
+        storeDecibels(spectrogram_data, num_frames, epsilon, 0, num_frames, scratch_[0]);
     }
+    
+    return true;
 }
 
-void STFTSpectrogram::reverseFrequencyBins(float* spectrogram_data, 
-		int freq_bins, int time_frames) {
-    
-    for (int frame = 0; frame < time_frames; ++frame) {
-        for (int k = 0; k < freq_bins / 2; ++k) {
-            int top_idx = k * time_frames + frame;
-            int bottom_idx = (freq_bins - 1 - k) * time_frames + frame;
-            std::swap(spectrogram_data[top_idx], spectrogram_data[bottom_idx]);
-        }
+void STFTSpectrogram::transformFrames(const std::complex<float>* iq_samples, size_t num_samples,
+		size_t first_frame, size_t end_frame, FrameScratch& scratch) {
+    
+    const SpectrumKernels& kernels = spectrumKernels();
+    float* work_buffer = FFTPlanCache::scratch(plan_->workFloats());
+    
+    for (size_t frame = first_frame; frame < end_frame; ++frame) {
+        size_t sample_offset = frame * fft_stride_;
+        size_t available = std::min<size_t>(fft_size_, num_samples - sample_offset);
+        float* spectrum = spectra_.data() + frame * 2 * fft_size_;
+        
+        // Window straight into the frame's slot, zero padded past the input
+        kernels.windowComplex(reinterpret_cast<const float*>(iq_samples + sample_offset),
+                              window_function_.data(), spectrum, available);
+        std::fill(spectrum + 2 * available, spectrum + 2 * fft_size_, 0.0f);
+        
+        // Transform in place
+        pffft_transform_ordered(plan_->setup(), spectrum, spectrum, work_buffer, PFFFT_FORWARD);
+        scratch.max_power = std::max(scratch.max_power, kernels.peakPower(spectrum, fft_size_));
     }
 }
 
-void STFTSpectrogram::convertToDecibels(float* spectrogram_data, int total_elements) {
-    float max_val = 0.0f;
-    for (int i = 0; i < total_elements; ++i) {
-        max_val = std::max(max_val, std::abs(spectrogram_data[i]));
-    }
+void STFTSpectrogram::storeDecibels(float* spectrogram_data, int num_frames, float epsilon,
+		size_t first_frame, size_t end_frame, FrameScratch& scratch) {
     
-    float epsilon = max_val * std::sqrt(1e-20f);
+    const SpectrumKernels& kernels = spectrumKernels();
+    const int freq_bins = fft_size_;
+    const int upper = (fft_size_ + 1) / 2;     // FFT bin that lands at index 0 after the shift
+    const size_t stride = rowStride();
+    
+    // Clamped at epsilon (at least FLT_MIN), no floor
+    DbScale db;
+    db.min_power = epsilon;
+    db.floor_db = -FLT_MAX;
     
-    for (int i = 0; i < total_elements; ++i) {
-        float val = spectrogram_data[i];
-        if (val <= 0.0f) {
-            val = epsilon;
+    for (size_t first = first_frame; first < end_frame; first += FRAME_GRAIN) {
+        size_t count = std::min(FRAME_GRAIN, end_frame - first);
+        
+        // dB of each frame in fftshifted order: negative frequencies first
+        for (size_t j = 0; j < count; ++j) {
+            const float* spectrum = spectra_.data() + (first + j) * 2 * fft_size_;
+            float* row = scratch.rows.data() + j * stride;
+            kernels.powerDecibels(spectrum + 2 * upper, row, freq_bins - upper, 1.0f, db);
+            kernels.powerDecibels(spectrum, row + (freq_bins - upper), upper, 1.0f, db);
+        }
+        
+        // Transposed into (freq_bins x time_frames), frequency reversed so
+        // the highest bin is the top row; count contiguous floats per row
+        for (int r = 0; r < freq_bins; ++r) {
+            const float* src = scratch.rows.data() + (freq_bins - 1 - r);
+            float* dst = spectrogram_data + static_cast<size_t>(r) * num_frames + first;
+            for (size_t j = 0; j < count; ++j) {
+                dst[j] = src[j * stride];
+            }
         }
-        spectrogram_data[i] = 10.0f * std::log10(val);
     }
 }
 
@@ -3,13 +3,32 @@
 #include <vector>
 #include <complex>
 #include <memory>
+#include "BufferMemory.h"
+#include "FFTPlanCache.h"
 
-// Forward declare PFFFT types
-typedef struct PFFFT_Setup PFFFT_Setup;
+class WorkStealingPool;
+
+/**
+ * Finished spectrogram with its axes, the unit handed to the display
+ */
+struct STFTImage {
+    std::vector<float, BufferAllocator<float>> data;    // freq_bins x time_frames, dB
+    std::vector<float> freq_axis;
+    std::vector<float> time_axis;
+    int freq_bins = 0;
+    int time_frames = 0;
+};
 
 /**
  * STFT-based spectrogram processor that matches the Python implementation
  * Uses overlapping windows and traditional spectrogram computation
+ *
+ * Two passes over the tile, both split across the pool when there is one:
+ * window and transform every frame in place into one batch of spectra,
+ * noting the peak power; then a fused power -> dB pass that reads the
+ * spectra with the fftshift and the frequency reversal folded into its
+ * indexing and writes each output row a cache line at a time. All buffers
+ * persist between calls.
  */
 class STFTSpectrogram {
 public:
@@ -55,6 +74,16 @@ public:
      */
     void generateTimeArray(float* time_array, int num_frames) const;
     
+    /**
+     * Split frames across a pool, or nullptr to compute on the calling thread.
+     * Output is bit-identical either way. Not while computeSpectrogram runs;
+     * the pool must outlive its use here
+     */
+    void setThreadPool(WorkStealingPool* pool);
+
+    // Change the hop between frames (overlap); not while computeSpectrogram runs
+    void setFFTStride(int fft_stride);
+    
     // Getters
     int getFFTSize() const { return fft_size_; }
     int getFFTStride() const { return fft_stride_; }
@@ -66,18 +95,36 @@ private:
     int fft_stride_;
     float sample_rate_;
     
-    // PFFFT setup for complex-to-complex transforms
-    PFFFT_Setup* setup_;
-    std::vector<float> work_buffer_;      // Required by PFFFT, pre-allocated once
+    using AlignedBuffer = std::vector<float, BufferAllocator<float>>;  // 64 byte aligned
+
+    // Per-worker buffers so frames can run in parallel; PFFFT's work buffer
+    // is the worker thread's FFTPlanCache scratch
+    struct FrameScratch {
+        AlignedBuffer rows;     // FRAME_GRAIN frames of dB, fftshifted, ROW_STRIDE apart
+        float max_power = 0.0f;
+    };
+    
+    // Complex-to-complex plan from FFTPlanCache, read-only and shared
+    std::shared_ptr<const FFTPlan> plan_;
     std::vector<float> window_function_;  // Blackman window coefficients, computed once
+    std::vector<FrameScratch> scratch_;   // One per pool worker, [0] when serial
+    AlignedBuffer spectra_;               // Every frame's spectrum, grown to the largest tile
+    WorkStealingPool* pool_ = nullptr;
+    
+    // Frames per pool chunk: 16 floats per output row, one cache line per chunk
+    static constexpr size_t FRAME_GRAIN = 16;
+    // Padding between scratch rows, so the 16 reads of one output row don't
+    // all land in one cache set when fft_size is a multiple of 1024
+    static constexpr size_t ROW_PAD = 16;
+    size_t rowStride() const { return fft_size_ + ROW_PAD; }
     
     // Helper functions
     bool initialize();
     void cleanup();
     void generateBlackmanWindow();
-    void applyWindow(const std::complex<float>* input, float* windowed_output, int offset, size_t input_size);
-    void fftShift(float* data, int size);
-    void reverseFrequencyBins(float* spectrogram_data, int freq_bins, int time_frames);
+    void transformFrames(const std::complex<float>* iq_samples, size_t num_samples,
+                         size_t first_frame, size_t end_frame, FrameScratch& scratch);
+    void storeDecibels(float* spectrogram_data, int num_frames, float epsilon,
+                       size_t first_frame, size_t end_frame, FrameScratch& scratch);
     int calculateNumFrames(size_t num_samples) const;
-    void convertToDecibels(float* spectrogram_data, int total_elements);
 };
@@ -0,0 +1,79 @@
+#include "SampleBlockPool.h"
+#include <new>
+#include <stdexcept>
+#include <string>
+
+namespace {
+constexpr size_t BLOCK_ALIGNMENT = 64;
+
+uint64_t pack(uint32_t index, uint32_t tag) {
+    return (static_cast<uint64_t>(tag) << 32) | index;
+}
+uint32_t indexOf(uint64_t head) { return static_cast<uint32_t>(head); }
+uint32_t tagOf(uint64_t head) { return static_cast<uint32_t>(head >> 32); }
+}
+
+SampleBlockPool::SampleBlockPool(size_t num_blocks, size_t block_samples)
+    : free_head_(pack(EMPTY, 0))
+    , free_count_(0)
+    , num_blocks_(num_blocks)
+    , block_samples_(block_samples) {
+
+    if (num_blocks == 0 || num_blocks >= EMPTY || block_samples == 0) {
+        throw std::invalid_argument("Invalid sample block pool size: " +
+                std::to_string(num_blocks) + " x " + std::to_string(block_samples));
+    }
+
+    // Round each block up to a cache line so every block starts aligned
+    size_t block_bytes = block_samples * sizeof(std::complex<float>);
+    size_t stride = (block_bytes + BLOCK_ALIGNMENT - 1) / BLOCK_ALIGNMENT * BLOCK_ALIGNMENT;
+    storage_ = ::operator new(stride * num_blocks, std::align_val_t(BLOCK_ALIGNMENT));
+
+    blocks_ = std::make_unique<SampleBlock[]>(num_blocks);
+    next_ = std::make_unique<std::atomic<uint32_t>[]>(num_blocks);
+
+    char* base = static_cast<char*>(storage_);
+    for (size_t i = 0; i < num_blocks; ++i) {
+        SampleBlock& block = blocks_[i];
+        block.data = reinterpret_cast<std::complex<float>*>(base + i * stride);
+        block.capacity = block_samples;
+        block.index_ = static_cast<uint32_t>(i);
+        block.pool_ = this;
+        release(&block);
+    }
+}
+
+SampleBlockPool::~SampleBlockPool() {
+    ::operator delete(storage_, std::align_val_t(BLOCK_ALIGNMENT));
+}
+
+SampleBlockRef SampleBlockPool::acquire() {
+    uint64_t head = free_head_.load(std::memory_order_acquire);
+    while (true) {
+        uint32_t index = indexOf(head);
+        if (index == EMPTY) {
+            exhausted_.fetch_add(1, std::memory_order_relaxed);
+            return SampleBlockRef();
+        }
+        uint32_t next = next_[index].load(std::memory_order_relaxed);
+        // Tag bump makes a concurrent pop/push of the same slot fail the CAS
+        if (free_head_.compare_exchange_weak(head, pack(next, tagOf(head) + 1),
+                    std::memory_order_acq_rel, std::memory_order_acquire)) {
+            free_count_.fetch_sub(1, std::memory_order_relaxed);
+            SampleBlock* block = &blocks_[index];
+            block->size = 0;
+            block->metadata = SampleMetadata();
+            block->refs_.store(1, std::memory_order_relaxed);
+            return SampleBlockRef(block);
+        }
+    }
+}
+
+void SampleBlockPool::release(SampleBlock* block) {
+    uint64_t head = free_head_.load(std::memory_order_relaxed);
+    do {
+        next_[block->index_].store(indexOf(head), std::memory_order_relaxed);
+    } while (!free_head_.compare_exchange_weak(head, pack(block->index_, tagOf(head) + 1),
+                std::memory_order_release, std::memory_order_relaxed));
+    free_count_.fetch_add(1, std::memory_order_relaxed);
+}
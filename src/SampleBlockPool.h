@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "SampleMetadata.h"
+
+class SampleBlockPool;
+
+/**
+ * Fixed-capacity block of IQ samples owned by a SampleBlockPool
+ * Reference counted intrusively; go through SampleBlockRef, never delete
+ */
+struct SampleBlock {
+    std::complex<float>* data = nullptr;   // 64 byte aligned
+    size_t capacity = 0;                    // Samples the block can hold
+    size_t size = 0;                        // Valid samples
+    SampleMetadata metadata;                // Stream position and capture time
+
+private:
+    friend class SampleBlockPool;
+    friend class SampleBlockRef;
+
+    std::atomic<uint32_t> refs_{0};
+    uint32_t index_ = 0;                    // Slot in the pool
+    SampleBlockPool* pool_ = nullptr;
+};
+
+/**
+ * Shared handle to a pooled SampleBlock
+ * Copying bumps the refcount, the block returns to its pool when the last
+ * handle goes away. Cheap enough to pass by value between pipeline stages.
+ */
+class SampleBlockRef {
+public:
+    SampleBlockRef() = default;
+    ~SampleBlockRef() { reset(); }
+
+    SampleBlockRef(const SampleBlockRef& other) : block_(other.block_) {
+        if (block_) block_->refs_.fetch_add(1, std::memory_order_relaxed);
+    }
+    SampleBlockRef(SampleBlockRef&& other) noexcept : block_(other.block_) {
+        other.block_ = nullptr;
+    }
+    SampleBlockRef& operator=(SampleBlockRef other) noexcept {
+        std::swap(block_, other.block_);
+        return *this;
+    }
+
+    void reset();
+
+    SampleBlock* get() const { return block_; }
+    SampleBlock* operator->() const { return block_; }
+    SampleBlock& operator*() const { return *block_; }
+    explicit operator bool() const { return block_ != nullptr; }
+
+    const std::complex<float>* data() const { return block_->data; }
+    size_t size() const { return block_->size; }
+
+    // Holders sharing this block, for diagnostics
+    uint32_t useCount() const {
+        return block_ ? block_->refs_.load(std::memory_order_relaxed) : 0;
+    }
+
+private:
+    friend class SampleBlockPool;
+    explicit SampleBlockRef(SampleBlock* block) : block_(block) {}
+
+    SampleBlock* block_ = nullptr;
+};
+
+/**
+ * Pool of equally sized, aligned sample blocks
+ * All memory is allocated up front; acquire/release is a lock-free stack so
+ * device threads and consumers on any thread can hand blocks back and forth
+ * without allocating. The pool must outlive every block handed out.
+ */
+class SampleBlockPool {
+public:
+    SampleBlockPool(size_t num_blocks, size_t block_samples);
+    ~SampleBlockPool();
+
+    SampleBlockPool(const SampleBlockPool&) = delete;
+    SampleBlockPool& operator=(const SampleBlockPool&) = delete;
+
+    /**
+     * Take a free block with size and metadata reset
+     * @return Empty handle if every block is still held downstream
+     */
+    SampleBlockRef acquire();
+
+    size_t blockSamples() const { return block_samples_; }
+    size_t numBlocks() const { return num_blocks_; }
+    size_t freeBlocks() const { return free_count_.load(std::memory_order_relaxed); }
+
+    // Times acquire() found the pool empty
+    size_t exhaustedCount() const { return exhausted_.load(std::memory_order_relaxed); }
+
+private:
+    friend class SampleBlockRef;
+    void release(SampleBlock* block);
+
+    // Free list head: low 32 bits slot index (or EMPTY), high 32 bits ABA tag
+    static constexpr uint32_t EMPTY = 0xFFFFFFFFu;
+    std::atomic<uint64_t> free_head_;
+    std::atomic<size_t> free_count_;
+    std::atomic<size_t> exhausted_{0};
+
+    size_t num_blocks_;
+    size_t block_samples_;
+    std::unique_ptr<SampleBlock[]> blocks_;
+    std::unique_ptr<std::atomic<uint32_t>[]> next_;    // Free list links, by slot
+    void* storage_ = nullptr;               // Backing sample memory
+};
+
+inline void SampleBlockRef::reset() {
+    if (block_ && block_->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        block_->pool_->release(block_);
+    }
+    block_ = nullptr;
+}
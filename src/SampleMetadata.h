@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <time.h>
+
+/**
+ * Where a block of samples sits in the stream and when it was captured
+ * Filled in by the device RX thread and handed to every downstream stage
+ * so latency, view alignment and gaps can be measured instead of guessed.
+ */
+struct SampleMetadata {
+    enum Flags : uint32_t {
+        HAS_DEVICE_TIME = 1u << 0,  // device_time is valid
+        DISCONTINUITY   = 1u << 1,  // Samples were lost right before this block
+        DEVICE_OVERFLOW = 1u << 2,  // Device reported an overflow before this block
+        RETUNED         = 1u << 3,  // First block after a tuning change (frequency, rate, gain, bandwidth)
+    };
+
+    uint64_t sample_index = 0;      // Stream index of the first sample, counts lost samples too
+    double device_time = 0.0;       // Device clock at the first sample, seconds
+    int64_t host_time_ns = 0;       // CLOCK_MONOTONIC when the block was captured
+    uint32_t flags = 0;
+
+    bool hasFlag(Flags flag) const { return (flags & flag) != 0; }
+};
+
+// CLOCK_MONOTONIC in nanoseconds, the host timebase for SampleMetadata
+inline int64_t monotonicTimeNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Sequence lock around a small, trivially copyable snapshot struct
+ *
+ * Writers bump the sequence to odd, update the value and bump it back to even;
+ * readers copy the value and retry if the sequence was odd or changed under
+ * them. Readers never block writers, never allocate and never see a torn
+ * value. Writers are serialized against each other by the sequence itself, so
+ * e.g. an RX thread and a GUI setter may both Update() the same block; that
+ * path spins, which is fine as long as writes stay rare and short.
+ *
+ * The value lives in relaxed atomic words rather than a plain T, so the
+ * racing reader copy is well defined (and quiet under ThreadSanitizer).
+ */
+template<typename T>
+class Seqlock {
+	static_assert(std::is_trivially_copyable<T>::value,
+				  "Seqlock values are copied word by word");
+
+public:
+	Seqlock() { Store(T()); }
+	explicit Seqlock(const T& initial) { Store(initial); }
+
+	Seqlock(const Seqlock&) = delete;
+	Seqlock& operator=(const Seqlock&) = delete;
+
+	/*********************************WRITER***********************************/
+
+	void Store(const T& value) {
+		uint64_t seq = BeginWrite();
+		WriteWords(value);
+		seq_.store(seq + 2, std::memory_order_release);
+	}
+
+	// Read-modify-write in one critical section: fn(T&) edits the current value
+	template<typename Fn>
+	void Update(Fn&& fn) {
+		uint64_t seq = BeginWrite();
+		T value;
+		ReadWords(value);
+		fn(value);
+		WriteWords(value);
+		seq_.store(seq + 2, std::memory_order_release);
+	}
+
+	/*********************************READER***********************************/
+
+	// Consistent copy of the latest value
+	T Load() const {
+		T value;
+		for (;;) {
+			uint64_t before = seq_.load(std::memory_order_acquire);
+			if (before & 1) {
+				continue;	// Writer in progress
+			}
+			ReadWords(value);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (seq_.load(std::memory_order_relaxed) == before) {
+				return value;
+			}
+		}
+	}
+
+	// Completed writes so far, lets a reader skip work if nothing changed
+	uint64_t Version() const {
+		return seq_.load(std::memory_order_acquire) >> 1;
+	}
+
+private:
+	static constexpr size_t WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+	alignas(64) std::atomic<uint64_t> seq_{0};
+	std::atomic<uint64_t> words_[WORDS];
+
+	uint64_t BeginWrite() {
+		uint64_t seq = seq_.load(std::memory_order_relaxed);
+		for (;;) {
+			if (!(seq & 1) &&
+				seq_.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire,
+										   std::memory_order_relaxed)) {
+				break;
+			}
+			seq = seq_.load(std::memory_order_relaxed);
+		}
+		// Odd sequence must be visible before any of the new words
+		std::atomic_thread_fence(std::memory_order_release);
+		return seq;
+	}
+
+	void ReadWords(T& value) const {
+		uint64_t raw[WORDS];
+		for (size_t i = 0; i < WORDS; ++i) {
+			raw[i] = words_[i].load(std::memory_order_relaxed);
+		}
+		std::memcpy(&value, raw, sizeof(T));
+	}
+
+	void WriteWords(const T& value) {
+		uint64_t raw[WORDS] = {};
+		std::memcpy(raw, &value, sizeof(T));
+		for (size_t i = 0; i < WORDS; ++i) {
+			words_[i].store(raw[i], std::memory_order_relaxed);
+		}
+	}
+};
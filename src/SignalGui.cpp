@@ -1,6 +1,7 @@
 #include "SignalGui.h"
 #include "SDRFactory.h"
 #include "FFTProcessor.h"
+#include "Logger.h"
 #include <glad/glad.h>
 #include <iostream>
 #include <cmath>
@@ -8,16 +9,56 @@
 #include <iomanip>
 #include <chrono>
 
+namespace {
+
+// One analyzer frame at this size: FFT, dB and PSD
+int64_t MeasureFrameCost(int fft_size) {
+    FFTProcessor fft(fft_size, FFTMode::Complex);
+    std::vector<float> input(2 * fft_size), output(2 * fft_size);
+    std::vector<float> magnitude(fft_size), psd(fft_size);
+    for (int i = 0; i < 2 * fft_size; ++i) {
+        input[i] = float(rand()) / RAND_MAX - 0.5f;
+    }
+
+    // Best of a few batches, the first one warms the caches
+    const int batches = 4;
+    const int frames = 8;
+    int64_t best = INT64_MAX;
+    for (int batch = 0; batch < batches; ++batch) {
+        int64_t start = monotonicTimeNs();
+        for (int frame = 0; frame < frames; ++frame) {
+            fft.forwardFFT(input.data(), output.data());
+            fft.complexToRealDB(magnitude.data(), output.data(), magnitude.size());
+            fft.complexToPSD(psd.data(), output.data(), psd.size(), 1.0f, false);
+        }
+        best = std::min(best, (monotonicTimeNs() - start) / frames);
+    }
+    return best;
+}
+
+// Largest analyzer FFT, up to the default, that fits the budget at this rate
+int CalibrateFFTSize(float sample_rate, int max_size, double budget) {
+    std::vector<int> candidates;
+    for (int size = 1024; size <= max_size; size *= 2) {
+        candidates.push_back(size);
+    }
+    int picked = BudgetGovernor::pickFFTSize(sample_rate, candidates, budget, MeasureFrameCost);
+    LOG_INFO("Budget governor: analyzer FFT size {} for {} MS/s", picked, sample_rate / 1e6);
+    return picked;
+}
+
+}
+
 SignalGui::SignalGui()
-    : time_buffer_(N_SAMPLES)
-    , signal_buffer_(N_SAMPLES)
-	, fft_size_(8192)
-	, num_freq_bins_(fft_size_ / 2 + 1)
-    , freq_buffer_(num_freq_bins_)
-    , magnitude_buffer_(num_freq_bins_)
-    , psd_buffer_(num_freq_bins_)
-    , stft_sample_buffer_(STFT_BUFFER_SIZE)
-    , current_time_(0.0f)
+    : iq_ring_(IQ_RING_SIZE, MemoryPolicy::largeBuffer())
+    , time_reader_(iq_ring_.MakeReader())
+    , stft_reader_(iq_ring_.MakeReader())
+    , analyzer_reader_(iq_ring_.MakeReader())
+	, fft_size_(DEFAULT_FFT_SIZE)
+	, requested_fft_size_(DEFAULT_FFT_SIZE)
+	, chosen_fft_size_(DEFAULT_FFT_SIZE)
+	, num_freq_bins_(fft_size_)	// Two-sided IQ spectrum
+    , current_time_(0.0)
     , sample_rate_(1000.0f)
 	, last_sample_rate_(-1.0)
 	, last_center_freq_(-1.0)
@@ -25,17 +66,10 @@ SignalGui::SignalGui()
 	, new_time_data_available_(false)
 	, new_freq_data_available_(false)
     , spectrogram_row_(0)
-    , update_counter_(0)
-    , samples_received_(0)
-    , overflow_count_(0) {
+    , spectrogram_data(BufferAllocator<float>(MemoryPolicy::largeBuffer()))
+    , update_counter_(0) {
 
-	freq_data.resize(num_freq_bins_);
-	magnitude_data.resize(num_freq_bins_);
-	psd_data.resize(num_freq_bins_);
-
-	real_samples_buffer.reserve(8192*2);
-    
-	spectrogram_data.resize(N_TIME_BINS * num_freq_bins_, -80.0f);
+	SetFFTSize(fft_size_);
 	rel_time_array.resize(N_SAMPLES);
 	updateRelTimeArray();
 
@@ -46,16 +80,22 @@ SignalGui::SignalGui()
 	last_freq_update_time_ = now;
 	last_waterfall_update_time_ = now;
 	last_stft_update_time_ = now;
+	last_governor_time_ = now;
 }
 
 SignalGui::~SignalGui() {
+    device_commands_.reset();
     if (sdr_device_ && sdr_device_->isReceiving()) {
         sdr_device_->stopReceiving();
     }
+    StopDspWorkers();
 }
 
 bool SignalGui::Initialize(const SDRConfig& config) {
     device_config_ = config;
+    SetSTFTInterval(config.stft_interval_ms);
+    device_commands_.reset();
+    pending_settings_.clear();
     
     // Create and initialize the SDR device
     sdr_device_ = SDRFactory::createAndInitialize(config);
@@ -65,10 +105,34 @@ bool SignalGui::Initialize(const SDRConfig& config) {
         return false;
     }
     
+    device_commands_ = std::make_unique<DeviceCommandQueue>(*sdr_device_);
+    device_commands_->start();
+    
     // Update sample rate from device
     sample_rate_ = static_cast<float>(sdr_device_->getSampleRate());
     
-    spectrogram_analyzer_ = std::make_unique<SpectrogramAnalyzer>(fft_size_, sample_rate_);
+    // Without a fixed size, the largest FFT the analyzer can keep up with here
+    int fft_size = config.fft_size;
+    if (fft_size <= 0) {
+        fft_size = config.budget_governor
+            ? CalibrateFFTSize(sample_rate_, DEFAULT_FFT_SIZE, ANALYZER_BUDGET)
+            : DEFAULT_FFT_SIZE;
+    }
+    SetFFTSize(fft_size);
+    requested_fft_size_ = fft_size;
+    chosen_fft_size_ = fft_size;
+    window_type_ = config.window;
+    spectrogram_analyzer_.Publish(std::make_unique<SpectrogramAnalyzer>(fft_size_, sample_rate_,
+                                                                         FFTMode::Complex, window_type_));
+    spectrogram_analyzer_.Reclaim();
+    ApplyBudgetLevel();
+
+    // Plans for the other sizes, so switching later needs no PFFFT setup
+    std::vector<int> sizes;
+    for (int size = MIN_FFT_SIZE; size <= MAX_FFT_SIZE; size *= 2) {
+        sizes.push_back(size);
+    }
+    plan_prewarm_ = FFTPlanCache::instance().prewarm(sizes, FFTMode::Complex, window_type_);
 
 	// Initialize STFT
 	initializeSTFTProcessor();
@@ -88,65 +152,329 @@ bool SignalGui::StartReceiving() {
         return false;
     }
     
-    // Reset counters
-    samples_received_.store(0);
-    overflow_count_.store(0);
+    // Reset counters, the device resets its own telemetry on start
+    discontinuity_count_.store(0);
+    current_time_.store(0.0);
+    rx_rate_ = sdr_device_->getSampleRate();
+    rx_time_base_index_ = 0;
+    rx_time_base_ = 0.0;
+    rx_stage_.reset();
+    fft_stage_.reset();
+    stft_stage_.reset();
+    time_stage_.reset();
+    governor_.resetBaseline();
     
-    // Start receiving with our callback
-    auto callback = [this](const std::complex<float>* samples, size_t count) {
-        this->ProcessSamples(samples, count);
-    };
+    StartDspWorkers();
+    
+    // Device receives straight into the IQ ring, no intermediate copy
+    if (!sdr_device_->startReceivingInto(&rx_provider_, device_config_.buffer_size)) {
+        StopDspWorkers();
+        return false;
+    }
+    return true;
+}
+
+void SignalGui::StartDspWorkers() {
+    StopDspWorkers();
     
-    return sdr_device_->startReceiving(callback, device_config_.buffer_size);
+    // 0 workers: analyzer inline on the RX thread. 1: analyzer and STFT share
+    // a thread. More: one each. The STFT is never left to the render thread
+    bool shared = device_config_.dsp_workers == 1;
+    if (device_config_.dsp_workers > 0) {
+        fft_worker_ = std::make_unique<DspWorker>("osprey-fft", [this, shared]() {
+            RunAnalyzer();
+            if (shared) {
+                RunSTFTIfDue();
+            }
+        }, device_config_.dsp_threads);
+        fft_worker_->start();
+    }
+    
+    if (!shared) {
+        stft_worker_ = std::make_unique<DspWorker>("osprey-stft", [this]() {
+            RunSTFTIfDue();
+        }, device_config_.dsp_threads);
+        stft_worker_->start();
+    }
+}
+
+void SignalGui::StopDspWorkers() {
+    // Device must be stopped first, nothing may notify a worker being torn down
+    fft_worker_.reset();
+    stft_worker_.reset();
+}
+
+RxBufferProvider::Span SignalGui::IQRingProvider::acquire(size_t max_samples) {
+    IQRing::WriteSpan span = gui_.iq_ring_.Reserve(max_samples);
+    Span out;
+    out.data = span.data;
+    out.size = span.size;
+    return out;
+}
+
+void SignalGui::IQRingProvider::commit(size_t count, const SampleMetadata& metadata) {
+    gui_.iq_ring_.Commit(count);
+    gui_.ProcessSamples(count, metadata);
 }
 
 void SignalGui::StopReceiving() {
     if (sdr_device_) {
         sdr_device_->stopReceiving();
     }
+    StopDspWorkers();
 }
 
 bool SignalGui::IsReceiving() const {
     return sdr_device_ && sdr_device_->isReceiving();
 }
 
-void SignalGui::ProcessSamples(const std::complex<float>* samples, size_t count) {
-	if (real_samples_buffer.size() < count) {
-		real_samples_buffer.resize(count);
-	}
-
-    for (size_t i = 0; i < count; ++i) {
-		real_samples_buffer[i] = samples[i].real();
-    }
+void SignalGui::ProcessSamples(size_t count, const SampleMetadata& metadata) {
+	int64_t start = monotonicTimeNs();
 
-	signal_buffer_.PushBulk(real_samples_buffer.data(), count);
+	// Samples are already in the ring; time view, STFT and analyzer all read from it
 	new_time_data_available_.store(true);
-	current_time_ += count / sample_rate_;
+
+	// Stream position rather than a running sum, so the time axis stays
+	// aligned with the samples across gaps. A retune may change the rate,
+	// so the position is counted from the last one at the device's new rate
+	if (metadata.hasFlag(SampleMetadata::RETUNED)) {
+		rx_time_base_ += (metadata.sample_index - rx_time_base_index_) / rx_rate_;
+		rx_time_base_index_ = metadata.sample_index;
+		rx_rate_ = sdr_device_->getTelemetry().sample_rate;
+	}
+	current_time_.store(rx_time_base_ + (metadata.sample_index + count - rx_time_base_index_) / rx_rate_,
+	                    std::memory_order_relaxed);
+	if (metadata.hasFlag(SampleMetadata::DISCONTINUITY)) {
+		discontinuity_count_.fetch_add(1);
+	}
+	capture_latency_ns_.store(start - metadata.host_time_ns);
     
-	if (stft_processor_) {
-        stft_sample_buffer_.PushBulk(samples, count);
-        size_t min_samples_needed = STFT_FFT_SIZE + (MAX_STFT_TIME_FRAMES - 1) * STFT_FFT_STRIDE;
-        if (stft_sample_buffer_.Size() >= min_samples_needed) {
+	if (stft_images_) {
+        if (stft_reader_.Available() >= STFT_WINDOW_SAMPLES) {
             stft_data_ready_.store(true);
         }
     }
     
-    if (spectrogram_analyzer_) {
-        spectrogram_analyzer_->processSamples(samples, count);
+    // Hand off and get back to recv()
+    if (fft_worker_) {
+        fft_worker_->notify();
+    } else {
+        RunAnalyzer();
+    }
+    if (stft_worker_) {
+        stft_worker_->notify();
     }
     
-    samples_received_.fetch_add(count);
+    rx_stage_.record(monotonicTimeNs() - start, count);
+}
 
-    if (sdr_device_) {
-        size_t device_overflows = sdr_device_->getOverflowCount();
-        if (device_overflows > overflow_count_.load()) {
-            overflow_count_.store(device_overflows);
+void SignalGui::RunAnalyzer() {
+    // Whatever version is current now stays valid until this run is done
+    auto analyzer = analyzer_access_.Read();
+    if (!analyzer) {
+        return;
+    }
+    BufferStats input = analyzer_reader_.Stats();
+    int64_t start = monotonicTimeNs();
+    analyzer->processSamples(analyzer_reader_);
+    fft_stage_.record(monotonicTimeNs() - start, input.fill, input);
+}
+
+void SignalGui::RunSTFTIfDue() {
+    if (!stft_enabled_.load(std::memory_order_relaxed)) {
+        return;		// Shed by the governor
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_stft_update_time_ < std::chrono::milliseconds(stft_interval_ms_.load())) {
+        return;
+    }
+    UpdateSTFTSpectrogram();
+    last_stft_update_time_ = now;
+}
+
+void SignalGui::SetFFTSize(int fft_size) {
+    // Display side only: plots, waterfall and the 3D grid are sized by it.
+    // No view may point into an analyzer frame of another size afterwards
+    fft_size_ = fft_size;
+    num_freq_bins_ = fft_size_;
+    freq_data.assign(num_freq_bins_, 0.0f);
+    magnitude_data.assign(num_freq_bins_, 0.0f);
+    psd_data.assign(num_freq_bins_, 0.0f);
+    magnitude_view_ = magnitude_data.data();
+    psd_view_ = psd_data.data();
+    spectrogram_data.assign(N_TIME_BINS * num_freq_bins_, -80.0f);
+    spectrogram_row_ = 0;
+    freq_array_valid_ = false;
+    waterfall_3d_.reset();
+}
+
+void SignalGui::UpdateBudget() {
+    if (!device_config_.budget_governor || !IsReceiving()) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_governor_time_ < std::chrono::milliseconds(GOVERNOR_INTERVAL_MS)) {
+        return;
+    }
+    last_governor_time_ = now;
+
+    // Busy time per thread: RX (analyzer included when inline), the analyzer
+    // worker (STFT included when shared) and the STFT worker
+    StageTelemetry rx = rx_stage_.snapshot();
+    StageTelemetry fft = fft_stage_.snapshot();
+    StageTelemetry stft = stft_stage_.snapshot();
+    BudgetSample sample;
+    sample.time_ns = monotonicTimeNs();
+    sample.busy_ns[0] = rx.total_ns;
+    if (fft_worker_) {
+        sample.busy_ns[1] = fft.total_ns + (stft_worker_ ? 0 : stft.total_ns);
+    }
+    if (stft_worker_) {
+        sample.busy_ns[2] = stft.total_ns;
+    }
+    sample.frame_ns = gui_stage_.snapshot().avg_ns;
+    sample.lost_samples = fft.input.dropped;
+
+    int previous = governor_.level();
+    if (governor_.evaluate(sample)) {
+        ApplyBudgetLevel();
+        LOG_INFO("Budget governor: level {} -> {} ({}), {}", previous, governor_.level(),
+                 governor_.current().name, governor_.reason());
+    }
+}
+
+void SignalGui::ApplyBudgetLevel() {
+    const BudgetLevel& level = governor_.current();
+    if (SpectrogramAnalyzer* analyzer = spectrogram_analyzer_.Current()) {
+        analyzer->setFrameDecimation(level.display_decimation);
+    }
+    freq_interval_ms_ = FREQ_UPDATE_INTERVAL_MS * level.display_decimation;
+    waterfall_interval_ms_ = WATERFALL_UPDATE_INTERVAL_MS * level.display_decimation;
+    stft_stride_.store(std::max(1, STFT_FFT_SIZE * (100 - level.stft_overlap_percent) / 100));
+    stft_enabled_.store(level.run_stft);
+    show_3d_ = level.show_3d;
+    show_time_ = level.show_time;
+    ResizeAnalyzer(chosen_fft_size_ >> level.fft_size_shift);
+}
+
+void SignalGui::RebuildProcessors() {
+    if (analyzer_build_.valid() || stft_build_.valid()) {
+        rebuild_again_ = true;		// Joining the build in flight would stall the GUI
+        return;
+    }
+    int fft_size = requested_fft_size_;
+    float sample_rate = sample_rate_;
+    WindowType window = window_type_;
+    analyzer_build_ = std::async(std::launch::async, [fft_size, sample_rate, window]() {
+        return std::make_unique<SpectrogramAnalyzer>(fft_size, sample_rate, FFTMode::Complex, window);
+    });
+    if (stft_images_) {
+        int stride = stft_stride_.load();
+        WorkStealingPool* pool = stft_pool_.get();
+        stft_build_ = std::async(std::launch::async, [stride, sample_rate, pool]() {
+            auto stft = std::make_unique<STFTSpectrogram>(STFT_FFT_SIZE, stride, sample_rate);
+            stft->setThreadPool(pool);
+            return stft;
+        });
+    }
+}
+
+void SignalGui::PublishRebuiltProcessors() {
+    auto ready = [](const auto& build) {
+        return build.valid() && build.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    };
+
+    if (ready(analyzer_build_)) {
+        try {
+            std::unique_ptr<SpectrogramAnalyzer> analyzer = analyzer_build_.get();
+            analyzer->setFrameDecimation(governor_.current().display_decimation);
+
+            // Views point into the version about to be retired; hold on to
+            // the last spectrum until the new analyzer has one, or start the
+            // displays over at the new size
+            if (analyzer->getFFTSize() != fft_size_) {
+                SetFFTSize(analyzer->getFFTSize());
+            } else if (magnitude_view_ != magnitude_data.data()) {
+                std::copy(magnitude_view_, magnitude_view_ + num_freq_bins_, magnitude_data.begin());
+                std::copy(psd_view_, psd_view_ + num_freq_bins_, psd_data.begin());
+                magnitude_view_ = magnitude_data.data();
+                psd_view_ = psd_data.data();
+            }
+            spectrum_ready_ = false;
+            freq_array_valid_ = false;
+            spectrogram_analyzer_.Publish(std::move(analyzer));
+        } catch (const std::exception& e) {
+            LOG_ERROR("Analyzer rebuild failed, keeping the current one: {}", e.what());
         }
     }
+    if (ready(stft_build_)) {
+        try {
+            stft_processor_.Publish(stft_build_.get());
+        } catch (const std::exception& e) {
+            LOG_ERROR("STFT rebuild failed, keeping the current one: {}", e.what());
+        }
+    }
+    if (rebuild_again_ && !analyzer_build_.valid() && !stft_build_.valid()) {
+        rebuild_again_ = false;
+        RebuildProcessors();
+    }
+
+    // Old versions go once the analyzer and STFT threads have moved on
+    spectrogram_analyzer_.Reclaim();
+    stft_processor_.Reclaim();
+}
+
+void SignalGui::SetSTFTInterval(int interval_ms) {
+    stft_interval_ms_.store(std::clamp(interval_ms, MIN_STFT_INTERVAL_MS, MAX_STFT_INTERVAL_MS));
+}
+
+void SignalGui::ChangeFFTSize(int fft_size) {
+    chosen_fft_size_ = std::clamp(fft_size, MIN_FFT_SIZE, MAX_FFT_SIZE);
+    ResizeAnalyzer(chosen_fft_size_ >> governor_.current().fft_size_shift);
+}
+
+void SignalGui::ResizeAnalyzer(int fft_size) {
+    fft_size = std::clamp(fft_size, MIN_FFT_SIZE, MAX_FFT_SIZE);
+    if (fft_size == requested_fft_size_) {
+        return;
+    }
+    requested_fft_size_ = fft_size;
+    if (spectrogram_analyzer_.Current()) {
+        RebuildProcessors();
+    } else {
+        SetFFTSize(fft_size);
+    }
+}
+
+void SignalGui::SetWindow(WindowType window) {
+    if (window == window_type_) {
+        return;
+    }
+    window_type_ = window;
+    if (spectrogram_analyzer_.Current()) {
+        RebuildProcessors();
+    }
 }
 
 void SignalGui::RenderRFMLTab() {
-    if (stft_display_ready_.load() && stft_freq_bins_ > 0 && stft_time_frames_ > 0) {
+    if (!stft_images_) {
+        return;
+    }
+
+    int interval_ms = stft_interval_ms_.load();
+    if (ImGui::SliderInt("Update interval [ms]", &interval_ms,
+                         MIN_STFT_INTERVAL_MS, MAX_STFT_INTERVAL_MS)) {
+        SetSTFTInterval(interval_ms);
+    }
+    if (!stft_enabled_.load()) {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(1, 0.8f, 0, 1), "Paused by the budget governor");
+    }
+
+    // Only an index swap; the image was computed on the STFT thread
+    stft_images_->Update();
+    const STFTImage& image = stft_images_->Read();
+    if (image.freq_bins > 0 && image.time_frames > 0) {
 
         // Black background (like torchsig)
         ImPlot::PushStyleColor(ImPlotCol_PlotBg, ImVec4(0.0f, 0.0f, 0.0f, 1.0f));
@@ -155,10 +483,10 @@ void SignalGui::RenderRFMLTab() {
         if (ImPlot::BeginPlot("##STFTSpectrogram", ImVec2(-1, -1),
                              ImPlotFlags_NoLegend | ImPlotFlags_NoMouseText)) {
 
-            float freq_min = stft_freq_axis_[0];
-            float freq_max = stft_freq_axis_[stft_freq_bins_ - 1];
-            float time_min = stft_time_axis_[0];
-            float time_max = stft_time_axis_[stft_time_frames_ - 1];
+            float freq_min = image.freq_axis[0];
+            float freq_max = image.freq_axis[image.freq_bins - 1];
+            float time_min = image.time_axis[0];
+            float time_max = image.time_axis[image.time_frames - 1];
 
             ImPlot::SetupAxes("Frequency [Hz]", "Time [s]");
             ImPlot::SetupAxesLimits(freq_min, freq_max, time_min, time_max, ImGuiCond_Always);
@@ -167,8 +495,8 @@ void SignalGui::RenderRFMLTab() {
             ImPlot::PushColormap(ImPlotColormap_Greys);
 
             ImPlot::PlotHeatmap("##STFTHeatmap",
-                               stft_spectrogram_data_.data(),
-                               stft_freq_bins_, stft_time_frames_,
+                               image.data.data(),
+                               image.freq_bins, image.time_frames,
                                0.0f, -80.0f,  // -80dB=black, 0dB=white
                                nullptr,
                                ImPlotPoint(freq_min, time_min),
@@ -183,43 +511,74 @@ void SignalGui::RenderRFMLTab() {
 }
 
 void SignalGui::UpdateSTFTSpectrogram() {
-    if (!stft_processor_ || !stft_data_ready_.load()) {
+    if (!stft_data_ready_.load()) {
+        return;
+    }
+    auto stft = stft_access_.Read();
+    if (!stft) {
         return;
     }
     
-    // Calculate how many samples we need
-    size_t min_samples_needed = STFT_FFT_SIZE + (MAX_STFT_TIME_FRAMES - 1) * STFT_FFT_STRIDE;
+    // Same time span at any overlap, fewer frames with less of it
+    size_t min_samples_needed = STFT_WINDOW_SAMPLES;
     
-    if (stft_sample_buffer_.Size() < min_samples_needed) {
+    if (stft_reader_.Available() < min_samples_needed) {
         return; // Not enough samples yet
     }
+    int stride = stft_stride_.load(std::memory_order_relaxed);
+    if (stride != stft->getFFTStride()) {
+        stft->setFFTStride(stride);
+    }
     
-    // Copy samples from circular buffer to temporary vector
-    std::vector<std::complex<float>> temp_samples(min_samples_needed);
-    stft_sample_buffer_.CopyLatest(temp_samples.data(), min_samples_needed);
+    BufferStats input = stft_reader_.Stats();
+    int64_t start = monotonicTimeNs();
+
+    // Run straight on ring memory; only a non-mirrored ring needs the unwrap
+    auto window = stft_reader_.PeekLatest(min_samples_needed);
+    stft_reader_.SkipToLatest(min_samples_needed);
+    const std::complex<float>* samples = window.first;
+    if (!window.Contiguous()) {
+        stft_unwrap_.resize(window.Size());
+        std::copy(window.first, window.first + window.first_size, stft_unwrap_.begin());
+        std::copy(window.second, window.second + window.second_size,
+                  stft_unwrap_.begin() + window.first_size);
+        samples = stft_unwrap_.data();
+    }
     
-    // Compute STFT spectrogram
-    float* output_ptr = stft_spectrogram_data_.data();
-    bool success = stft_processor_->computeSpectrogram(
-        temp_samples.data(),
-        temp_samples.size(),
+    // Compute into the mailbox slot the display isn't reading
+    STFTImage& image = stft_images_->WriteBuffer();
+    float* output_ptr = image.data.data();
+    bool success = stft->computeSpectrogram(
+        samples,
+        window.Size(),
         &output_ptr,
-        &stft_freq_bins_,
-        &stft_time_frames_
+        &image.freq_bins,
+        &image.time_frames
     );
     
+    // RX overwrote part of the window mid-computation; the torn image is
+    // never published, try again next update
+    if (success && !stft_reader_.Intact(window)) {
+        return;
+    }
+    
     if (success) {
-        double center_freq = sdr_device_ ? sdr_device_->getFrequency() : 0.0;
-        stft_processor_->generateFrequencyArray(stft_freq_axis_.data(), center_freq);
-        stft_processor_->generateTimeArray(stft_time_axis_.data(), stft_time_frames_);
+        double center_freq = sdr_device_ ? sdr_device_->getTelemetry().frequency : 0.0;
+        stft->generateFrequencyArray(image.freq_axis.data(), center_freq);
+        stft->generateTimeArray(image.time_axis.data(), image.time_frames);
         
         stft_data_ready_.store(false);
-        stft_display_ready_.store(true);
+        stft_images_->Publish();
+        stft_stage_.record(monotonicTimeNs() - start, window.Size(), input);
     }
 }
 
 void SignalGui::Update() {
+    int64_t frame_start = monotonicTimeNs();
     update_counter_++;
+    ApplySettledCommands();
+    PublishRebuiltProcessors();
+    UpdateBudget();
     if (sdr_device_ && sdr_device_->isInitialized() && !sdr_device_->isReceiving()) {
         StartReceiving();
     }
@@ -229,7 +588,7 @@ void SignalGui::Update() {
 	auto freq_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
 			current_time - last_freq_update_time_).count();
 
-	bool should_update_freq = freq_elapsed >= FREQ_UPDATE_INTERVAL_MS;
+	bool should_update_freq = freq_elapsed >= freq_interval_ms_;
 	bool freq_data_updated = false;
 
 	if (should_update_freq) {
@@ -241,28 +600,19 @@ void SignalGui::Update() {
 	auto waterfall_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
         current_time - last_waterfall_update_time_).count();
 
-    bool should_update_waterfall = waterfall_elapsed >= WATERFALL_UPDATE_INTERVAL_MS;
+    bool should_update_waterfall = waterfall_elapsed >= waterfall_interval_ms_;
 
     if (should_update_waterfall && freq_data_updated) {
         UpdateWaterfall();
         last_waterfall_update_time_ = current_time;
     }
 
-	if (new_time_data_available_.load() || new_freq_data_available_.load()) {
+	if (show_time_ && (new_time_data_available_.load() || new_freq_data_available_.load())) {
 		UpdatePlotData();
 		new_time_data_available_.store(false);
 		new_freq_data_available_.store(false);
 	}
 
-	// Update STFT spectrogram
-	auto stft_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-        current_time - last_stft_update_time_).count();
-
-    if (stft_elapsed >= STFT_UPDATE_INTERVAL_MS) {
-        UpdateSTFTSpectrogram();
-        last_stft_update_time_ = current_time;
-    }
-
     // Set window position and size
     ImGui::SetNextWindowPos(ImVec2(0, 0), ImGuiCond_Always);
     ImGui::SetNextWindowSize(ImVec2(WINDOW_WIDTH, WINDOW_HEIGHT), ImGuiCond_Always);
@@ -301,9 +651,16 @@ void SignalGui::Update() {
         ImGui::EndTabBar();
     }
     ImGui::End();
+    gui_stage_.record(monotonicTimeNs() - frame_start, 1);
 }
 
 void SignalGui::Render3DSpectrogramView() {
+    if (!show_3d_) {
+        ImGui::TextColored(ImVec4(1, 0.8f, 0, 1), "3D view paused by the budget governor (%s)",
+                           governor_.reason().c_str());
+        return;
+    }
+
     ImVec2 available_size = ImGui::GetContentRegionAvail();
 
     // Reserve space for controls at bottom
@@ -392,30 +749,58 @@ void SignalGui::RenderStatusBar() {
         ImGui::Text("Device: %s", sdr_device_->getDeviceType().c_str());
         ImGui::SameLine();
         
-        if (sdr_device_->isInitialized()) {
+        // One consistent snapshot per frame, no locks or allocation
+        DeviceTelemetry telemetry = sdr_device_->getTelemetry();
+        if (telemetry.initialized) {
             ImGui::TextColored(ImVec4(0, 1, 0, 1), "CONNECTED");
             
             // Second line - device parameters
-            SDRStatus status = sdr_device_->getStatus();
             ImGui::Text("%s: %.3f GHz, %.1f MS/s, %.0f dB",
                        sdr_device_->getDeviceType().c_str(),
-                       status.current_frequency / 1e9,
-                       status.current_sample_rate / 1e6,
-                       status.current_gain);
+                       telemetry.frequency / 1e9,
+                       telemetry.sample_rate / 1e6,
+                       telemetry.gain);
             
             ImGui::SameLine();
-            ImGui::Text("RX: %.1fM samples", samples_received_.load() / 1e6);
+            ImGui::Text("RX: %.1fM samples", telemetry.samples_received / 1e6);
             
-            if (overflow_count_.load() > 0) {
+            if (telemetry.overflows > 0) {
+                ImGui::SameLine();
+                ImGui::TextColored(ImVec4(1, 0, 0, 1), "OVF: %llu",
+                                   static_cast<unsigned long long>(telemetry.overflows));
+            }
+            if (discontinuity_count_.load() > 0) {
                 ImGui::SameLine();
-                ImGui::TextColored(ImVec4(1, 0, 0, 1), "OVF: %zu", overflow_count_.load());
+                ImGui::TextColored(ImVec4(1, 0, 0, 1), "Gaps: %zu", discontinuity_count_.load());
             }
             
             // Show reception rate if receiving
-            if (status.receiving && status.reception_rate > 0) {
+            double rate = telemetry.receptionRate(monotonicTimeNs());
+            if (telemetry.receiving && rate > 0) {
                 ImGui::SameLine();
-                ImGui::Text("Rate: %.1f%%", status.reception_rate);
+                ImGui::Text("Rate: %.1f%%", rate);
             }
+
+            // Third line - where in the pipeline time goes and samples are lost
+            ImGui::Text("Latency: %.2f ms", capture_latency_ns_.load() / 1e6);
+            ImGui::SameLine();
+            RenderStageStats("RX", rx_stage_.snapshot());
+            ImGui::SameLine();
+            RenderStageStats("FFT", fft_stage_.snapshot());
+            ImGui::SameLine();
+            RenderStageStats("STFT", stft_stage_.snapshot());
+            ImGui::SameLine();
+            RenderStageStats("Time", time_stage_.snapshot());
+            ImGui::SameLine();
+            RenderStageStats("GUI", gui_stage_.snapshot());
+            if (fft_worker_) {
+                RenderWorkerStats(*fft_worker_);
+            }
+            if (stft_worker_) {
+                ImGui::SameLine();
+                RenderWorkerStats(*stft_worker_);
+            }
+            RenderBudgetStatus();
         } else {
             ImGui::TextColored(ImVec4(1, 0, 0, 1), "DISCONNECTED");
         }
@@ -424,6 +809,45 @@ void SignalGui::RenderStatusBar() {
     }
 }
 
+void SignalGui::RenderStageStats(const char* name, const StageTelemetry& stage) {
+    const BufferStats& stats = stage.input;
+    if (stats.capacity == 0) {
+        // Stage without an input buffer, e.g. the RX callback itself
+        ImGui::Text("%s: %.3f ms (max %.3f)", name, stage.avg_ns / 1e6, stage.max_ns / 1e6);
+        return;
+    }
+    ImGui::Text("%s: %.0f%% (peak %.0f%%) %.2f ms", name,
+               100.0 * stats.fill / stats.capacity,
+               100.0 * stats.high_water / stats.capacity,
+               stage.avg_ns / 1e6);
+    if (stats.dropped > 0) {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(1, 0.5f, 0, 1), "drop %zu", stats.dropped);
+    }
+}
+
+void SignalGui::RenderWorkerStats(const DspWorker& worker) {
+    ImGui::Text("%s: %zu queued (peak %zu), %llu runs", worker.name().c_str(),
+               worker.queued(), worker.peakQueued(),
+               static_cast<unsigned long long>(worker.runs()));
+}
+
+void SignalGui::RenderBudgetStatus() {
+    const BudgetLevel& level = governor_.current();
+    ImGui::Text("FFT: %d", fft_size_);
+    ImGui::SameLine();
+    if (!device_config_.budget_governor) {
+        ImGui::Text("Budget governor: off");
+        return;
+    }
+    ImVec4 color = governor_.level() == 0 ? ImVec4(0, 1, 0, 1) : ImVec4(1, 0.8f, 0, 1);
+    ImGui::TextColored(color, "Budget: level %d/%zu, %s", governor_.level(),
+                       BudgetGovernor::levels().size() - 1, level.name);
+    ImGui::SameLine();
+    ImGui::Text("(thread %.0f%%, frame %.0f%%, last change: %s)",
+               100.0 * governor_.threadLoad(), 100.0 * governor_.frameLoad(),
+               governor_.reason().c_str());
+}
 
 void SignalGui::updateRelTimeArray() {
 	for (int i = 0; i < N_SAMPLES; ++i) {
@@ -439,41 +863,50 @@ void SignalGui::updateTimeDataOffsets() {
 }
 
 void SignalGui::UpdatePlotData() {
+    BufferStats input = time_reader_.Stats();
+    int64_t start = monotonicTimeNs();
+    const float current_time = static_cast<float>(current_time_.load(std::memory_order_relaxed));
+    for (int i = 0; i < N_SAMPLES; ++i) {
+        time_data[i] = current_time + time_data_offsets[i];
+    }
+    time_reader_.CopyLatest(time_iq_data, N_SAMPLES);
+    time_reader_.SkipToLatest();
     for (int i = 0; i < N_SAMPLES; ++i) {
-        time_data[i] = current_time_ + time_data_offsets[i];
+        signal_data[i] = time_iq_data[i].real();
     }
-    signal_buffer_.CopyLatest(signal_data, N_SAMPLES);
-    freq_buffer_.CopyLatest(freq_data.data(), num_freq_bins_);
-    magnitude_buffer_.CopyLatest(magnitude_data.data(), num_freq_bins_);
-    psd_buffer_.CopyLatest(psd_data.data(), num_freq_bins_);
+    time_stage_.record(monotonicTimeNs() - start, N_SAMPLES, input);
 }
 
 void SignalGui::UpdateFrequencyDomain() {
-    if (!spectrogram_analyzer_) {
-        float nyquist_freq = sample_rate_ / 2.0f;
+    SpectrogramAnalyzer* analyzer = spectrogram_analyzer_.Current();
+    if (!analyzer) {
+        float bin_width = sample_rate_ / num_freq_bins_;
 
         for (int i = 0; i < num_freq_bins_; ++i) {
-            float freq = (float)i * nyquist_freq / num_freq_bins_;
+            float freq = (i - num_freq_bins_ / 2) * bin_width;
 			freq_data[i] = freq;
             magnitude_data[i]  = -80.0f + 10.0f * (float(rand()) / RAND_MAX - 0.5f);
             psd_data[i] = magnitude_data[i] - 10.0f;
         }
-		freq_buffer_.PushBulk(freq_data.data(), num_freq_bins_);
-		magnitude_buffer_.PushBulk(magnitude_data.data(), num_freq_bins_);
-		psd_buffer_.PushBulk(psd_data.data(), num_freq_bins_);
+        magnitude_view_ = magnitude_data.data();
+        psd_view_ = psd_data.data();
         return;
     }
 
-    spectrum_ready_ = spectrogram_analyzer_->getLatestSpectrum(magnitude_data.data(), num_freq_bins_);
-    bool psd_ready = spectrogram_analyzer_->getLatestPSD(psd_data.data(), num_freq_bins_, true); // dB scale
+    // Newest complete frame, drawn in place until the next update
+    spectrum_ready_ = analyzer->updateSpectrum();
 
     if (spectrum_ready_) {
-        double center_freq = sdr_device_ ? sdr_device_->getFrequency() : 0.0;
+        const SpectrumFrame& frame = analyzer->latestSpectrum();
+        magnitude_view_ = frame.magnitude_db.data();
+        psd_view_ = frame.psd.data();
+
+        double center_freq = sdr_device_ ? sdr_device_->getTelemetry().frequency : 0.0;
 
 		if (!freq_array_valid_ || sample_rate_ != last_sample_rate_ ||
 			center_freq != last_center_freq_) {
 
-			spectrogram_analyzer_->getFrequencyArray(freq_data.data(), num_freq_bins_, center_freq);
+			analyzer->getFrequencyArray(freq_data.data(), num_freq_bins_, center_freq);
 
 			if (sample_rate_ != last_sample_rate_) {
 				updateRelTimeArray();
@@ -485,36 +918,18 @@ void SignalGui::UpdateFrequencyDomain() {
 			freq_array_valid_ = true;
 		}
 
-		if (!psd_ready) {
-			for (int i = 0;i < num_freq_bins_; ++i) {
-				psd_data[i] = magnitude_data[i] - 10.0f;
-			}
-		}
-
-		freq_buffer_.PushBulk(freq_data.data(), num_freq_bins_);
-		magnitude_buffer_.PushBulk(magnitude_data.data(), num_freq_bins_);
-		psd_buffer_.PushBulk(psd_data.data(), num_freq_bins_);
 		new_freq_data_available_.store(true);
     }
 }
 
 void SignalGui::UpdateWaterfall() {
-    if (spectrum_ready_ && magnitude_buffer_.Size() >= num_freq_bins_) {
-        magnitude_buffer_.CopyLatest(magnitude_data.data(), num_freq_bins_);
-
-        for (int f = 0; f < num_freq_bins_; ++f) {
-            spectrogram_data[spectrogram_row_ * num_freq_bins_ + f] = magnitude_data[f];
-        }
+    if (spectrum_ready_) {
+        std::copy(magnitude_view_, magnitude_view_ + num_freq_bins_,
+                  spectrogram_data.begin() + spectrogram_row_ * num_freq_bins_);
         spectrogram_row_ = (spectrogram_row_ + 1) % N_TIME_BINS;
 
-        if (waterfall_3d_ && waterfall_3d_->isInitialized()) {
-            if (magnitude_data.size() == num_freq_bins_) {
-                waterfall_3d_->updateWaterfallData(magnitude_data.data(), num_freq_bins_);
-            } else {
-                std::cerr << "Warning: magnitude_size mismatch. Expected "
-                          << num_freq_bins_ << " actual " << magnitude_data.size()
-                          << std::endl;
-            }
+        if (show_3d_ && waterfall_3d_ && waterfall_3d_->isInitialized()) {
+            waterfall_3d_->updateWaterfallData(magnitude_view_, num_freq_bins_);
         }
     } else {
         for (int f = 0; f < num_freq_bins_; ++f) {
@@ -527,12 +942,16 @@ void SignalGui::UpdateWaterfall() {
 
 void SignalGui::RenderTimeDomainPlot() {
     ImGui::Text("Time domain");
+    if (!show_time_) {
+        ImGui::SameLine();
+        ImGui::TextColored(ImVec4(1, 0.8f, 0, 1), "(paused by the budget governor)");
+    }
 	ImPlot::PushStyleColor(ImPlotCol_PlotBg, ImVec4(0.0f, 0.0f, 0.0f, 1.0f));
     ImPlot::PushStyleColor(ImPlotCol_FrameBg, ImVec4(0.0f, 0.0f, 0.0f, 1.0f));
     ImPlot::PushStyleColor(ImPlotCol_Line, ImVec4(0.0f, 1.0f, 1.0f, 1.0f));
     if (ImPlot::BeginPlot("##TimePlot", ImVec2(-1, -1), ImPlotFlags_NoLegend | ImPlotFlags_NoMouseText)) {
         float min_amp = -1.0f, max_amp = 1.0f;
-        if (signal_buffer_.Size() >= N_SAMPLES) {
+        if (iq_ring_.TotalWritten() >= N_SAMPLES) {
             min_amp = signal_data[0];
             max_amp = signal_data[0];
             for (int i = 0; i < N_SAMPLES; ++i) {
@@ -565,25 +984,47 @@ void SignalGui::RenderTimeDomainPlot() {
 
 void SignalGui::RenderFrequencyPlot() {
     ImGui::Text("Frequency domain");
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(160.0f);
+    if (ImGui::BeginCombo("Window", windowName(window_type_))) {
+        for (WindowType window : windowTypes()) {
+            if (ImGui::Selectable(windowName(window), window == window_type_)) {
+                SetWindow(window);
+            }
+        }
+        ImGui::EndCombo();
+    }
+    ImGui::SameLine();
+    ImGui::SetNextItemWidth(100.0f);
+    std::string fft_label = std::to_string(chosen_fft_size_);
+    if (ImGui::BeginCombo("FFT size", fft_label.c_str())) {
+        for (int size = MIN_FFT_SIZE; size <= MAX_FFT_SIZE; size *= 2) {
+            std::string label = std::to_string(size);
+            if (ImGui::Selectable(label.c_str(), size == chosen_fft_size_)) {
+                ChangeFFTSize(size);
+            }
+        }
+        ImGui::EndCombo();
+    }
 	ImPlot::PushStyleColor(ImPlotCol_PlotBg, ImVec4(0.0f, 0.0f, 0.0f, 1.0f));
     ImPlot::PushStyleColor(ImPlotCol_FrameBg, ImVec4(0.0f, 0.0f, 0.0f, 1.0f));
     ImPlot::PushStyleColor(ImPlotCol_Line, ImVec4(0.0f, 1.0f, 0.8f, 1.0f));
     if (ImPlot::BeginPlot("##FreqPlot", ImVec2(-1, -1), ImPlotFlags_NoLegend | ImPlotFlags_NoMouseText)) {
         float min_mag = -80.0f, max_mag = -10.0f;
-        if (magnitude_buffer_.Size() > 0) {
-            min_mag = magnitude_data[0];
-            max_mag = magnitude_data[0];
+        if (magnitude_view_) {
+            min_mag = magnitude_view_[0];
+            max_mag = magnitude_view_[0];
             for (int i = 0; i < num_freq_bins_; ++i) {
-                if (magnitude_data[i] < min_mag) min_mag = magnitude_data[i];
-                if (magnitude_data[i] > max_mag) max_mag = magnitude_data[i];
+                if (magnitude_view_[i] < min_mag) min_mag = magnitude_view_[i];
+                if (magnitude_view_[i] > max_mag) max_mag = magnitude_view_[i];
             }
             float padding = (max_mag - min_mag) * 0.1f;
             min_mag -= padding;
             max_mag += padding;
         }
         
-        double center_freq = sdr_device_ ? sdr_device_->getFrequency() : 0.0;
-        float freq_min = center_freq;
+        double center_freq = sdr_device_ ? sdr_device_->getTelemetry().frequency : 0.0;
+        float freq_min = center_freq - sample_rate_ / 2.0f;
         float freq_max = center_freq + sample_rate_ / 2.0f;
         
         ImPlot::SetupAxes("Frequency [Hz]", "Magnitude [dB]", 
@@ -591,7 +1032,7 @@ void SignalGui::RenderFrequencyPlot() {
                          ImPlotAxisFlags_NoMenus | ImPlotAxisFlags_Lock);
         ImPlot::SetupAxesLimits(freq_min, freq_max, min_mag, max_mag, ImGuiCond_Always);
         
-        ImPlot::PlotLine("Magnitude", freq_data.data(), magnitude_data.data(), num_freq_bins_);
+        ImPlot::PlotLine("Magnitude", freq_data.data(), magnitude_view_, num_freq_bins_);
         ImPlot::EndPlot();
     }
 	ImPlot::PopStyleColor(3);
@@ -609,8 +1050,8 @@ void SignalGui::RenderSpectrogramPlot() {
         float noise_floor = reference_level - dynamic_range;
 
         // Calculate frequency range and lock axes
-        double center_freq = sdr_device_ ? sdr_device_->getFrequency() : 0.0;
-        float freq_min = center_freq;
+        double center_freq = sdr_device_ ? sdr_device_->getTelemetry().frequency : 0.0;
+        float freq_min = center_freq - sample_rate_ / 2.0f;
         float freq_max = center_freq + sample_rate_ / 2.0f;
 
         ImPlot::SetupAxes("Frequency [Hz]", "Time",
@@ -640,12 +1081,12 @@ void SignalGui::RenderPowerSpectralDensity() {
     ImPlot::PushStyleColor(ImPlotCol_Line, ImVec4(0.2f, 0.8f, 1.0f, 1.0f));
     if (ImPlot::BeginPlot("##PSDPlot", ImVec2(-1, -1), ImPlotFlags_NoLegend | ImPlotFlags_NoMouseText)) {
         float min_psd = -100.0f, max_psd = -20.0f;
-        if (psd_buffer_.Size() > 0) {
-            min_psd = psd_data[0];
-            max_psd = psd_data[0];
+        if (psd_view_) {
+            min_psd = psd_view_[0];
+            max_psd = psd_view_[0];
             for (int i = 0; i < num_freq_bins_; ++i) {
-                if (psd_data[i] < min_psd) min_psd = psd_data[i];
-                if (psd_data[i] > max_psd) max_psd = psd_data[i];
+                if (psd_view_[i] < min_psd) min_psd = psd_view_[i];
+                if (psd_view_[i] > max_psd) max_psd = psd_view_[i];
             }
             // Add some padding
             float padding = (max_psd - min_psd) * 0.1f;
@@ -654,8 +1095,8 @@ void SignalGui::RenderPowerSpectralDensity() {
         }
         
         // Set frequency range and disable interactions  
-        double center_freq = sdr_device_ ? sdr_device_->getFrequency() : 0.0;
-        float freq_min = center_freq;
+        double center_freq = sdr_device_ ? sdr_device_->getTelemetry().frequency : 0.0;
+        float freq_min = center_freq - sample_rate_ / 2.0f;
         float freq_max = center_freq + sample_rate_ / 2.0f;
         
         ImPlot::SetupAxes("Frequency [Hz]", "PSD [dB/Hz]", 
@@ -663,57 +1104,88 @@ void SignalGui::RenderPowerSpectralDensity() {
                          ImPlotAxisFlags_NoMenus | ImPlotAxisFlags_Lock);
         ImPlot::SetupAxesLimits(freq_min, freq_max, min_psd, max_psd, ImGuiCond_Always);
         
-        ImPlot::PlotLine("PSD", freq_data.data(), psd_data.data(), num_freq_bins_);
+        ImPlot::PlotLine("PSD", freq_data.data(), psd_view_, num_freq_bins_);
         ImPlot::EndPlot();
     }
 	ImPlot::PopStyleColor(3);
 }
 
 // Device control methods
-bool SignalGui::SetFrequency(double freq_hz) {
-    if (!sdr_device_) return false;
-    
-    bool success = sdr_device_->setFrequency(freq_hz);
-    if (success) {
-        device_config_.frequency = freq_hz;
+namespace {
+
+std::shared_future<bool> FailedSetting() {
+    std::promise<bool> failed;
+    failed.set_value(false);
+    return failed.get_future().share();
+}
+
+}
+
+std::shared_future<bool> SignalGui::QueueSetting(std::future<bool> result,
+                                                 std::function<void()> apply) {
+    std::shared_future<bool> shared = result.share();
+    pending_settings_.push_back({shared, std::move(apply)});
+    return shared;
+}
+
+void SignalGui::ApplySettledCommands() {
+    // In submission order, so of coalesced commands the last one's state wins
+    size_t kept = 0;
+    for (size_t i = 0; i < pending_settings_.size(); ++i) {
+        PendingSetting& setting = pending_settings_[i];
+        if (setting.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            pending_settings_[kept++] = std::move(setting);
+            continue;
+        }
+        if (setting.result.get()) {
+            setting.apply();
+        }
     }
-    return success;
+    pending_settings_.resize(kept);
 }
 
-bool SignalGui::SetSampleRate(double rate_sps) {
-    if (!sdr_device_) return false;
-    
-    bool success = sdr_device_->setSampleRate(rate_sps);
-    if (success) {
+std::shared_future<bool> SignalGui::SetFrequency(double freq_hz) {
+    if (!device_commands_) {
+        return FailedSetting();
+    }
+    return QueueSetting(device_commands_->setFrequency(freq_hz), [this, freq_hz]() {
+        device_config_.frequency = freq_hz;
+    });
+}
+
+std::shared_future<bool> SignalGui::SetSampleRate(double rate_sps) {
+    if (!device_commands_) {
+        return FailedSetting();
+    }
+    return QueueSetting(device_commands_->setSampleRate(rate_sps), [this, rate_sps]() {
         device_config_.sample_rate = rate_sps;
         sample_rate_ = static_cast<float>(rate_sps);
         
 		// Change in sample rate should regen frequency array
 		freq_array_valid_ = false;
 
-        spectrogram_analyzer_ = std::make_unique<SpectrogramAnalyzer>(fft_size_, sample_rate_);
-    }
-    return success;
+        // The current analyzer and STFT keep running until their
+        // replacements for the new rate are ready
+        RebuildProcessors();
+    });
 }
 
-bool SignalGui::SetGain(double gain_db) {
-    if (!sdr_device_) return false;
-    
-    bool success = sdr_device_->setGain(gain_db);
-    if (success) {
-        device_config_.gain = gain_db;
+std::shared_future<bool> SignalGui::SetGain(double gain_db) {
+    if (!device_commands_) {
+        return FailedSetting();
     }
-    return success;
+    return QueueSetting(device_commands_->setGain(gain_db), [this, gain_db]() {
+        device_config_.gain = gain_db;
+    });
 }
 
-bool SignalGui::SetBandwidth(double bandwidth_hz) {
-    if (!sdr_device_) return false;
-    
-    bool success = sdr_device_->setBandwidth(bandwidth_hz);
-    if (success) {
-        device_config_.bandwidth = bandwidth_hz;
+std::shared_future<bool> SignalGui::SetBandwidth(double bandwidth_hz) {
+    if (!device_commands_) {
+        return FailedSetting();
     }
-    return success;
+    return QueueSetting(device_commands_->setBandwidth(bandwidth_hz), [this, bandwidth_hz]() {
+        device_config_.bandwidth = bandwidth_hz;
+    });
 }
 
 void SignalGui::spectrumColormap() {
@@ -739,28 +1211,38 @@ void SignalGui::spectrumColormap() {
 
 void SignalGui::initializeSTFTProcessor() {
     try {
-        stft_processor_ = std::make_unique<STFTSpectrogram>(
+        auto stft = std::make_unique<STFTSpectrogram>(
             STFT_FFT_SIZE,
             STFT_FFT_STRIDE,
             sample_rate_
         );
 
-        while (!stft_sample_buffer_.IsEmpty()) {
-            std::complex<float> dummy;
-            stft_sample_buffer_.Pop(dummy);
+        // The thread running the STFT works as one of the pool's workers
+        if (device_config_.stft_threads > 1) {
+            stft_pool_ = std::make_unique<WorkStealingPool>(device_config_.stft_threads,
+                                                            device_config_.dsp_threads);
+            stft->setThreadPool(stft_pool_.get());
         }
+        stft_processor_.Publish(std::move(stft));
+        stft_processor_.Reclaim();
+
+        stft_reader_.SkipToLatest();
 
-        // Pre-allocate output buffers
-        stft_spectrogram_data_.resize(STFT_FFT_SIZE * MAX_STFT_TIME_FRAMES);
-        stft_freq_axis_.resize(STFT_FFT_SIZE);
-        stft_time_axis_.resize(MAX_STFT_TIME_FRAMES);
+        // Pre-allocate all three mailbox slots
+        STFTImage blank;
+        blank.data = std::vector<float, BufferAllocator<float>>(
+            STFT_FFT_SIZE * MAX_STFT_TIME_FRAMES, 0.0f,
+            BufferAllocator<float>(MemoryPolicy::largeBuffer()));
+        blank.freq_axis.resize(STFT_FFT_SIZE);
+        blank.time_axis.resize(MAX_STFT_TIME_FRAMES);
+        stft_images_ = std::make_unique<TripleBuffer<STFTImage>>(blank);
 
         std::cout << "STFT processor initialized for RFML tab (buffer capacity: "
-                  << stft_sample_buffer_.Capacity() << ")" << std::endl;
+                  << iq_ring_.Capacity() << ")" << std::endl;
 
     } catch (const std::exception& e) {
         std::cerr << "Failed to initialize STFT processor: " << e.what() << std::endl;
-        stft_processor_.reset();
+        stft_processor_.Publish(nullptr);
     }
 }
 
@@ -5,45 +5,75 @@
 #include <string>
 #include <vector>
 #include <chrono>
+#include <future>
 
 #include "imgui.h"
 #include "implot.h"
-#include "CircularBuffer.h"
 #include "SDRDevice.h"
 #include "FFTProcessor.h"
 #include "STFTSpectrogram.h"
+#include "WorkStealingPool.h"
 #include "Spectro3D.h"
+#include "BroadcastRing.h"
+#include "TripleBuffer.h"
+#include "DspWorker.h"
+#include "DeviceCommandQueue.h"
+#include "BudgetGovernor.h"
+#include "RcuPointer.h"
 
 class SignalGui {
 private:
     static constexpr int WINDOW_WIDTH  = 1920;
     static constexpr int WINDOW_HEIGHT = 1080;
 
-	int fft_size_;
+	int fft_size_;						// Size the displays are laid out for, the published analyzer's
+	int requested_fft_size_;			// Size the next analyzer is built with
+	int chosen_fft_size_;				// User's or calibrated size, the governor may run below it
 	int num_freq_bins_;
+	WindowType window_type_ = WindowType::Blackman;
+    static constexpr int DEFAULT_FFT_SIZE = 8192;
+    static constexpr int MIN_FFT_SIZE = 256;
+    static constexpr int MAX_FFT_SIZE = 65536;
 
     static constexpr int N_SAMPLES = 1000;
     static constexpr int N_TIME_BINS = 300;
 
     static constexpr int FREQ_UPDATE_INTERVAL_MS = 25;
     static constexpr int WATERFALL_UPDATE_INTERVAL_MS = 40;
-
-    // Plot buffers
-    CircularBuffer<float> time_buffer_;
-    CircularBuffer<float> signal_buffer_;
-    CircularBuffer<float> freq_buffer_;
-    CircularBuffer<float> magnitude_buffer_;
-    CircularBuffer<float> psd_buffer_;
+    int freq_interval_ms_ = FREQ_UPDATE_INTERVAL_MS;		// Scaled by the governor's display decimation
+    int waterfall_interval_ms_ = WATERFALL_UPDATE_INTERVAL_MS;
+
+    // Every consumer reads the same IQ samples through its own cursor
+    using IQRing = BroadcastRing<std::complex<float>>;
+    static constexpr size_t IQ_RING_SIZE = 1 << 20;	// STFT window + headroom while it computes in place
+    IQRing iq_ring_;
+    IQRing::Reader time_reader_;
+    IQRing::Reader stft_reader_;
+    IQRing::Reader analyzer_reader_;
+
+    // Lets the device recv() straight into iq_ring_
+    class IQRingProvider : public RxBufferProvider {
+    public:
+        explicit IQRingProvider(SignalGui& gui) : gui_(gui) {}
+        Span acquire(size_t max_samples) override;
+        void commit(size_t count, const SampleMetadata& metadata) override;
+    private:
+        SignalGui& gui_;
+    };
+    IQRingProvider rx_provider_{*this};
 
     int spectrogram_row_;
 
     // Plot displays
     float time_data[N_SAMPLES];
     float signal_data[N_SAMPLES];
+    std::complex<float> time_iq_data[N_SAMPLES];
 	std::vector<float> freq_data;
-	std::vector<float> magnitude_data;
+	std::vector<float> magnitude_data;	// Placeholder spectrum without an analyzer
 	std::vector<float> psd_data;
-	std::vector<float> spectrogram_data;
+	const float* magnitude_view_ = nullptr;	// Analyzer's current frame or the placeholders
+	const float* psd_view_ = nullptr;
+	std::vector<float, BufferAllocator<float>> spectrogram_data;	// Waterfall history
 
 	std::atomic<bool> new_time_data_available_;
 	std::atomic<bool> new_freq_data_available_;
@@ -51,12 +81,19 @@ private:
 	std::chrono::steady_clock::time_point last_freq_update_time_;
 	std::chrono::steady_clock::time_point last_waterfall_update_time_;
 
-	std::vector<float> real_samples_buffer;
 	std::vector<float> rel_time_array;
 	std::vector<float> time_data_offsets;
 
-    float current_time_;
-    float sample_rate_;
+    // Written by the RX thread, read by the GUI
+    std::atomic<double> current_time_;
+    // Display rate: the GUI sets it once a rate change lands, the analyzer
+    // rebuild reads it
+    std::atomic<float> sample_rate_;
+    // RX thread only: the time axis runs from the last retune at the
+    // device's rate for that stretch
+    double rx_rate_ = 1.0;
+    uint64_t rx_time_base_index_ = 0;
+    double rx_time_base_ = 0.0;
     int update_counter_;
 
 	double last_sample_rate_;
@@ -65,11 +102,31 @@ private:
 
     std::unique_ptr<SDRDevice> sdr_device_;
     SDRConfig device_config_;
-    std::atomic<size_t> samples_received_;
-    std::atomic<size_t> overflow_count_;
 
-    // Updated to use new SpectrogramAnalyzer
-    std::unique_ptr<SpectrogramAnalyzer> spectrogram_analyzer_;
+    // Setters run on the device control thread; GUI-side state follows once
+    // a command has landed, checked every frame
+    std::unique_ptr<DeviceCommandQueue> device_commands_;
+    struct PendingSetting {
+        std::shared_future<bool> result;
+        std::function<void()> apply;
+    };
+    std::vector<PendingSetting> pending_settings_;
+    std::shared_future<bool> QueueSetting(std::future<bool> result, std::function<void()> apply);
+    void ApplySettledCommands();
+    std::atomic<size_t> discontinuity_count_{0};
+    std::atomic<int64_t> capture_latency_ns_{0};	// Capture to ProcessSamples, last block
+
+    // Per-stage timing and input fill, written by the stage, read by the status bar
+    StageProbe rx_stage_;
+    StageProbe fft_stage_;
+    StageProbe stft_stage_;
+    StageProbe time_stage_;
+    StageProbe gui_stage_;		// Whole Update(), i.e. the render thread's frame time
+
+    // Replaced whole on reconfiguration: the GUI thread publishes, the thread
+    // running the analyzer picks the new one up at its next block
+    RcuPointer<SpectrogramAnalyzer> spectrogram_analyzer_;
+    RcuPointer<SpectrogramAnalyzer>::Reader analyzer_access_{spectrogram_analyzer_};
     bool spectrum_ready_ = false;
 
     std::unique_ptr<Spectro3D> waterfall_3d_;
@@ -77,21 +134,44 @@ private:
 	int custom_spectrum_colormap_ = -1;
 	void spectrumColormap();
 
-	std::unique_ptr<STFTSpectrogram> stft_processor_;
-	CircularBuffer<std::complex<float>> stft_sample_buffer_;
-    std::vector<float> stft_spectrogram_data_;
-    std::vector<float> stft_freq_axis_;
-    std::vector<float> stft_time_axis_;
-    int stft_freq_bins_ = 0;
-    int stft_time_frames_ = 0;
+    std::unique_ptr<WorkStealingPool> stft_pool_;	// Shares STFT frames out, if enabled
+	RcuPointer<STFTSpectrogram> stft_processor_;	// Same, picked up at the next image
+	RcuPointer<STFTSpectrogram>::Reader stft_access_{stft_processor_};
+    std::unique_ptr<TripleBuffer<STFTImage>> stft_images_;	// Latest finished spectrogram
+    std::vector<std::complex<float>> stft_unwrap_;	// Only used if the IQ ring is not mirrored
     std::atomic<bool> stft_data_ready_{false};
-    std::atomic<bool> stft_display_ready_{false};
-    std::chrono::steady_clock::time_point last_stft_update_time_;
-    static constexpr int STFT_UPDATE_INTERVAL_MS = 500;
+    std::chrono::steady_clock::time_point last_stft_update_time_;	// STFT thread only
+    std::atomic<int> stft_interval_ms_{500};
+    static constexpr int MIN_STFT_INTERVAL_MS = 20;
+    static constexpr int MAX_STFT_INTERVAL_MS = 5000;
     static constexpr int STFT_FFT_SIZE = 1024;
     static constexpr int STFT_FFT_STRIDE = 512;
     static constexpr int MAX_STFT_TIME_FRAMES = 120;
-	static constexpr size_t STFT_BUFFER_SIZE = 65536;
+    // Time span of one image; less overlap means fewer frames over the same span
+    static constexpr size_t STFT_WINDOW_SAMPLES = STFT_FFT_SIZE + (MAX_STFT_TIME_FRAMES - 1) * STFT_FFT_STRIDE;
+    std::atomic<int> stft_stride_{STFT_FFT_STRIDE};	// Set by the governor, applied by the STFT thread
+    std::atomic<bool> stft_enabled_{true};
+
+    // The RX callback only notifies, these do the spectral work. The analyzer
+    // runs inline without fft_worker_; the STFT never runs on the render thread,
+    // it shares fft_worker_ or has stft_worker_ to itself
+    std::unique_ptr<DspWorker> fft_worker_;
+    std::unique_ptr<DspWorker> stft_worker_;
+
+    // Trades display quality for staying real-time, from measured stage load
+    BudgetGovernor governor_;
+    std::chrono::steady_clock::time_point last_governor_time_;
+    static constexpr int GOVERNOR_INTERVAL_MS = 500;
+    static constexpr double ANALYZER_BUDGET = 0.25;	// Share of a core the analyzer's FFT size may cost
+    bool show_3d_ = true;
+    bool show_time_ = true;
+
+    // Replacement processing state, built off the GUI thread and published
+    // when ready; never waited for
+    std::future<std::unique_ptr<SpectrogramAnalyzer>> analyzer_build_;
+    std::future<std::unique_ptr<STFTSpectrogram>> stft_build_;
+    bool rebuild_again_ = false;	// Settings changed again while building
+    std::future<void> plan_prewarm_;	// FFT plans for every size the UI offers
 
 public:
     SignalGui();
@@ -107,11 +187,26 @@ public:
     void StopReceiving();
     bool IsReceiving() const;
     
-    // Params
-    bool SetFrequency(double freq_hz);
-    bool SetSampleRate(double rate_sps);
-    bool SetGain(double gain_db);
-    bool SetBandwidth(double bandwidth_hz);
+    // Params, asynchronous: return at once, resolve when the device has applied
+    // the change (or a later one to the same setting that replaced it)
+    std::shared_future<bool> SetFrequency(double freq_hz);
+    std::shared_future<bool> SetSampleRate(double rate_sps);
+    std::shared_future<bool> SetGain(double gain_db);
+    std::shared_future<bool> SetBandwidth(double bandwidth_hz);
+    
+    // Time between RFML spectrogram images, independent of the render rate
+    void SetSTFTInterval(int interval_ms);
+    int GetSTFTInterval() const { return stft_interval_ms_.load(); }
+
+    // Analyzer window; the current analyzer runs until its replacement is built
+    void SetWindow(WindowType window);
+    WindowType GetWindow() const { return window_type_; }
+
+    // Analyzer FFT size (power of two, MIN_FFT_SIZE-MAX_FFT_SIZE), switched
+    // live the same way; the displays follow once the new analyzer is in.
+    // The budget governor may halve it for as long as it is overloaded
+    void ChangeFFTSize(int fft_size);
+    int GetFFTSize() const { return chosen_fft_size_; }
     
     // Device info
     std::string GetDeviceType() const;
@@ -120,7 +215,8 @@ public:
     SDRCapabilities GetDeviceCapabilities() const;
 
 private:
-    void ProcessSamples(const std::complex<float>* samples, size_t count);
+    // RX thread, after count new samples were committed to iq_ring_
+    void ProcessSamples(size_t count, const SampleMetadata& metadata);
     
     // Update functions
     void UpdatePlotData();
@@ -129,6 +225,16 @@ private:
 	void updateRelTimeArray();
 	void updateTimeDataOffsets();
 	void UpdateSTFTSpectrogram();
+	void RunAnalyzer();
+	void RunSTFTIfDue();
+	void StartDspWorkers();
+	void StopDspWorkers();
+	void SetFFTSize(int fft_size);
+	void UpdateBudget();
+	void ApplyBudgetLevel();
+	void ResizeAnalyzer(int fft_size);
+	void RebuildProcessors();
+	void PublishRebuiltProcessors();
     
     // Rendering functions
     void RenderTimeDomainPlot();
@@ -138,6 +244,9 @@ private:
     void RenderPowerSpectralDensity();
     void Render3DSpectrogramView();
     void RenderStatusBar();
+    void RenderStageStats(const char* name, const StageTelemetry& stage);
+    void RenderWorkerStats(const DspWorker& worker);
+    void RenderBudgetStatus();
 	void RenderRFMLTab();
 
 	void initializeSTFTProcessor();
@@ -33,8 +33,11 @@ bool SimulationDevice::initialize(const SDRConfig& config) {
     gain_ = config.gain;
     bandwidth_ = config.bandwidth > 0 ? config.bandwidth : config.sample_rate;
     antenna_ = config.antenna.empty() ? "SIM" : config.antenna;
+    thread_policy_ = config.rx_thread;
     
     initialized_ = true;
+    publishTuning(frequency_, sample_rate_, gain_, bandwidth_);
+    publishState(true, false);
     clearError();
     
     std::cout << "Simulation device initialized:" << std::endl;
@@ -51,10 +54,38 @@ void SimulationDevice::shutdown() {
         stopReceiving();
     }
     initialized_ = false;
+    publishState(false, false);
     clearError();
 }
 
 bool SimulationDevice::startReceiving(SampleCallback callback, size_t buffer_size) {
+    return startWorker(callback, nullptr, nullptr, buffer_size);
+}
+
+bool SimulationDevice::startReceivingBlocks(BlockCallback callback, size_t buffer_size,
+                                            size_t num_blocks) {
+    if (receiving_.load()) {
+        setError("Already receiving");
+        return false;
+    }
+    if (!prepareBlockPool(num_blocks, buffer_size)) {
+        return false;
+    }
+    // Generator writes straight into pooled blocks
+    return startWorker(nullptr, callback, nullptr, buffer_size);
+}
+
+bool SimulationDevice::startReceivingInto(RxBufferProvider* provider, size_t buffer_size) {
+    if (!provider) {
+        setError("No RX buffer provider");
+        return false;
+    }
+    // Generator writes straight into the consumer's spans
+    return startWorker(nullptr, nullptr, provider, buffer_size);
+}
+
+bool SimulationDevice::startWorker(SampleCallback sample_callback, BlockCallback block_callback,
+                                   RxBufferProvider* provider, size_t buffer_size) {
     if (!initialized_) {
         setError("Device not initialized");
         return false;
@@ -65,12 +96,15 @@ bool SimulationDevice::startReceiving(SampleCallback callback, size_t buffer_siz
         return false;
     }
     
-    sample_callback_ = callback;
+    sample_callback_ = sample_callback;
+    block_callback_ = block_callback;
+    buffer_provider_ = provider;
     buffer_size_ = buffer_size;
     stop_signal_.store(false);
     total_samples_.store(0);
     overflow_count_.store(0);
     start_time_ = std::chrono::steady_clock::now();
+    publishState(true, true);
     
     try {
         generator_thread_ = std::make_unique<std::thread>(
@@ -79,6 +113,7 @@ bool SimulationDevice::startReceiving(SampleCallback callback, size_t buffer_siz
         std::cout << "Simulation device started generating samples" << std::endl;
         return true;
     } catch (const std::exception& e) {
+        publishState(true, false);
         setError("Failed to start generator thread: " + std::string(e.what()));
         return false;
     }
@@ -96,6 +131,7 @@ void SimulationDevice::stopReceiving() {
     
     receiving_.store(false);
     generator_thread_.reset();
+    publishState(initialized_, false);
     
     auto duration = std::chrono::steady_clock::now() - start_time_;
     double seconds = std::chrono::duration<double>(duration).count();
@@ -112,6 +148,7 @@ bool SimulationDevice::setFrequency(double freq_hz, size_t channel) {
         return false;
     }
     frequency_ = freq_hz;
+    publishTuning(frequency_, sample_rate_, gain_, bandwidth_);
     return true;
 }
 
@@ -125,6 +162,7 @@ bool SimulationDevice::setSampleRate(double rate_sps, size_t channel) {
         return false;
     }
     sample_rate_ = rate_sps;
+    publishTuning(frequency_, sample_rate_, gain_, bandwidth_);
     return true;
 }
 
@@ -134,6 +172,7 @@ bool SimulationDevice::setGain(double gain_db, size_t channel) {
         return false;
     }
     gain_ = gain_db;
+    publishTuning(frequency_, sample_rate_, gain_, bandwidth_);
     return true;
 }
 
@@ -143,6 +182,7 @@ bool SimulationDevice::setBandwidth(double bandwidth_hz, size_t channel) {
         return false;
     }
     bandwidth_ = bandwidth_hz;
+    publishTuning(frequency_, sample_rate_, gain_, bandwidth_);
     return true;
 }
 
@@ -186,27 +226,8 @@ SDRCapabilities SimulationDevice::getCapabilities() const {
 }
 
 SDRStatus SimulationDevice::getStatus() const {
-    SDRStatus status;
-    
-    status.initialized = initialized_;
-    status.receiving = receiving_.load();
-    status.current_frequency = frequency_;
-    status.current_sample_rate = sample_rate_;
-    status.current_gain = gain_;
-    status.current_bandwidth = bandwidth_;
-    status.samples_received = total_samples_.load();
-    status.overflow_count = overflow_count_.load();
-    status.has_overflow = status.overflow_count > 0;
-    
-    if (receiving_.load()) {
-        auto duration = std::chrono::steady_clock::now() - start_time_;
-        double seconds = std::chrono::duration<double>(duration).count();
-        double expected_samples = sample_rate_ * seconds;
-        status.reception_rate = (status.samples_received / expected_samples) * 100.0;
-    }
-    
+    SDRStatus status = statusFromTelemetry();
     status.device_specific_status = "Signal: " + signal_type_;
-    
     return status;
 }
 
@@ -223,41 +244,103 @@ void SimulationDevice::clearTones() {
 }
 
 void SimulationDevice::generatorWorker() {
+    applyThreadPolicy(thread_policy_, "sim-rx");
     std::vector<std::complex<float>> buffer(buffer_size_);
     double time = 0.0;
     
-    const double dt = 1.0 / sample_rate_;
-    const auto batch_duration = std::chrono::duration<double>(buffer_size_ * dt);
+    // Simulated device clock advances by the samples generated at the rate in effect
+    uint64_t sample_index = 0;
+    double device_time = 0.0;
+    double dt = 1.0 / sample_rate_;
+    uint32_t pending_flags = 0;
     
     while (!stop_signal_.load()) {
         auto start = std::chrono::steady_clock::now();
-        
-        if (signal_type_ == "multitone") {
-            generateMultitoneSamples(buffer.data(), buffer_size_, time);
-        } else if (signal_type_ == "noise") {
-            generateNoiseSamples(buffer.data(), buffer_size_);
-        } else if (signal_type_ == "fm") {
-            generateFMSamples(buffer.data(), buffer_size_, time);
-        } else if (signal_type_ == "am") {
-            generateAMSamples(buffer.data(), buffer_size_, time);
-        } else {
-            generateMultitoneSamples(buffer.data(), buffer_size_, time);
+
+        // Retunes take effect here, between blocks; the block that first
+        // uses new settings is flagged
+        SampleMetadata meta;
+        meta.flags = SampleMetadata::HAS_DEVICE_TIME | pending_flags | takeRetuneFlag();
+        pending_flags = 0;
+        if (meta.hasFlag(SampleMetadata::RETUNED)) {
+            // Only picked up with the flag, so no block runs at a new rate unflagged
+            dt = 1.0 / sample_rate_;
         }
+        meta.sample_index = sample_index;
+        meta.device_time = device_time;
+        meta.host_time_ns = monotonicTimeNs();
 
-        if (sample_callback_) {
-            sample_callback_(buffer.data(), buffer_size_);
-            total_samples_.fetch_add(buffer_size_);
+        // Provider spans can be shorter than a full batch (ring wrap)
+        size_t batch = buffer_size_;
+        size_t delivered = 0;
+        
+        if (buffer_provider_) {
+            RxBufferProvider::Span span = buffer_provider_->acquire(buffer_size_);
+            if (span.data && span.size > 0) {
+                batch = std::min(span.size, buffer_size_);
+                generateSamples(span.data, batch, time);
+                buffer_provider_->commit(batch, meta);
+                total_samples_.fetch_add(batch);
+                delivered = batch;
+            } else {
+                generateSamples(buffer.data(), batch, time);
+                overflow_count_.fetch_add(1);
+                pending_flags |= SampleMetadata::DEVICE_OVERFLOW | SampleMetadata::DISCONTINUITY;
+            }
+        } else if (block_callback_) {
+            SampleBlockRef block = block_pool_->acquire();
+            if (block) {
+                generateSamples(block->data, buffer_size_, time);
+                block->size = buffer_size_;
+                block->metadata = meta;
+                block_callback_(block);
+                total_samples_.fetch_add(buffer_size_);
+                delivered = buffer_size_;
+            } else {
+                // Consumers still hold every block: keep signal time moving
+                generateSamples(buffer.data(), buffer_size_, time);
+                overflow_count_.fetch_add(1);
+                pending_flags |= SampleMetadata::DEVICE_OVERFLOW | SampleMetadata::DISCONTINUITY;
+            }
+        } else {
+            generateSamples(buffer.data(), buffer_size_, time);
+            if (sample_callback_) {
+                sample_callback_(buffer.data(), buffer_size_, meta);
+                total_samples_.fetch_add(buffer_size_);
+                delivered = buffer_size_;
+            }
         }
         
+        sample_index += batch;
+        device_time += batch * dt;
+        publishRxBlock(delivered, overflow_count_.load(), meta.host_time_ns);
+        
         auto elapsed = std::chrono::steady_clock::now() - start;
+        auto batch_duration = std::chrono::duration<double>(batch * dt);
         if (elapsed < batch_duration) {
             std::this_thread::sleep_for(batch_duration - elapsed);
         } else {
+            // Fell behind real time but no samples were lost
             overflow_count_.fetch_add(1);
+            pending_flags |= SampleMetadata::DEVICE_OVERFLOW;
         }
     }
 }
 
+void SimulationDevice::generateSamples(std::complex<float>* buffer, size_t count, double& time) {
+    if (signal_type_ == "multitone") {
+        generateMultitoneSamples(buffer, count, time);
+    } else if (signal_type_ == "noise") {
+        generateNoiseSamples(buffer, count);
+    } else if (signal_type_ == "fm") {
+        generateFMSamples(buffer, count, time);
+    } else if (signal_type_ == "am") {
+        generateAMSamples(buffer, count, time);
+    } else {
+        generateMultitoneSamples(buffer, count, time);
+    }
+}
+
 void SimulationDevice::generateMultitoneSamples(std::complex<float>* buffer, 
                                                 size_t count, double& time) {
     const double dt = 1.0 / sample_rate_;
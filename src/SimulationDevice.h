@@ -22,6 +22,9 @@ public:
     
     // Rx
     bool startReceiving(SampleCallback callback, size_t buffer_size = 4096) override;
+    bool startReceivingBlocks(BlockCallback callback, size_t buffer_size = 4096,
+                              size_t num_blocks = 64) override;
+    bool startReceivingInto(RxBufferProvider* provider, size_t buffer_size = 4096) override;
     void stopReceiving() override;
     bool isReceiving() const override { return receiving_.load(); }
     
@@ -61,10 +64,11 @@ public:
     
 private:
     bool initialized_ = false;
-    double frequency_ = 100e6;
-    double sample_rate_ = 1e6;
-    double gain_ = 20.0;
-    double bandwidth_ = 0.0;
+    // Set from the control thread, read by the generator once per block
+    std::atomic<double> frequency_{100e6};
+    std::atomic<double> sample_rate_{1e6};
+    std::atomic<double> gain_{20.0};
+    std::atomic<double> bandwidth_{0.0};
     std::string antenna_ = "SIM";
     
     std::string signal_type_ = "multitone";
@@ -81,7 +85,10 @@ private:
     std::atomic<bool> stop_signal_{false};
     std::unique_ptr<std::thread> generator_thread_;
     SampleCallback sample_callback_;
+    BlockCallback block_callback_;
+    RxBufferProvider* buffer_provider_ = nullptr;
     size_t buffer_size_ = 4096;
+    ThreadPolicy thread_policy_;
     
     // Statistics
     std::atomic<size_t> total_samples_{0};
@@ -93,7 +100,10 @@ private:
     std::normal_distribution<float> noise_dist_{0.0f, 1.0f};
     
     // Thread
+    bool startWorker(SampleCallback sample_callback, BlockCallback block_callback,
+                     RxBufferProvider* provider, size_t buffer_size);
     void generatorWorker();
+    void generateSamples(std::complex<float>* buffer, size_t count, double& time);
     
     // Signal generation functions
     void generateMultitoneSamples(std::complex<float>* buffer, size_t count, double& time);
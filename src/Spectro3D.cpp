@@ -1,5 +1,6 @@
 #include "Spectro3D.h"
 #include "frame_buffer.hpp"
+#include "Logger.h"
 #include <glad/glad.h>
 #include <iostream>
 #include <algorithm>
@@ -160,14 +161,13 @@ void Spectro3D::resetView() {
 
 void Spectro3D::updateWaterfallData(const float* magnitude_data, int data_length) {
     if (!grid_ || data_length != grid_cols_) {
-        std::cerr << "Data length mismatch: expected " << grid_cols_ 
-                  << ", got " << data_length << std::endl;
+        LOG_ERROR("Data length mismatch: expected {}, got {}", grid_cols_, data_length);
         return;
     }
 
     // Bounds check
     if (grid_z_data_.size() != static_cast<size_t>(grid_rows_ * grid_cols_)) {
-        std::cerr << "Grid data size mismatch!" << std::endl;
+        LOG_ERROR("Grid data size mismatch!");
         return;
     }
 
@@ -179,7 +179,7 @@ void Spectro3D::updateWaterfallData(const float* magnitude_data, int data_length
             min_val = std::min(min_val, magnitude_data[i]);
             max_val = std::max(max_val, magnitude_data[i]);
         }
-        std::cout << "Magnitude data range: [" << min_val << ", " << max_val << "]" << std::endl;
+        LOG_DEBUG("Magnitude data range: [{}, {}]", min_val, max_val);
     }
 
     // More efficient: use memmove to shift all rows at once
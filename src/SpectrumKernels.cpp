@@ -0,0 +1,705 @@
+#include "SpectrumKernels.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define SPECTRUM_KERNELS_X86 1
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SPECTRUM_KERNELS_NEON 1
+#endif
+
+namespace {
+
+// Cephes logf: ln(x) = e ln2 + ln(m), m in [sqrt(1/2), sqrt(2)), minimax polynomial for ln(1 + x)
+constexpr float SQRTHF = 0.707106781186547524f;
+constexpr float LOG_P0 = 7.0376836292e-2f;
+constexpr float LOG_P1 = -1.1514610310e-1f;
+constexpr float LOG_P2 = 1.1676998740e-1f;
+constexpr float LOG_P3 = -1.2420140846e-1f;
+constexpr float LOG_P4 = 1.4249322787e-1f;
+constexpr float LOG_P5 = -1.6668057665e-1f;
+constexpr float LOG_P6 = 2.0000714765e-1f;
+constexpr float LOG_P7 = -2.4999993993e-1f;
+constexpr float LOG_P8 = 3.3333331174e-1f;
+constexpr float LOG_Q1 = -2.12194440e-4f;      // ln2 split in two for precision
+constexpr float LOG_Q2 = 0.693359375f;
+constexpr float DB_PER_NEPER = 4.342944819032518f;     // 10 / ln(10)
+
+float clampedMinPower(const DbScale& db) {
+    return std::max(db.min_power, FLT_MIN);
+}
+
+float finishDb(float db_value, const DbScale& db) {
+    db_value = std::max(db_value + db.offset_db, db.floor_db);
+    return db.display ? 1.0f - db_value / db.floor_db : db_value;
+}
+
+// What the scalar code always did
+float referenceDb(float power) {
+    return 10.0f * log10f(power);
+}
+
+// Same polynomial as the vector kernels, for their tails; power must be normal
+float polynomialDb(float power) {
+    uint32_t bits;
+    std::memcpy(&bits, &power, sizeof(bits));
+    float e = static_cast<float>(static_cast<int32_t>(bits >> 23) - 126);
+    bits = (bits & 0x007fffffu) | 0x3f000000u;     // Mantissa in [0.5, 1)
+    float x;
+    std::memcpy(&x, &bits, sizeof(x));
+    if (x < SQRTHF) {
+        e -= 1.0f;
+        x = x + x - 1.0f;
+    } else {
+        x = x - 1.0f;
+    }
+    float z = x * x;
+    float y = LOG_P0;
+    y = y * x + LOG_P1;
+    y = y * x + LOG_P2;
+    y = y * x + LOG_P3;
+    y = y * x + LOG_P4;
+    y = y * x + LOG_P5;
+    y = y * x + LOG_P6;
+    y = y * x + LOG_P7;
+    y = y * x + LOG_P8;
+    y = y * x * z;
+    y += e * LOG_Q1;
+    y += -0.5f * z;
+    x = x + y + e * LOG_Q2;
+    return x * DB_PER_NEPER;
+}
+
+template<float (*ToDb)(float)>
+void scalarDecibels(const float* in, float* out, size_t n, const DbScale& db) {
+    const float min_power = clampedMinPower(db);
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = finishDb(ToDb(std::max(in[i], min_power)), db);
+    }
+}
+
+void scalarPower(const float* iq, float* out, size_t n, float scale, float min_power) {
+    for (size_t i = 0; i < n; ++i) {
+        float real = iq[2 * i];
+        float imag = iq[2 * i + 1];
+        out[i] = std::max(scale * (real * real + imag * imag), min_power);
+    }
+}
+
+template<float (*ToDb)(float)>
+void scalarPowerDecibels(const float* iq, float* out, size_t n, float scale, const DbScale& db) {
+    const float min_power = clampedMinPower(db);
+    for (size_t i = 0; i < n; ++i) {
+        float real = iq[2 * i];
+        float imag = iq[2 * i + 1];
+        float power = std::max(scale * (real * real + imag * imag), min_power);
+        out[i] = finishDb(ToDb(power), db);
+    }
+}
+
+float scalarPeakPower(const float* iq, size_t n) {
+    float peak = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        float real = iq[2 * i];
+        float imag = iq[2 * i + 1];
+        peak = std::max(peak, real * real + imag * imag);
+    }
+    return peak;
+}
+
+void scalarWindowComplex(const float* iq, const float* window, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[2 * i] = iq[2 * i] * window[i];
+        out[2 * i + 1] = iq[2 * i + 1] * window[i];
+    }
+}
+
+void scalarWindowReal(const float* iq, const float* window, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = iq[2 * i] * window[i];
+    }
+}
+
+const SpectrumKernels SCALAR_KERNELS = {
+    "scalar",
+    scalarPower,
+    scalarDecibels<referenceDb>,
+    scalarPowerDecibels<referenceDb>,
+    scalarPeakPower,
+    scalarWindowComplex,
+    scalarWindowReal,
+};
+
+#if SPECTRUM_KERNELS_X86
+
+/*********************************SSE2*************************************/
+
+// Baseline on x86-64, no target attribute needed
+
+inline __m128 sse2Db(__m128 x) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128i bits = _mm_castps_si128(x);
+    __m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(126)));
+    x = _mm_or_ps(_mm_and_ps(x, _mm_castsi128_ps(_mm_set1_epi32(0x007fffff))), _mm_set1_ps(0.5f));
+    __m128 mask = _mm_cmplt_ps(x, _mm_set1_ps(SQRTHF));
+    __m128 tmp = _mm_and_ps(x, mask);
+    x = _mm_sub_ps(x, one);
+    e = _mm_sub_ps(e, _mm_and_ps(one, mask));
+    x = _mm_add_ps(x, tmp);
+    __m128 z = _mm_mul_ps(x, x);
+    __m128 y = _mm_set1_ps(LOG_P0);
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P1));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P2));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P3));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P4));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P5));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P6));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P7));
+    y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(LOG_P8));
+    y = _mm_mul_ps(_mm_mul_ps(y, x), z);
+    y = _mm_add_ps(y, _mm_mul_ps(e, _mm_set1_ps(LOG_Q1)));
+    y = _mm_sub_ps(y, _mm_mul_ps(z, _mm_set1_ps(0.5f)));
+    x = _mm_add_ps(x, y);
+    x = _mm_add_ps(x, _mm_mul_ps(e, _mm_set1_ps(LOG_Q2)));
+    return _mm_mul_ps(x, _mm_set1_ps(DB_PER_NEPER));
+}
+
+inline __m128 sse2Finish(__m128 db_value, const DbScale& db) {
+    db_value = _mm_max_ps(_mm_add_ps(db_value, _mm_set1_ps(db.offset_db)), _mm_set1_ps(db.floor_db));
+    if (db.display) {
+        db_value = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_div_ps(db_value, _mm_set1_ps(db.floor_db)));
+    }
+    return db_value;
+}
+
+// re^2 + im^2 of 4 interleaved complex values
+inline __m128 sse2Power(const float* iq) {
+    __m128 a = _mm_loadu_ps(iq);
+    __m128 b = _mm_loadu_ps(iq + 4);
+    a = _mm_mul_ps(a, a);
+    b = _mm_mul_ps(b, b);
+    return _mm_add_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)),
+                      _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+}
+
+void sse2PowerKernel(const float* iq, float* out, size_t n, float scale, float min_power) {
+    const __m128 s = _mm_set1_ps(scale);
+    const __m128 lo = _mm_set1_ps(min_power);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(out + i, _mm_max_ps(_mm_mul_ps(sse2Power(iq + 2 * i), s), lo));
+    }
+    scalarPower(iq + 2 * i, out + i, n - i, scale, min_power);
+}
+
+void sse2DecibelsKernel(const float* in, float* out, size_t n, const DbScale& db) {
+    const __m128 lo = _mm_set1_ps(clampedMinPower(db));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 power = _mm_max_ps(_mm_loadu_ps(in + i), lo);
+        _mm_storeu_ps(out + i, sse2Finish(sse2Db(power), db));
+    }
+    scalarDecibels<polynomialDb>(in + i, out + i, n - i, db);
+}
+
+void sse2PowerDecibelsKernel(const float* iq, float* out, size_t n, float scale, const DbScale& db) {
+    const __m128 s = _mm_set1_ps(scale);
+    const __m128 lo = _mm_set1_ps(clampedMinPower(db));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 power = _mm_max_ps(_mm_mul_ps(sse2Power(iq + 2 * i), s), lo);
+        _mm_storeu_ps(out + i, sse2Finish(sse2Db(power), db));
+    }
+    scalarPowerDecibels<polynomialDb>(iq + 2 * i, out + i, n - i, scale, db);
+}
+
+float sse2PeakPowerKernel(const float* iq, size_t n) {
+    __m128 peak = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        peak = _mm_max_ps(peak, sse2Power(iq + 2 * i));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, peak);
+    float result = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    return std::max(result, scalarPeakPower(iq + 2 * i, n - i));
+}
+
+void sse2WindowComplexKernel(const float* iq, const float* window, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 w = _mm_loadu_ps(window + i);
+        _mm_storeu_ps(out + 2 * i, _mm_mul_ps(_mm_loadu_ps(iq + 2 * i), _mm_unpacklo_ps(w, w)));
+        _mm_storeu_ps(out + 2 * i + 4, _mm_mul_ps(_mm_loadu_ps(iq + 2 * i + 4), _mm_unpackhi_ps(w, w)));
+    }
+    scalarWindowComplex(iq + 2 * i, window + i, out + 2 * i, n - i);
+}
+
+void sse2WindowRealKernel(const float* iq, const float* window, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 re = _mm_shuffle_ps(_mm_loadu_ps(iq + 2 * i), _mm_loadu_ps(iq + 2 * i + 4),
+                                   _MM_SHUFFLE(2, 0, 2, 0));
+        _mm_storeu_ps(out + i, _mm_mul_ps(re, _mm_loadu_ps(window + i)));
+    }
+    scalarWindowReal(iq + 2 * i, window + i, out + i, n - i);
+}
+
+const SpectrumKernels SSE2_KERNELS = {
+    "sse2",
+    sse2PowerKernel,
+    sse2DecibelsKernel,
+    sse2PowerDecibelsKernel,
+    sse2PeakPowerKernel,
+    sse2WindowComplexKernel,
+    sse2WindowRealKernel,
+};
+
+/*********************************AVX2*************************************/
+
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+
+AVX2_TARGET inline __m256 avx2Db(__m256 x) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    __m256i bits = _mm256_castps_si256(x);
+    __m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23),
+                                                   _mm256_set1_epi32(126)));
+    x = _mm256_or_ps(_mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x007fffff))),
+                     _mm256_set1_ps(0.5f));
+    __m256 mask = _mm256_cmp_ps(x, _mm256_set1_ps(SQRTHF), _CMP_LT_OQ);
+    __m256 tmp = _mm256_and_ps(x, mask);
+    x = _mm256_sub_ps(x, one);
+    e = _mm256_sub_ps(e, _mm256_and_ps(one, mask));
+    x = _mm256_add_ps(x, tmp);
+    __m256 z = _mm256_mul_ps(x, x);
+    __m256 y = _mm256_set1_ps(LOG_P0);
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(LOG_P1));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(LOG_P2));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(LOG_P3));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(LOG_P4));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(LOG_P5));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(LOG_P6));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(LOG_P7));
+    y = _mm256_fmadd_ps(y, x, _mm256_set1_ps(LOG_P8));
+    y = _mm256_mul_ps(_mm256_mul_ps(y, x), z);
+    y = _mm256_fmadd_ps(e, _mm256_set1_ps(LOG_Q1), y);
+    y = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), y);
+    x = _mm256_add_ps(x, y);
+    x = _mm256_fmadd_ps(e, _mm256_set1_ps(LOG_Q2), x);
+    return _mm256_mul_ps(x, _mm256_set1_ps(DB_PER_NEPER));
+}
+
+AVX2_TARGET inline __m256 avx2Finish(__m256 db_value, const DbScale& db) {
+    db_value = _mm256_max_ps(_mm256_add_ps(db_value, _mm256_set1_ps(db.offset_db)),
+                             _mm256_set1_ps(db.floor_db));
+    if (db.display) {
+        db_value = _mm256_sub_ps(_mm256_set1_ps(1.0f),
+                                 _mm256_div_ps(db_value, _mm256_set1_ps(db.floor_db)));
+    }
+    return db_value;
+}
+
+// re^2 + im^2 of 8 interleaved complex values
+AVX2_TARGET inline __m256 avx2Power(const float* iq) {
+    __m256 a = _mm256_loadu_ps(iq);
+    __m256 b = _mm256_loadu_ps(iq + 8);
+    a = _mm256_mul_ps(a, a);
+    b = _mm256_mul_ps(b, b);
+    // Per 128-bit lane: p0 p1 p4 p5 | p2 p3 p6 p7, then put the pairs in order
+    __m256 sum = _mm256_add_ps(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)),
+                               _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    return _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(sum), _MM_SHUFFLE(3, 1, 2, 0)));
+}
+
+AVX2_TARGET void avx2PowerKernel(const float* iq, float* out, size_t n, float scale, float min_power) {
+    const __m256 s = _mm256_set1_ps(scale);
+    const __m256 lo = _mm256_set1_ps(min_power);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_max_ps(_mm256_mul_ps(avx2Power(iq + 2 * i), s), lo));
+    }
+    scalarPower(iq + 2 * i, out + i, n - i, scale, min_power);
+}
+
+AVX2_TARGET void avx2DecibelsKernel(const float* in, float* out, size_t n, const DbScale& db) {
+    const __m256 lo = _mm256_set1_ps(clampedMinPower(db));
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 power = _mm256_max_ps(_mm256_loadu_ps(in + i), lo);
+        _mm256_storeu_ps(out + i, avx2Finish(avx2Db(power), db));
+    }
+    scalarDecibels<polynomialDb>(in + i, out + i, n - i, db);
+}
+
+AVX2_TARGET void avx2PowerDecibelsKernel(const float* iq, float* out, size_t n, float scale,
+                                         const DbScale& db) {
+    const __m256 s = _mm256_set1_ps(scale);
+    const __m256 lo = _mm256_set1_ps(clampedMinPower(db));
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 power = _mm256_max_ps(_mm256_mul_ps(avx2Power(iq + 2 * i), s), lo);
+        _mm256_storeu_ps(out + i, avx2Finish(avx2Db(power), db));
+    }
+    scalarPowerDecibels<polynomialDb>(iq + 2 * i, out + i, n - i, scale, db);
+}
+
+AVX2_TARGET float avx2PeakPowerKernel(const float* iq, size_t n) {
+    __m256 peak = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        peak = _mm256_max_ps(peak, avx2Power(iq + 2 * i));
+    }
+    __m128 half = _mm_max_ps(_mm256_castps256_ps128(peak), _mm256_extractf128_ps(peak, 1));
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, half);
+    float result = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    return std::max(result, scalarPeakPower(iq + 2 * i, n - i));
+}
+
+AVX2_TARGET void avx2WindowComplexKernel(const float* iq, const float* window, float* out, size_t n) {
+    const __m256i low = _mm256_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3);
+    const __m256i high = _mm256_setr_epi32(4, 4, 5, 5, 6, 6, 7, 7);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 w = _mm256_loadu_ps(window + i);
+        _mm256_storeu_ps(out + 2 * i, _mm256_mul_ps(_mm256_loadu_ps(iq + 2 * i),
+                                                    _mm256_permutevar8x32_ps(w, low)));
+        _mm256_storeu_ps(out + 2 * i + 8, _mm256_mul_ps(_mm256_loadu_ps(iq + 2 * i + 8),
+                                                        _mm256_permutevar8x32_ps(w, high)));
+    }
+    scalarWindowComplex(iq + 2 * i, window + i, out + 2 * i, n - i);
+}
+
+AVX2_TARGET void avx2WindowRealKernel(const float* iq, const float* window, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        // Same lane fix-up as avx2Power
+        __m256 re = _mm256_shuffle_ps(_mm256_loadu_ps(iq + 2 * i), _mm256_loadu_ps(iq + 2 * i + 8),
+                                      _MM_SHUFFLE(2, 0, 2, 0));
+        re = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(re), _MM_SHUFFLE(3, 1, 2, 0)));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(re, _mm256_loadu_ps(window + i)));
+    }
+    scalarWindowReal(iq + 2 * i, window + i, out + i, n - i);
+}
+
+const SpectrumKernels AVX2_KERNELS = {
+    "avx2",
+    avx2PowerKernel,
+    avx2DecibelsKernel,
+    avx2PowerDecibelsKernel,
+    avx2PeakPowerKernel,
+    avx2WindowComplexKernel,
+    avx2WindowRealKernel,
+};
+
+/********************************AVX-512***********************************/
+
+#define AVX512_TARGET __attribute__((target("avx512f")))
+
+// GCC 12's unmasked forms of these merge into _mm512_undefined_*(), which
+// -Wuninitialized flags once inlined. An all-lanes zero-masked call is the
+// same instruction with a defined source.
+constexpr __mmask16 ALL_LANES = 0xffff;
+
+AVX512_TARGET inline __m512 avx512Max(__m512 a, __m512 b) {
+    return _mm512_maskz_max_ps(ALL_LANES, a, b);
+}
+
+AVX512_TARGET inline __m512 avx512Permute(__m512i index, __m512 x) {
+    return _mm512_maskz_permutexvar_ps(ALL_LANES, index, x);
+}
+
+AVX512_TARGET inline __m512 avx512Db(__m512 x) {
+    const __m512 one = _mm512_set1_ps(1.0f);
+    __m512i bits = _mm512_castps_si512(x);
+    __m512 e = _mm512_maskz_cvtepi32_ps(
+        ALL_LANES, _mm512_sub_epi32(_mm512_maskz_srli_epi32(ALL_LANES, bits, 23),
+                                    _mm512_set1_epi32(126)));
+    // Integer and/or: the float forms need AVX-512DQ
+    bits = _mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi32(0x007fffff)),
+                           _mm512_set1_epi32(0x3f000000));
+    x = _mm512_castsi512_ps(bits);
+    __mmask16 mask = _mm512_cmp_ps_mask(x, _mm512_set1_ps(SQRTHF), _CMP_LT_OQ);
+    __m512 tmp = _mm512_mask_blend_ps(mask, _mm512_setzero_ps(), x);
+    x = _mm512_sub_ps(x, one);
+    e = _mm512_mask_sub_ps(e, mask, e, one);
+    x = _mm512_add_ps(x, tmp);
+    __m512 z = _mm512_mul_ps(x, x);
+    __m512 y = _mm512_set1_ps(LOG_P0);
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(LOG_P1));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(LOG_P2));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(LOG_P3));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(LOG_P4));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(LOG_P5));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(LOG_P6));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(LOG_P7));
+    y = _mm512_fmadd_ps(y, x, _mm512_set1_ps(LOG_P8));
+    y = _mm512_mul_ps(_mm512_mul_ps(y, x), z);
+    y = _mm512_fmadd_ps(e, _mm512_set1_ps(LOG_Q1), y);
+    y = _mm512_fnmadd_ps(z, _mm512_set1_ps(0.5f), y);
+    x = _mm512_add_ps(x, y);
+    x = _mm512_fmadd_ps(e, _mm512_set1_ps(LOG_Q2), x);
+    return _mm512_mul_ps(x, _mm512_set1_ps(DB_PER_NEPER));
+}
+
+AVX512_TARGET inline __m512 avx512Finish(__m512 db_value, const DbScale& db) {
+    db_value = avx512Max(_mm512_add_ps(db_value, _mm512_set1_ps(db.offset_db)),
+                         _mm512_set1_ps(db.floor_db));
+    if (db.display) {
+        db_value = _mm512_sub_ps(_mm512_set1_ps(1.0f),
+                                 _mm512_div_ps(db_value, _mm512_set1_ps(db.floor_db)));
+    }
+    return db_value;
+}
+
+// re^2 + im^2 of 16 interleaved complex values
+AVX512_TARGET inline __m512 avx512Power(const float* iq) {
+    const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14,
+                                           16, 18, 20, 22, 24, 26, 28, 30);
+    const __m512i odd = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15,
+                                          17, 19, 21, 23, 25, 27, 29, 31);
+    __m512 a = _mm512_loadu_ps(iq);
+    __m512 b = _mm512_loadu_ps(iq + 16);
+    __m512 re = _mm512_permutex2var_ps(a, even, b);
+    __m512 im = _mm512_permutex2var_ps(a, odd, b);
+    // No FMA: rounds like the scalar re * re + im * im
+    return _mm512_add_ps(_mm512_mul_ps(re, re), _mm512_mul_ps(im, im));
+}
+
+AVX512_TARGET void avx512PowerKernel(const float* iq, float* out, size_t n, float scale,
+                                     float min_power) {
+    const __m512 s = _mm512_set1_ps(scale);
+    const __m512 lo = _mm512_set1_ps(min_power);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_ps(out + i, avx512Max(_mm512_mul_ps(avx512Power(iq + 2 * i), s), lo));
+    }
+    scalarPower(iq + 2 * i, out + i, n - i, scale, min_power);
+}
+
+AVX512_TARGET void avx512DecibelsKernel(const float* in, float* out, size_t n, const DbScale& db) {
+    const __m512 lo = _mm512_set1_ps(clampedMinPower(db));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 power = avx512Max(_mm512_loadu_ps(in + i), lo);
+        _mm512_storeu_ps(out + i, avx512Finish(avx512Db(power), db));
+    }
+    scalarDecibels<polynomialDb>(in + i, out + i, n - i, db);
+}
+
+AVX512_TARGET void avx512PowerDecibelsKernel(const float* iq, float* out, size_t n, float scale,
+                                             const DbScale& db) {
+    const __m512 s = _mm512_set1_ps(scale);
+    const __m512 lo = _mm512_set1_ps(clampedMinPower(db));
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 power = avx512Max(_mm512_mul_ps(avx512Power(iq + 2 * i), s), lo);
+        _mm512_storeu_ps(out + i, avx512Finish(avx512Db(power), db));
+    }
+    scalarPowerDecibels<polynomialDb>(iq + 2 * i, out + i, n - i, scale, db);
+}
+
+AVX512_TARGET float avx512PeakPowerKernel(const float* iq, size_t n) {
+    __m512 peak = _mm512_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        peak = avx512Max(peak, avx512Power(iq + 2 * i));
+    }
+    // Spilled rather than _mm512_reduce_max_ps, whose 256-bit extract has the same problem
+    alignas(64) float lanes[16];
+    _mm512_store_ps(lanes, peak);
+    return std::max(*std::max_element(lanes, lanes + 16), scalarPeakPower(iq + 2 * i, n - i));
+}
+
+AVX512_TARGET void avx512WindowComplexKernel(const float* iq, const float* window, float* out,
+                                             size_t n) {
+    const __m512i low = _mm512_setr_epi32(0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7);
+    const __m512i high = _mm512_setr_epi32(8, 8, 9, 9, 10, 10, 11, 11,
+                                           12, 12, 13, 13, 14, 14, 15, 15);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 w = _mm512_loadu_ps(window + i);
+        _mm512_storeu_ps(out + 2 * i, _mm512_mul_ps(_mm512_loadu_ps(iq + 2 * i),
+                                                    avx512Permute(low, w)));
+        _mm512_storeu_ps(out + 2 * i + 16, _mm512_mul_ps(_mm512_loadu_ps(iq + 2 * i + 16),
+                                                         avx512Permute(high, w)));
+    }
+    scalarWindowComplex(iq + 2 * i, window + i, out + 2 * i, n - i);
+}
+
+AVX512_TARGET void avx512WindowRealKernel(const float* iq, const float* window, float* out, size_t n) {
+    const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14,
+                                           16, 18, 20, 22, 24, 26, 28, 30);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512 re = _mm512_permutex2var_ps(_mm512_loadu_ps(iq + 2 * i), even,
+                                           _mm512_loadu_ps(iq + 2 * i + 16));
+        _mm512_storeu_ps(out + i, _mm512_mul_ps(re, _mm512_loadu_ps(window + i)));
+    }
+    scalarWindowReal(iq + 2 * i, window + i, out + i, n - i);
+}
+
+const SpectrumKernels AVX512_KERNELS = {
+    "avx512",
+    avx512PowerKernel,
+    avx512DecibelsKernel,
+    avx512PowerDecibelsKernel,
+    avx512PeakPowerKernel,
+    avx512WindowComplexKernel,
+    avx512WindowRealKernel,
+};
+
+#endif  // SPECTRUM_KERNELS_X86
+
+#if SPECTRUM_KERNELS_NEON
+
+/*********************************NEON*************************************/
+
+// Baseline on AArch64
+
+inline float32x4_t neonDb(float32x4_t x) {
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    uint32x4_t bits = vreinterpretq_u32_f32(x);
+    float32x4_t e = vcvtq_f32_s32(vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)),
+                                            vdupq_n_s32(126)));
+    bits = vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x007fffff)), vdupq_n_u32(0x3f000000));
+    x = vreinterpretq_f32_u32(bits);
+    uint32x4_t mask = vcltq_f32(x, vdupq_n_f32(SQRTHF));
+    float32x4_t tmp = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(x), mask));
+    x = vsubq_f32(x, one);
+    e = vsubq_f32(e, vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(one), mask)));
+    x = vaddq_f32(x, tmp);
+    float32x4_t z = vmulq_f32(x, x);
+    float32x4_t y = vdupq_n_f32(LOG_P0);
+    y = vfmaq_f32(vdupq_n_f32(LOG_P1), y, x);
+    y = vfmaq_f32(vdupq_n_f32(LOG_P2), y, x);
+    y = vfmaq_f32(vdupq_n_f32(LOG_P3), y, x);
+    y = vfmaq_f32(vdupq_n_f32(LOG_P4), y, x);
+    y = vfmaq_f32(vdupq_n_f32(LOG_P5), y, x);
+    y = vfmaq_f32(vdupq_n_f32(LOG_P6), y, x);
+    y = vfmaq_f32(vdupq_n_f32(LOG_P7), y, x);
+    y = vfmaq_f32(vdupq_n_f32(LOG_P8), y, x);
+    y = vmulq_f32(vmulq_f32(y, x), z);
+    y = vfmaq_f32(y, e, vdupq_n_f32(LOG_Q1));
+    y = vfmsq_f32(y, z, vdupq_n_f32(0.5f));
+    x = vaddq_f32(x, y);
+    x = vfmaq_f32(x, e, vdupq_n_f32(LOG_Q2));
+    return vmulq_f32(x, vdupq_n_f32(DB_PER_NEPER));
+}
+
+inline float32x4_t neonFinish(float32x4_t db_value, const DbScale& db) {
+    db_value = vmaxq_f32(vaddq_f32(db_value, vdupq_n_f32(db.offset_db)), vdupq_n_f32(db.floor_db));
+    if (db.display) {
+        db_value = vsubq_f32(vdupq_n_f32(1.0f), vdivq_f32(db_value, vdupq_n_f32(db.floor_db)));
+    }
+    return db_value;
+}
+
+// re^2 + im^2 of 4 interleaved complex values; vld2 deinterleaves
+inline float32x4_t neonPower(const float* iq) {
+    float32x4x2_t v = vld2q_f32(iq);
+    // No FMA: rounds like the scalar re * re + im * im
+    return vaddq_f32(vmulq_f32(v.val[0], v.val[0]), vmulq_f32(v.val[1], v.val[1]));
+}
+
+void neonPowerKernel(const float* iq, float* out, size_t n, float scale, float min_power) {
+    const float32x4_t s = vdupq_n_f32(scale);
+    const float32x4_t lo = vdupq_n_f32(min_power);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(out + i, vmaxq_f32(vmulq_f32(neonPower(iq + 2 * i), s), lo));
+    }
+    scalarPower(iq + 2 * i, out + i, n - i, scale, min_power);
+}
+
+void neonDecibelsKernel(const float* in, float* out, size_t n, const DbScale& db) {
+    const float32x4_t lo = vdupq_n_f32(clampedMinPower(db));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t power = vmaxq_f32(vld1q_f32(in + i), lo);
+        vst1q_f32(out + i, neonFinish(neonDb(power), db));
+    }
+    scalarDecibels<polynomialDb>(in + i, out + i, n - i, db);
+}
+
+void neonPowerDecibelsKernel(const float* iq, float* out, size_t n, float scale, const DbScale& db) {
+    const float32x4_t s = vdupq_n_f32(scale);
+    const float32x4_t lo = vdupq_n_f32(clampedMinPower(db));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t power = vmaxq_f32(vmulq_f32(neonPower(iq + 2 * i), s), lo);
+        vst1q_f32(out + i, neonFinish(neonDb(power), db));
+    }
+    scalarPowerDecibels<polynomialDb>(iq + 2 * i, out + i, n - i, scale, db);
+}
+
+float neonPeakPowerKernel(const float* iq, size_t n) {
+    float32x4_t peak = vdupq_n_f32(0.0f);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        peak = vmaxq_f32(peak, neonPower(iq + 2 * i));
+    }
+    return std::max(vmaxvq_f32(peak), scalarPeakPower(iq + 2 * i, n - i));
+}
+
+void neonWindowComplexKernel(const float* iq, const float* window, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t w = vld1q_f32(window + i);
+        float32x4x2_t v = vld2q_f32(iq + 2 * i);
+        v.val[0] = vmulq_f32(v.val[0], w);
+        v.val[1] = vmulq_f32(v.val[1], w);
+        vst2q_f32(out + 2 * i, v);
+    }
+    scalarWindowComplex(iq + 2 * i, window + i, out + 2 * i, n - i);
+}
+
+void neonWindowRealKernel(const float* iq, const float* window, float* out, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(out + i, vmulq_f32(vld2q_f32(iq + 2 * i).val[0], vld1q_f32(window + i)));
+    }
+    scalarWindowReal(iq + 2 * i, window + i, out + i, n - i);
+}
+
+const SpectrumKernels NEON_KERNELS = {
+    "neon",
+    neonPowerKernel,
+    neonDecibelsKernel,
+    neonPowerDecibelsKernel,
+    neonPeakPowerKernel,
+    neonWindowComplexKernel,
+    neonWindowRealKernel,
+};
+
+#endif  // SPECTRUM_KERNELS_NEON
+
+}
+
+std::vector<const SpectrumKernels*> availableSpectrumKernels() {
+    std::vector<const SpectrumKernels*> sets = {&SCALAR_KERNELS};
+#if SPECTRUM_KERNELS_X86
+    __builtin_cpu_init();
+    sets.push_back(&SSE2_KERNELS);
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        sets.push_back(&AVX2_KERNELS);
+    }
+    // Checks OS support (XCR0) too, not just the CPUID bit
+    if (__builtin_cpu_supports("avx512f")) {
+        sets.push_back(&AVX512_KERNELS);
+    }
+#elif SPECTRUM_KERNELS_NEON
+    sets.push_back(&NEON_KERNELS);
+#endif
+    return sets;
+}
+
+const SpectrumKernels& spectrumKernels() {
+    static const SpectrumKernels* best = availableSpectrumKernels().back();
+    return *best;
+}
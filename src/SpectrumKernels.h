@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * How power becomes dB for display:
+ * dB = max(10 log10(max(power, min_power)) + offset_db, floor_db), then
+ * 1 - dB / floor_db if display (0 at the floor, 1 at 0 dB)
+ */
+struct DbScale {
+    float min_power = 1e-20f;   // Keeps log10 finite; never below FLT_MIN
+    float offset_db = 0.0f;
+    float floor_db = -80.0f;    // Negative; -FLT_MAX for no clamp
+    bool display = false;
+};
+
+/**
+ * Vectorized spectrum conversion kernels, one set per instruction set
+ *
+ * Complex input is interleaved real/imag, as PFFFT produces it. Output may
+ * alias input for decibels(). The vector kernels replace log10f with a
+ * polynomial log (Cephes logf) that stays within MAX_DB_ERROR of it over
+ * all normal floats, so results differ from the scalar set only in the
+ * last few ulps of the dB value. Power (re*re + im*im, no FMA) and the
+ * window kernels are plain arithmetic and match the scalar set exactly.
+ */
+struct SpectrumKernels {
+    static constexpr float MAX_DB_ERROR = 1e-4f;
+
+    const char* name;
+
+    // out[i] = max(scale * (re^2 + im^2), min_power)
+    void (*power)(const float* iq, float* out, size_t n, float scale, float min_power);
+
+    // out[i] = dB of in[i], see DbScale
+    void (*decibels)(const float* in, float* out, size_t n, const DbScale& db);
+
+    // power() and decibels() in one pass, power never stored
+    void (*powerDecibels)(const float* iq, float* out, size_t n, float scale, const DbScale& db);
+
+    // Largest re^2 + im^2, 0 if n is 0
+    float (*peakPower)(const float* iq, size_t n);
+
+    // Framing: out[2i], out[2i+1] = re * window[i], im * window[i]
+    void (*windowComplex)(const float* iq, const float* window, float* out, size_t n);
+
+    // Framing, real part only: out[i] = re * window[i]
+    void (*windowReal)(const float* iq, const float* window, float* out, size_t n);
+};
+
+/**
+ * Best set this CPU supports, picked by CPUID on first use: AVX-512, AVX2
+ * with FMA, SSE2 on x86; NEON on ARM; scalar otherwise
+ */
+const SpectrumKernels& spectrumKernels();
+
+// Every set this CPU can run, scalar reference first
+std::vector<const SpectrumKernels*> availableSpectrumKernels();
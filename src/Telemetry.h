@@ -0,0 +1,83 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "BufferStats.h"
+#include "SampleMetadata.h"
+#include "Seqlock.h"
+
+/**
+ * Device state and RX counters as one consistent snapshot
+ * Published by the device (setters, RX thread) through a Seqlock, read by
+ * anything that displays or exports it without locks or allocation
+ */
+struct DeviceTelemetry {
+    bool initialized = false;
+    bool receiving = false;
+
+    // Current tuning
+    double frequency = 0.0;
+    double sample_rate = 0.0;
+    double gain = 0.0;
+    double bandwidth = 0.0;
+
+    // RX since the last start
+    uint64_t samples_received = 0;
+    uint64_t blocks_received = 0;
+    uint64_t overflows = 0;
+    int64_t start_ns = 0;           // monotonicTimeNs() when reception started
+    int64_t last_block_ns = 0;      // Capture time of the newest block
+
+    // Samples per second actually delivered since the start
+    double measuredRate(int64_t now_ns) const {
+        double seconds = (now_ns - start_ns) * 1e-9;
+        return (receiving && seconds > 0.0) ? samples_received / seconds : 0.0;
+    }
+
+    // Delivered vs expected at the configured rate, in percent
+    double receptionRate(int64_t now_ns) const {
+        return sample_rate > 0.0 ? 100.0 * measuredRate(now_ns) / sample_rate : 0.0;
+    }
+};
+
+/**
+ * Load and timing of one processing stage (analyzer, STFT, display copy...)
+ */
+struct StageTelemetry {
+    uint64_t runs = 0;
+    uint64_t items = 0;             // Samples or frames processed
+    int64_t last_ns = 0;            // Duration of the newest run
+    int64_t avg_ns = 0;             // Moving average, ~16 runs
+    int64_t max_ns = 0;
+    int64_t total_ns = 0;           // Sum over all runs, i.e. time the stage kept its thread busy
+    int64_t cpu_ns = 0;             // Thread CPU time over all runs, if measured
+    BufferStats input;              // Stage's input buffer as of the newest run
+};
+
+/**
+ * Producer side of a StageTelemetry block, owned by the stage's thread
+ * One seqlock write per run, readers take snapshot() from any thread
+ */
+class StageProbe {
+public:
+    void record(int64_t elapsed_ns, uint64_t items, const BufferStats& input = BufferStats(),
+                int64_t cpu_ns = 0) {
+        telemetry_.Update([&](StageTelemetry& t) {
+            t.cpu_ns += cpu_ns;
+            t.avg_ns = t.runs ? t.avg_ns + (elapsed_ns - t.avg_ns) / 16 : elapsed_ns;
+            t.runs++;
+            t.items += items;
+            t.last_ns = elapsed_ns;
+            t.max_ns = std::max(t.max_ns, elapsed_ns);
+            t.total_ns += elapsed_ns;
+            t.input = input;
+        });
+    }
+
+    StageTelemetry snapshot() const { return telemetry_.Load(); }
+    void reset() { telemetry_.Store(StageTelemetry()); }
+
+private:
+    Seqlock<StageTelemetry> telemetry_;
+};
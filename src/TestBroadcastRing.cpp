@@ -0,0 +1,216 @@
+#include "BroadcastRing.h"
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <vector>
+#include <complex>
+
+using namespace std;
+
+void IndependentReaders() {
+	cout << "IndependentReaders" << endl;
+
+	BroadcastRing<int> ring(16);
+	auto fast = ring.MakeReader();
+	auto slow = ring.MakeReader();
+
+	int block[4] = {1, 2, 3, 4};
+	ring.PushBulk(block, 4);
+
+	int out[8];
+	assert(fast.Read(out, 8) == 4);
+	assert(out[0] == 1 && out[3] == 4);
+	assert(fast.Lag() == 0);
+	assert(slow.Lag() == 4);
+	assert(slow.Available() == 4);
+
+	// Both see the same memory
+	auto view = slow.Peek(2);
+	assert(view.Size() == 2);
+	assert(view[0] == 1 && view[1] == 2);
+	assert(slow.Consume(2));
+	assert(slow.Lag() == 2);
+	cout << "   PASSED" << endl;
+}
+
+void SlowReaderOverrun() {
+	cout << "SlowReaderOverrun" << endl;
+
+	BroadcastRing<int> ring(8);
+	auto reader = ring.MakeReader();
+	for (int i = 0; i < 20; ++i) {
+		ring.PushBulk(&i, 1);
+	}
+	assert(reader.Lag() == 20);
+	assert(reader.Available() == 8);
+
+	int out[8];
+	assert(reader.Read(out, 8) == 8);
+	assert(out[0] == 12 && out[7] == 19);
+	assert(reader.Overruns() == 12);
+	cout << "   PASSED" << endl;
+}
+
+void LateReader() {
+	cout << "LateReader" << endl;
+
+	BroadcastRing<int> ring(8);
+	int block[3] = {7, 8, 9};
+	ring.PushBulk(block, 3);
+
+	// Starts at the write position but can still look back
+	auto reader = ring.MakeReader();
+	assert(reader.Available() == 0);
+	int out[4];
+	reader.CopyLatest(out, 4);
+	assert(out[0] == 7 && out[2] == 9 && out[3] == 0);
+	cout << "   PASSED" << endl;
+}
+
+void MirroredWrap() {
+	cout << "MirroredWrap" << endl;
+
+	// One page of ints can be mirrored, a handful cannot
+	BroadcastRing<int> ring(1024);
+	BroadcastRing<int> flat(8);
+	assert(!flat.IsMirrored());
+	if (!ring.IsMirrored()) {
+		cout << "   SKIPPED (double mapping unavailable)" << endl;
+		return;
+	}
+
+	auto reader = ring.MakeReader();
+	std::vector<int> block(1000);
+	for (int i = 0; i < 1000; ++i) block[i] = i;
+	ring.PushBulk(block.data(), block.size());
+	ring.PushBulk(block.data(), block.size());	// Wraps the ring
+
+	// A window straddling the wrap is still one chunk
+	auto view = reader.PeekLatest(600);
+	assert(view.Contiguous() && view.Size() == 600);
+	for (int i = 0; i < 600; ++i) {
+		assert(view.first[i] == 400 + i);
+	}
+	assert(reader.Intact(view));
+
+	// Overwriting the window invalidates it
+	ring.PushBulk(block.data(), 800);
+	assert(!reader.Intact(view));
+
+	// Flat fallback splits at the wrap and gives the same samples
+	int items[12];
+	for (int i = 0; i < 12; ++i) items[i] = i;
+	flat.PushBulk(items, 5);
+	flat.PushBulk(items + 5, 7);
+	auto split = flat.MakeReader().PeekLatest(6);
+	assert(!split.Contiguous() && split.Size() == 6);
+	for (int i = 0; i < 6; ++i) {
+		assert(split[i] == 6 + i);
+	}
+	cout << "   PASSED" << endl;
+}
+
+void HugePageRing() {
+	cout << "HugePageRing" << endl;
+
+	// 8 MB of complex samples, large enough for 2M pages
+	BroadcastRing<std::complex<float>> ring(1 << 20, MemoryPolicy::largeBuffer());
+	auto reader = ring.MakeReader();
+	std::vector<std::complex<float>> block(4096);
+	for (int i = 0; i < 300; ++i) {
+		block[0] = std::complex<float>(float(i), 0.0f);
+		ring.PushBulk(block.data(), block.size());
+	}
+	auto view = reader.PeekLatest(4096);
+	assert(view.Size() == 4096 && view[0].real() == 299.0f);
+	cout << "   PASSED (" << (ring.IsMirrored() ? "mirrored" : "flat") << ")" << endl;
+}
+
+void ReserveCommit() {
+	cout << "ReserveCommit" << endl;
+
+	BroadcastRing<int> ring(8);
+	auto reader = ring.MakeReader();
+
+	// Partial commit publishes only what was written
+	auto span = ring.Reserve(6);
+	assert(span.size == 6);
+	for (int i = 0; i < 4; ++i) span.data[i] = i;
+	ring.Commit(4);
+	assert(ring.TotalWritten() == 4 && reader.Available() == 4);
+
+	// Flat ring stops the span at the wrap
+	if (!ring.IsMirrored()) {
+		span = ring.Reserve(6);
+		assert(span.size == 4);
+		for (size_t i = 0; i < span.size; ++i) span.data[i] = 10 + int(i);
+		ring.Commit(span.size);
+	}
+	int out[8];
+	size_t n = reader.Read(out, 8);
+	assert(n == 8 && out[0] == 0 && out[3] == 3 && out[4] == 10 && out[7] == 13);
+	cout << "   PASSED" << endl;
+}
+
+void Concurrent() {
+	cout << "Concurrent" << endl;
+
+	// The producer waits for both readers except on every 16th block, so
+	// each reader gets most of the stream and overruns still race reads
+	BroadcastRing<size_t> ring(4096);
+	const size_t total = 1 << 20;
+	auto a = ring.MakeReader();
+	auto b = ring.MakeReader();
+	size_t seen_a = 0;
+	size_t seen_b = 0;
+
+	auto consume = [total](BroadcastRing<size_t>::Reader& reader, size_t chunk, size_t& seen) {
+		std::vector<size_t> out(chunk);
+		size_t expected = 0;
+		while (expected < total) {
+			size_t n = reader.Read(out.data(), out.size());
+			for (size_t i = 0; i < n; ++i) {
+				assert(out[i] >= expected);
+				expected = out[i] + 1;
+				++seen;
+			}
+		}
+		assert(seen + reader.Overruns() == total);
+	};
+	std::thread ta(consume, std::ref(a), 64, std::ref(seen_a));
+	std::thread tb(consume, std::ref(b), 1024, std::ref(seen_b));
+
+	std::vector<size_t> block(500);
+	size_t next = 0;
+	for (size_t blocks = 0; next < total; ++blocks) {
+		size_t n = std::min(block.size(), total - next);
+		for (size_t i = 0; i < n; ++i) block[i] = next++;
+		while (blocks % 16 != 0 && std::max(a.Lag(), b.Lag()) + n > ring.Capacity()) {
+			std::this_thread::yield();
+		}
+		ring.PushBulk(block.data(), n);
+	}
+	ta.join();
+	tb.join();
+	assert(seen_a >= total / 2 && seen_b >= total / 2);
+	cout << "   PASSED (" << seen_a << "/" << seen_b << " seen, "
+	     << a.Overruns() << "/" << b.Overruns() << " overrun)" << endl;
+}
+
+int main() {
+	cout << "=== BroadcastRing Test ===" << endl;
+	try {
+		IndependentReaders();
+		SlowReaderOverrun();
+		LateReader();
+		MirroredWrap();
+		HugePageRing();
+		ReserveCommit();
+		Concurrent();
+		cout << "\n=== ALL TESTS PASSED ===" << endl;
+		return 0;
+	} catch (const std::exception& e) {
+		cerr << "Test failed: " << e.what() << endl;
+		return -1;
+	}
+}
@@ -0,0 +1,174 @@
+#include "BudgetGovernor.h"
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+
+using namespace std;
+
+const int64_t SECOND_NS = 1000000000LL;
+
+// Feeds the governor evaluations half a second apart at a given load
+struct Feed {
+	BudgetGovernor& governor;
+	BudgetSample sample;
+
+	explicit Feed(BudgetGovernor& g) : governor(g) {
+		sample.time_ns = SECOND_NS;
+		governor.evaluate(sample);		// Baseline
+	}
+
+	// thread_load: busiest thread's share of a core; frame_ms: render frame time
+	bool step(double thread_load, double frame_ms = 5.0, uint64_t lost = 0) {
+		int64_t interval = SECOND_NS / 2;
+		sample.time_ns += interval;
+		sample.busy_ns[1] += static_cast<int64_t>(thread_load * interval);
+		sample.frame_ns = static_cast<int64_t>(frame_ms * 1e6);
+		sample.lost_samples += lost;
+		return governor.evaluate(sample);
+	}
+};
+
+void LadderOrder() {
+	cout << "LadderOrder" << endl;
+
+	// Quality goes before whole views, and views go lowest priority first
+	const auto& levels = BudgetGovernor::levels();
+	assert(levels.front().display_decimation == 1 && levels.front().stft_overlap_percent == 50);
+	assert(levels.front().fft_size_shift == 0);
+	assert(levels.front().show_3d && levels.front().run_stft && levels.front().show_time);
+	int shed_3d = -1, shed_stft = -1, shed_time = -1;
+	for (size_t i = 1; i < levels.size(); ++i) {
+		// Never gives anything back on the way down
+		assert(levels[i].display_decimation >= levels[i - 1].display_decimation);
+		assert(levels[i].stft_overlap_percent <= levels[i - 1].stft_overlap_percent);
+		assert(levels[i].fft_size_shift >= levels[i - 1].fft_size_shift);
+		assert(levels[i].show_3d <= levels[i - 1].show_3d);
+		assert(levels[i].run_stft <= levels[i - 1].run_stft);
+		assert(levels[i].show_time <= levels[i - 1].show_time);
+		if (!levels[i].show_3d && shed_3d < 0) shed_3d = i;
+		if (!levels[i].run_stft && shed_stft < 0) shed_stft = i;
+		if (!levels[i].show_time && shed_time < 0) shed_time = i;
+	}
+	assert(shed_3d > 0 && shed_3d < shed_stft && shed_stft < shed_time);
+	assert(levels[shed_3d - 1].display_decimation > 1 || levels[shed_3d - 1].stft_overlap_percent < 50);
+	// A smaller analyzer FFT is tried before the 3D view goes
+	assert(levels[shed_3d - 1].fft_size_shift > 0);
+	cout << "   PASSED (" << levels.size() << " levels)" << endl;
+}
+
+void StepsDownUnderLoad() {
+	cout << "StepsDownUnderLoad" << endl;
+
+	BudgetGovernor governor;
+	Feed feed(governor);
+	assert(!feed.step(0.6));
+	assert(governor.level() == 0);
+
+	// One level per overloaded evaluation, whichever budget is blown
+	assert(feed.step(0.95));
+	assert(governor.level() == 1 && governor.reason() == "thread load 95%");
+	assert(feed.step(0.3, 20.0));
+	assert(governor.level() == 2 && governor.reason() == "frame time 20.0 ms");
+	assert(feed.step(0.3, 5.0, 4096));
+	assert(governor.level() == 3 && governor.reason() == "analyzer lost samples");
+
+	// Bottom of the ladder is as far as it goes
+	int last = static_cast<int>(BudgetGovernor::levels().size()) - 1;
+	for (int i = 0; i < 20; ++i) {
+		feed.step(2.0);
+	}
+	assert(governor.level() == last);
+	assert(!governor.current().show_time);
+	cout << "   PASSED" << endl;
+}
+
+void RecoversWithHysteresis() {
+	cout << "RecoversWithHysteresis" << endl;
+
+	BudgetGovernor::Settings settings;
+	BudgetGovernor governor(settings);
+	Feed feed(governor);
+	feed.step(0.95);
+	feed.step(0.95);
+	assert(governor.level() == 2);
+
+	// Between low and high: hold
+	for (int i = 0; i < 10; ++i) {
+		assert(!feed.step(0.7));
+	}
+	assert(governor.level() == 2);
+
+	// Calm for calm_evaluations in a row: one level back up
+	for (int i = 0; i < settings.calm_evaluations - 1; ++i) {
+		assert(!feed.step(0.2));
+	}
+	assert(feed.step(0.2));
+	assert(governor.level() == 1 && governor.reason() == "headroom");
+
+	// Overloaded right after stepping up: back down, and twice as long to wait
+	assert(feed.step(0.95));
+	assert(governor.level() == 2);
+	for (int i = 0; i < 2 * settings.calm_evaluations - 1; ++i) {
+		assert(!feed.step(0.2));
+	}
+	assert(feed.step(0.2));
+	assert(governor.level() == 1);
+
+	// The step held, so the wait relaxes again
+	for (int i = 0; i < settings.calm_evaluations - 1; ++i) {
+		assert(!feed.step(0.2));
+	}
+	assert(feed.step(0.2));
+	assert(governor.level() == 0);
+	cout << "   PASSED" << endl;
+}
+
+void CounterReset() {
+	cout << "CounterReset" << endl;
+
+	// Stage counters restart with reception; that must not read as negative load
+	BudgetGovernor governor;
+	Feed feed(governor);
+	feed.step(0.5);
+	feed.sample.busy_ns[1] = 0;
+	assert(!feed.step(0.0));
+	assert(feed.step(0.95));
+	assert(governor.level() == 1);
+	cout << "   PASSED" << endl;
+}
+
+void PicksFFTSize() {
+	cout << "PicksFFTSize" << endl;
+
+	// N log N cost, 1 ns per butterfly
+	auto cost = [](int size) {
+		int log2 = 0;
+		while ((1 << log2) < size) ++log2;
+		return static_cast<int64_t>(size) * log2;
+	};
+	vector<int> sizes = {1024, 2048, 4096, 8192};
+
+	// 1 MS/s: ~13 ms of CPU per second at 8192, plenty of room
+	assert(BudgetGovernor::pickFFTSize(1e6, sizes, 0.25, cost) == 8192);
+	// 20 MS/s at 8192 costs 26%, 4096 costs 24%
+	assert(BudgetGovernor::pickFFTSize(20e6, sizes, 0.25, cost) == 4096);
+	// Nothing fits: the cheapest there is
+	assert(BudgetGovernor::pickFFTSize(1e9, sizes, 0.25, cost) == 1024);
+	cout << "   PASSED" << endl;
+}
+
+int main() {
+	cout << "=== BudgetGovernor Test ===" << endl;
+	try {
+		LadderOrder();
+		StepsDownUnderLoad();
+		RecoversWithHysteresis();
+		CounterReset();
+		PicksFFTSize();
+		cout << "\n=== ALL TESTS PASSED ===" << endl;
+		return 0;
+	} catch (const std::exception& e) {
+		cerr << "Test failed: " << e.what() << endl;
+		return -1;
+	}
+}
@@ -1,6 +1,9 @@
 #include "CircularBuffer.h"
 #include <iostream>
 #include <cassert>
+#include <thread>
+#include <chrono>
+#include <vector>
 
 using namespace std;
 
@@ -78,12 +81,100 @@ void Latest() {
     std::cout << "   PASSED" << std::endl;
 }
 
+void Policies() {
+    std::cout << "Policies" << std::endl;
+
+    int items[5] = {1, 2, 3, 4, 5};
+    int value;
+
+    CircularBuffer<int> overwrite(3);
+    assert(overwrite.PushBulk(items, 5) == 5);
+    assert(overwrite.Dropped() == 2);
+    assert(overwrite.Pop(value) && value == 3);
+
+    CircularBuffer<int> drop(3, OverflowPolicy::DropNewest);
+    assert(drop.PushBulk(items, 5) == 3);
+    assert(!drop.Push(6));
+    assert(drop.Dropped() == 3);
+    assert(drop.Pop(value) && value == 1);
+    assert(drop.Fill() == 2);
+    assert(drop.HighWaterMark() == 3);
+
+    // Times out with nobody reading
+    CircularBuffer<int> block(3, OverflowPolicy::Block, std::chrono::milliseconds(10));
+    assert(block.PushBulk(items, 5) == 3);
+    assert(block.Dropped() == 2);
+
+    // A consumer making room lets the producer finish
+    CircularBuffer<int> waiting(2, OverflowPolicy::Block, std::chrono::milliseconds(1000));
+    std::thread consumer([&waiting]() {
+        int popped = 0;
+        int v;
+        while (popped < 5) {
+            if (waiting.Pop(v)) { assert(v == popped + 1); ++popped; }
+            else { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }
+        }
+    });
+    assert(waiting.PushBulk(items, 5) == 5);
+    consumer.join();
+    assert(waiting.Dropped() == 0);
+    assert(waiting.HighWaterMark() == 2);
+
+    BufferStats stats = drop.Stats();
+    assert(stats.capacity == 3 && stats.fill == 2 && stats.high_water == 3 && stats.dropped == 3);
+    std::cout << "   PASSED" << std::endl;
+}
+
+void HugePages() {
+    std::cout << "HugePages" << std::endl;
+
+    // Placement is best effort, the buffer must behave the same either way
+    CircularBuffer<float> buffer(1 << 20, OverflowPolicy::OverwriteOldest,
+            std::chrono::milliseconds(100), MemoryPolicy::largeBuffer());
+    std::vector<float> block(4096, 1.5f);
+    for (int i = 0; i < 300; ++i) {
+        buffer.PushBulk(block.data(), block.size());
+    }
+    assert(buffer.IsFull());
+    float latest[8];
+    buffer.CopyLatest(latest, 8);
+    assert(latest[0] == 1.5f && latest[7] == 1.5f);
+    std::cout << "   PASSED" << std::endl;
+}
+
+void FallbackMappingSize() {
+    std::cout << "FallbackMappingSize" << std::endl;
+
+    // A fallback maps the request rounded to its own page size, not to the
+    // size asked for; without 1G pages reserved 3M must not cost a gigabyte
+    const size_t bytes = 3 << 20;
+    MemoryPolicy policy;
+    policy.page_size = MemoryPolicy::PageSize::Huge1G;
+    void* memory = BufferMemory::allocate(bytes, policy);
+    assert(memory);
+    size_t len = BufferMemory::mappedSize(memory);
+    assert(len >= bytes && len % 4096 == 0);
+    assert(len == (size_t(1) << 30) || len <= (size_t(4) << 20));
+    static_cast<char*>(memory)[bytes - 1] = 1;
+    BufferMemory::deallocate(memory, bytes, policy);
+    assert(BufferMemory::mappedSize(memory) == 0);
+
+    // Heap allocations are not tracked
+    void* heap = BufferMemory::allocate(64, MemoryPolicy());
+    assert(BufferMemory::mappedSize(heap) == 0);
+    BufferMemory::deallocate(heap, 64, MemoryPolicy());
+    std::cout << "   PASSED (" << (len >> 20) << "M mapped)" << std::endl;
+}
+
 int main() {
     std::cout << "=== CircularBuffer Test ===" << std::endl;
     try {
         Basics();
         Overflow();
         Latest();
+        Policies();
+        HugePages();
+        FallbackMappingSize();
         std::cout << "\n=== ALL TESTS PASSED ===" << std::endl;
         return 0;
     } catch (const std::exception& e) {
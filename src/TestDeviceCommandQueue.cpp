@@ -0,0 +1,232 @@
+#include "DeviceCommandQueue.h"
+#include "SimulationDevice.h"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+SDRConfig SimConfig() {
+	SDRConfig config;
+	config.device_type = "simulation";
+	config.frequency = 100e6;
+	config.sample_rate = 1e6;
+	return config;
+}
+
+// Blocks the control thread until released, stands in for a slow UHD call
+struct Gate {
+	promise<void> open;
+	shared_future<void> opened = open.get_future().share();
+	DeviceCommandQueue::Command command() {
+		auto wait = opened;
+		return [wait](SDRDevice&) { wait.wait(); return true; };
+	}
+};
+
+void ResultsAndOrder() {
+	cout << "ResultsAndOrder" << endl;
+
+	SimulationDevice device;
+	assert(device.initialize(SimConfig()));
+	DeviceCommandQueue queue(device);
+	assert(queue.start());
+
+	auto freq = queue.setFrequency(433e6);
+	auto gain = queue.setGain(35.0);
+	auto rate = queue.setSampleRate(-1.0);		// Invalid, device refuses
+	auto threw = queue.submit("", [](SDRDevice&) -> bool { throw runtime_error("boom"); });
+	assert(freq.get() && gain.get());
+	assert(!rate.get());
+	assert(!threw.get());
+
+	DeviceTelemetry telemetry = device.getTelemetry();
+	assert(telemetry.frequency == 433e6 && telemetry.gain == 35.0 && telemetry.sample_rate == 1e6);
+	assert(queue.executed() == 4);
+	cout << "   PASSED" << endl;
+}
+
+void CoalescesBursts() {
+	cout << "CoalescesBursts" << endl;
+
+	// Slider drag: 200 frequency requests while the device is busy turn into
+	// one retune, and every caller sees its outcome
+	SimulationDevice device;
+	assert(device.initialize(SimConfig()));
+	DeviceCommandQueue queue(device);
+	assert(queue.start());
+
+	Gate gate;
+	auto blocker = queue.submit("", gate.command());
+	while (!queue.busy()) {
+		this_thread::yield();
+	}
+
+	vector<future<bool>> results;
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < 200; ++i) {
+		results.push_back(queue.setFrequency(100e6 + i * 1e3));
+	}
+	auto gain = queue.setGain(10.0);
+	auto submit_time = chrono::steady_clock::now() - start;
+
+	// Submitting never waits on the device
+	assert(submit_time < chrono::milliseconds(50));
+	assert(queue.pending() == 2);
+	assert(queue.coalesced() == 199);
+
+	gate.open.set_value();
+	assert(blocker.get());
+	for (auto& result : results) {
+		assert(result.get());
+	}
+	assert(gain.get());
+	assert(device.getTelemetry().frequency == 100e6 + 199 * 1e3);
+	assert(queue.executed() == 3);
+	cout << "   PASSED (200 requests, " << queue.executed() - 1 << " device calls)" << endl;
+}
+
+void StopResolvesQueued() {
+	cout << "StopResolvesQueued" << endl;
+
+	SimulationDevice device;
+	assert(device.initialize(SimConfig()));
+	DeviceCommandQueue queue(device);
+	assert(queue.start());
+
+	Gate gate;
+	auto blocker = queue.submit("", gate.command());
+	while (!queue.busy()) {
+		this_thread::yield();
+	}
+	auto queued = queue.setGain(50.0);
+
+	thread stopper([&]() { queue.stop(); });
+	this_thread::sleep_for(chrono::milliseconds(10));
+	gate.open.set_value();
+	stopper.join();
+
+	// The command in flight finishes, the queued one never runs
+	assert(blocker.get());
+	assert(!queued.get());
+	assert(device.getTelemetry().gain == 20.0);
+	cout << "   PASSED" << endl;
+}
+
+void RetuneAtBlockBoundary() {
+	cout << "RetuneAtBlockBoundary" << endl;
+
+	// Samples keep flowing while the retune is in flight; the first block
+	// after it is flagged, earlier ones are not
+	SimulationDevice device;
+	assert(device.initialize(SimConfig()));
+	DeviceCommandQueue queue(device);
+	assert(queue.start());
+
+	atomic<uint64_t> blocks{0};
+	atomic<uint64_t> retuned_at{0};
+	atomic<int> retuned_blocks{0};
+	assert(device.startReceiving([&](const complex<float>*, size_t, const SampleMetadata& meta) {
+		uint64_t n = blocks.fetch_add(1) + 1;
+		if (meta.hasFlag(SampleMetadata::RETUNED)) {
+			retuned_blocks.fetch_add(1);
+			retuned_at.store(n);
+		}
+	}, 1024));
+
+	while (blocks.load() < 5) {
+		this_thread::sleep_for(chrono::milliseconds(1));
+	}
+	assert(retuned_blocks.load() == 0);
+
+	Gate gate;
+	auto blocker = queue.submit("", gate.command());
+	auto freq = queue.setFrequency(915e6);
+	uint64_t before = blocks.load();
+	this_thread::sleep_for(chrono::milliseconds(20));
+	assert(blocks.load() > before);			// Still receiving while the device call waits
+	// The flag is raised inside the device call, so the retuned block can
+	// land before the future resolves, never before the gate opens
+	uint64_t opened = blocks.load();
+	gate.open.set_value();
+	assert(freq.get());
+
+	uint64_t applied = blocks.load();
+	while (blocks.load() < applied + 3) {
+		this_thread::sleep_for(chrono::milliseconds(1));
+	}
+	device.stopReceiving();
+	assert(retuned_blocks.load() == 1);
+	// One block may already be generating when the flag goes up
+	assert(retuned_at.load() > opened && retuned_at.load() <= applied + 2);
+	cout << "   PASSED (retuned at block " << retuned_at.load() << ")" << endl;
+}
+
+void RateChangeKeepsIndex() {
+	cout << "RateChangeKeepsIndex" << endl;
+
+	// A live rate change moves the clock on at the new rate without a gap:
+	// every block starts where the previous one ended, in index and time
+	SimulationDevice device;
+	assert(device.initialize(SimConfig()));
+	DeviceCommandQueue queue(device);
+	assert(queue.start());
+
+	struct Block { SampleMetadata meta; size_t count; };
+	vector<Block> seen;
+	mutex seen_mutex;
+	assert(device.startReceiving([&](const complex<float>*, size_t count, const SampleMetadata& meta) {
+		lock_guard<mutex> lock(seen_mutex);
+		seen.push_back({meta, count});
+	}, 1024));
+
+	auto block_count = [&] { lock_guard<mutex> lock(seen_mutex); return seen.size(); };
+	while (block_count() < 5) {
+		this_thread::sleep_for(chrono::milliseconds(1));
+	}
+	assert(queue.setSampleRate(2e6).get());
+	size_t applied = block_count();
+	while (block_count() < applied + 5) {
+		this_thread::sleep_for(chrono::milliseconds(1));
+	}
+	device.stopReceiving();
+
+	int retuned = 0;
+	double rate = 1e6;
+	for (size_t i = 1; i < seen.size(); ++i) {
+		const Block& prev = seen[i - 1];
+		const Block& cur = seen[i];
+		assert(!cur.meta.hasFlag(SampleMetadata::DISCONTINUITY));
+		assert(cur.meta.sample_index == prev.meta.sample_index + prev.count);
+		// The previous block was generated at the rate in effect for it
+		assert(fabs(cur.meta.device_time - (prev.meta.device_time + prev.count / rate)) < 1e-9);
+		if (cur.meta.hasFlag(SampleMetadata::RETUNED)) {
+			++retuned;
+			rate = 2e6;
+		}
+	}
+	assert(retuned == 1);
+	cout << "   PASSED" << endl;
+}
+
+int main() {
+	cout << "=== DeviceCommandQueue Test ===" << endl;
+	try {
+		ResultsAndOrder();
+		CoalescesBursts();
+		StopResolvesQueued();
+		RetuneAtBlockBoundary();
+		RateChangeKeepsIndex();
+		cout << "\n=== ALL TESTS PASSED ===" << endl;
+		return 0;
+	} catch (const std::exception& e) {
+		cerr << "Test failed: " << e.what() << endl;
+		return -1;
+	}
+}
@@ -0,0 +1,87 @@
+#include "DspWorker.h"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+using namespace std;
+
+// Wait up to limit for cond, returns how long it took
+template<typename Cond>
+chrono::milliseconds WaitFor(Cond cond, chrono::milliseconds limit) {
+	auto start = chrono::steady_clock::now();
+	while (!cond() && chrono::steady_clock::now() - start < limit) {
+		this_thread::sleep_for(chrono::microseconds(50));
+	}
+	return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start);
+}
+
+void NoLostWakeups() {
+	cout << "NoLostWakeups" << endl;
+
+	// Producer announces items one at a time, the task drains whatever is there.
+	// Every burst must be picked up well before the idle timeout would kick in
+	atomic<uint64_t> produced{0};
+	atomic<uint64_t> consumed{0};
+	DspWorker worker("test-drain", [&]() {
+		consumed.store(produced.load());
+	});
+	assert(worker.start());
+
+	for (int burst = 0; burst < 2000; ++burst) {
+		produced.fetch_add(1);
+		worker.notify();
+		auto waited = WaitFor([&]() { return consumed.load() == produced.load(); },
+							  chrono::milliseconds(1000));
+		assert(consumed.load() == produced.load());
+		assert(waited < chrono::milliseconds(50));
+	}
+	worker.stop();
+	assert(!worker.isRunning());
+	cout << "   PASSED (" << worker.runs() << " runs)" << endl;
+}
+
+void Coalescing() {
+	cout << "Coalescing" << endl;
+
+	// Slow task: notifications pile up and are served by far fewer runs,
+	// while notify() itself stays non-blocking
+	atomic<int> runs{0};
+	DspWorker worker("test-slow", [&]() {
+		runs.fetch_add(1);
+		this_thread::sleep_for(chrono::milliseconds(20));
+	});
+	assert(worker.start());
+
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < 100; ++i) {
+		worker.notify();
+		this_thread::sleep_for(chrono::microseconds(500));
+	}
+	auto notify_time = chrono::steady_clock::now() - start;
+	assert(notify_time < chrono::milliseconds(500));
+
+	WaitFor([&]() { return worker.queued() == 0; }, chrono::milliseconds(1000));
+	this_thread::sleep_for(chrono::milliseconds(30));
+	worker.stop();
+
+	assert(worker.queued() == 0);
+	assert(worker.peakQueued() > 1);
+	assert(runs.load() > 0 && runs.load() < 100);
+	cout << "   PASSED (100 notifies, " << runs.load() << " runs, peak queue "
+		 << worker.peakQueued() << ")" << endl;
+}
+
+int main() {
+	cout << "=== DspWorker Test ===" << endl;
+	try {
+		NoLostWakeups();
+		Coalescing();
+		cout << "\n=== ALL TESTS PASSED ===" << endl;
+		return 0;
+	} catch (const std::exception& e) {
+		cerr << "Test failed: " << e.what() << endl;
+		return -1;
+	}
+}
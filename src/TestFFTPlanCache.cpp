@@ -0,0 +1,138 @@
+#include "FFTPlanCache.h"
+#include "FFTProcessor.h"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+void SharedPlans() {
+	cout << "SharedPlans" << endl;
+
+	FFTPlanCache& cache = FFTPlanCache::instance();
+	size_t built = cache.plansBuilt();
+	auto complex_plan = cache.plan(1024, FFTMode::Complex);
+	auto real_plan = cache.plan(1024, FFTMode::Real);
+	assert(cache.plansBuilt() == built + 2);
+	assert(complex_plan != real_plan);
+	assert(complex_plan->workFloats() == 2048 && real_plan->workFloats() == 1024);
+
+	// Every later user gets the same setup, nothing new is built
+	assert(cache.plan(1024, FFTMode::Complex) == complex_plan);
+	FFTProcessor a(1024, FFTMode::Complex), b(1024, FFTMode::Complex);
+	assert(cache.plansBuilt() == built + 2);
+
+	assert(cache.window(WindowType::Hann, 1024) == cache.window(WindowType::Hann, 1024));
+	assert(cache.window(WindowType::Hann, 1024) != cache.window(WindowType::Hann, 2048));
+	cout << "   PASSED" << endl;
+}
+
+void ConcurrentBuild() {
+	cout << "ConcurrentBuild" << endl;
+
+	// Threads asking for the same new plan at once share one build
+	FFTPlanCache& cache = FFTPlanCache::instance();
+	size_t built = cache.plansBuilt();
+	const int threads = 8;
+	vector<shared_ptr<const FFTPlan>> plans(threads);
+	vector<thread> workers;
+	for (int t = 0; t < threads; ++t) {
+		workers.emplace_back([&, t]() { plans[t] = cache.plan(32768, FFTMode::Complex); });
+	}
+	for (auto& worker : workers) {
+		worker.join();
+	}
+	assert(cache.plansBuilt() == built + 1);
+	for (const auto& plan : plans) {
+		assert(plan == plans[0]);
+	}
+	cout << "   PASSED" << endl;
+}
+
+void FailedBuild() {
+	cout << "FailedBuild" << endl;
+
+	// A size PFFFT can't do throws every time, it isn't cached as a failure
+	FFTPlanCache& cache = FFTPlanCache::instance();
+	for (int attempt = 0; attempt < 2; ++attempt) {
+		bool threw = false;
+		try {
+			cache.plan(0, FFTMode::Complex);
+		} catch (const runtime_error&) {
+			threw = true;
+		}
+		assert(threw);
+	}
+	assert(!cache.hasPlan(0, FFTMode::Complex));
+	cout << "   PASSED" << endl;
+}
+
+void Prewarm() {
+	cout << "Prewarm" << endl;
+
+	FFTPlanCache& cache = FFTPlanCache::instance();
+	assert(!cache.hasPlan(4096, FFTMode::Complex));
+	cache.prewarm({512, 4096, 0}, FFTMode::Complex, WindowType::Kaiser).get();
+	assert(cache.hasPlan(512, FFTMode::Complex));
+	assert(cache.hasPlan(4096, FFTMode::Complex));
+
+	// Switching to a prewarmed size builds nothing
+	size_t built = cache.plansBuilt();
+	SpectrogramAnalyzer analyzer(4096, 4.096e6f, FFTMode::Complex, WindowType::Kaiser);
+	assert(cache.plansBuilt() == built);
+	assert(&analyzer.getWindow() == cache.window(WindowType::Kaiser, 4096).get());
+
+	// And the analyzer works at that size
+	vector<complex<float>> tone(4096);
+	for (int n = 0; n < 4096; ++n) {
+		tone[n] = polar(1.0f, static_cast<float>(2.0 * M_PI * 300 * n / 4096));
+	}
+	analyzer.processSamples(tone.data(), tone.size());
+	assert(analyzer.updateSpectrum());
+	const auto& db = analyzer.latestSpectrum().magnitude_db;
+	int peak = 0;
+	for (int i = 1; i < 4096; ++i) {
+		if (db[i] > db[peak]) peak = i;
+	}
+	assert(peak == 2048 + 300);
+	cout << "   PASSED" << endl;
+}
+
+void Scratch() {
+	cout << "Scratch" << endl;
+
+	// Aligned, and reused while requests don't grow
+	float* small = FFTPlanCache::scratch(256);
+	assert(reinterpret_cast<uintptr_t>(small) % 64 == 0);
+	assert(FFTPlanCache::scratch(128) == small);
+	float* large = FFTPlanCache::scratch(1 << 17);
+	assert(reinterpret_cast<uintptr_t>(large) % 64 == 0);
+	assert(FFTPlanCache::scratch(1024) == large);
+
+	// Each thread has its own
+	float* other = nullptr;
+	thread([&]() { other = FFTPlanCache::scratch(256); }).join();
+	assert(other != large);
+	cout << "   PASSED" << endl;
+}
+
+int main() {
+	cout << "=== FFTPlanCache Test ===" << endl;
+	try {
+		SharedPlans();
+		ConcurrentBuild();
+		FailedBuild();
+		Prewarm();
+		Scratch();
+		cout << "\n=== ALL TESTS PASSED ===" << endl;
+		return 0;
+	} catch (const std::exception& e) {
+		cerr << "Test failed: " << e.what() << endl;
+		return -1;
+	}
+}
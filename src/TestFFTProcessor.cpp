@@ -0,0 +1,257 @@
+#include "FFTProcessor.h"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+using namespace std;
+
+const int FFT_SIZE = 1024;
+const float SAMPLE_RATE = 1.024e6f;		// 1 kHz bins
+
+// Complex tone on an exact bin, offset from center by offset_hz
+static vector<complex<float>> Tone(double offset_hz, size_t count) {
+	vector<complex<float>> samples(count);
+	for (size_t n = 0; n < count; ++n) {
+		double phase = 2.0 * M_PI * offset_hz * n / SAMPLE_RATE;
+		samples[n] = complex<float>(cos(phase), sin(phase));
+	}
+	return samples;
+}
+
+static int Peak(const vector<float>& spectrum) {
+	int peak = 0;
+	for (int i = 1; i < static_cast<int>(spectrum.size()); ++i) {
+		if (spectrum[i] > spectrum[peak]) peak = i;
+	}
+	return peak;
+}
+
+void TwoSidedBins() {
+	cout << "TwoSidedBins" << endl;
+
+	SpectrogramAnalyzer analyzer(FFT_SIZE, SAMPLE_RATE);
+	assert(analyzer.getMode() == FFTMode::Complex);
+	assert(analyzer.getNumBins() == FFT_SIZE);
+
+	// Frequency axis runs -Fs/2 .. +Fs/2 around the center, DC in the middle
+	const double center = 100e6;
+	vector<float> freqs(FFT_SIZE);
+	analyzer.getFrequencyArray(freqs.data(), FFT_SIZE, center);
+	assert(freqs[0] == static_cast<float>(center - SAMPLE_RATE / 2));
+	assert(freqs[FFT_SIZE / 2] == static_cast<float>(center));
+	assert(freqs[FFT_SIZE - 1] == static_cast<float>(center + SAMPLE_RATE / 2 - 1000.0));
+
+	// Tones above and below center land on their own side
+	for (double offset : {-300e3, -1e3, 0.0, 125e3, 400e3}) {
+		auto samples = Tone(offset, FFT_SIZE);
+		analyzer.processSamples(samples.data(), samples.size());
+		assert(analyzer.updateSpectrum());
+		int peak = Peak(analyzer.latestSpectrum().magnitude_db);
+		assert(peak == FFT_SIZE / 2 + static_cast<int>(offset / 1000.0));
+		assert(fabs(freqs[peak] - (center + offset)) < 1.0);
+		assert(Peak(analyzer.latestSpectrum().psd) == peak);
+	}
+	cout << "   PASSED" << endl;
+}
+
+void RingMatchesPointer() {
+	cout << "RingMatchesPointer" << endl;
+
+	// Both input paths build the same frame
+	auto samples = Tone(-250e3, FFT_SIZE);
+	SpectrogramAnalyzer direct(FFT_SIZE, SAMPLE_RATE);
+	direct.processSamples(samples.data(), FFT_SIZE);
+	assert(direct.updateSpectrum());
+
+	BroadcastRing<complex<float>> ring(4096);
+	auto reader = ring.MakeReader();
+	ring.PushBulk(samples.data(), FFT_SIZE);
+	SpectrogramAnalyzer from_ring(FFT_SIZE, SAMPLE_RATE);
+	from_ring.processSamples(reader);
+	assert(from_ring.updateSpectrum());
+	assert(from_ring.latestSpectrum().magnitude_db == direct.latestSpectrum().magnitude_db);
+	assert(from_ring.latestSpectrum().psd == direct.latestSpectrum().psd);
+	cout << "   PASSED" << endl;
+}
+
+void WindowTables() {
+	cout << "WindowTables" << endl;
+
+	// Textbook coherent gain and ENBW of each window
+	struct Expected { WindowType type; double coherent_gain; double enbw; };
+	const Expected expected[] = {
+		{WindowType::Rectangular,    1.0,     1.0},
+		{WindowType::Hann,           0.5,     1.5},
+		{WindowType::Blackman,       0.42,    1.7268},
+		{WindowType::BlackmanHarris, 0.35875, 2.0044},
+		{WindowType::FlatTop,        0.21558, 3.7702},
+	};
+	for (const Expected& e : expected) {
+		WindowTable table = makeWindowTable(e.type, FFT_SIZE);
+		assert(fabs(table.coherent_gain - e.coherent_gain) < 1e-4);
+		assert(fabs(table.enbw() - e.enbw) < 1e-3);
+	}
+
+	// Periodic and peaking at 1 in the middle
+	for (WindowType type : windowTypes()) {
+		WindowTable table = makeWindowTable(type, FFT_SIZE);
+		assert(table.coefficients.size() == static_cast<size_t>(FFT_SIZE));
+		for (int n = 1; n < FFT_SIZE; ++n) {
+			assert(fabs(table.coefficients[n] - table.coefficients[FFT_SIZE - n]) < 1e-6f);
+		}
+		assert(fabs(table.coefficients[FFT_SIZE / 2] - 1.0f) < 1e-6f);
+
+		assert(windowName(type) != string("Unknown"));
+	}
+	WindowType parsed = WindowType::Hann;
+	assert(parseWindowType("blackman-harris", parsed) && parsed == WindowType::BlackmanHarris);
+	assert(!parseWindowType("triangle", parsed) && parsed == WindowType::BlackmanHarris);
+
+	// Kaiser's beta trades main lobe for sidelobes; 0 is rectangular
+	WindowTable kaiser = makeWindowTable(WindowType::Kaiser, FFT_SIZE, 0.0f);
+	assert(fabs(kaiser.coherent_gain - 1.0f) < 1e-6f);
+	assert(makeWindowTable(WindowType::Kaiser, FFT_SIZE, 12.0f).enbw() >
+	       makeWindowTable(WindowType::Kaiser, FFT_SIZE, 6.0f).enbw());
+	cout << "   PASSED" << endl;
+}
+
+void WindowRevealsWeakTone() {
+	cout << "WindowRevealsWeakTone" << endl;
+
+	// A strong tone between bins, a weak one 80 dB down 40 bins away
+	const double strong_hz = 100.5e3, weak_hz = 140e3;
+	const int weak_bin = FFT_SIZE / 2 + 140;
+	vector<complex<float>> samples(FFT_SIZE);
+	for (int n = 0; n < FFT_SIZE; ++n) {
+		samples[n] = polar(1.0f, static_cast<float>(2.0 * M_PI * strong_hz * n / SAMPLE_RATE)) +
+		             polar(1e-4f, static_cast<float>(2.0 * M_PI * weak_hz * n / SAMPLE_RATE));
+	}
+	auto stands_out_db = [&](WindowType window) {
+		SpectrogramAnalyzer analyzer(FFT_SIZE, SAMPLE_RATE, FFTMode::Complex, window);
+		analyzer.processSamples(samples.data(), samples.size());
+		assert(analyzer.updateSpectrum());
+		const auto& psd = analyzer.latestSpectrum().psd;
+		return 10.0 * log10(psd[weak_bin] / max(psd[weak_bin - 5], psd[weak_bin + 5]));
+	};
+
+	// Rectangular leakage at 40 bins is only ~42 dB down and buries it
+	assert(stands_out_db(WindowType::Rectangular) < 1.0);
+	for (WindowType type : windowTypes()) {
+		if (type != WindowType::Rectangular) {
+			assert(stands_out_db(type) > 10.0);
+		}
+	}
+	assert(stands_out_db(WindowType::Blackman) > 20.0);
+	assert(stands_out_db(WindowType::BlackmanHarris) > 30.0);
+	cout << "   PASSED" << endl;
+}
+
+void WindowKeepsLevels() {
+	cout << "WindowKeepsLevels" << endl;
+
+	// Gains are compensated: a bin centred tone peaks at the same dB, and
+	// total power stays put, whatever the window
+	auto samples = Tone(200e3, FFT_SIZE);
+	SpectrogramAnalyzer rectangular(FFT_SIZE, SAMPLE_RATE, FFTMode::Complex, WindowType::Rectangular);
+	rectangular.processSamples(samples.data(), samples.size());
+	rectangular.updateSpectrum();
+	const int peak = FFT_SIZE / 2 + 200;
+	const float reference = rectangular.latestSpectrum().magnitude_db[peak];
+	for (WindowType type : windowTypes()) {
+		SpectrogramAnalyzer analyzer(FFT_SIZE, SAMPLE_RATE, FFTMode::Complex, type);
+		analyzer.processSamples(samples.data(), samples.size());
+		analyzer.updateSpectrum();
+		assert(fabs(analyzer.latestSpectrum().magnitude_db[peak] - reference) < 1e-4f);
+		double power = 0.0;
+		for (float bin : analyzer.latestSpectrum().psd) {
+			power += bin * (SAMPLE_RATE / FFT_SIZE);
+		}
+		assert(fabs(power - 1.0) < 1e-3);
+	}
+
+	// Pointer input in odd chunks frames exactly like one whole frame
+	SpectrogramAnalyzer whole(FFT_SIZE, SAMPLE_RATE, FFTMode::Real);
+	SpectrogramAnalyzer chunked(FFT_SIZE, SAMPLE_RATE, FFTMode::Real);
+	whole.processSamples(samples.data(), FFT_SIZE);
+	for (size_t i = 0; i < samples.size(); i += 97) {
+		chunked.processSamples(samples.data() + i, min<size_t>(97, samples.size() - i));
+	}
+	assert(whole.updateSpectrum() && chunked.updateSpectrum());
+	assert(whole.latestSpectrum().psd == chunked.latestSpectrum().psd);
+	cout << "   PASSED" << endl;
+}
+
+void RealPackedEdges() {
+	cout << "RealPackedEdges" << endl;
+
+	// PFFFT's real layout: DC and Nyquist share the first pair, bins 1..N/2-1
+	// follow, and nothing lives past N floats (NaN guards the overrun)
+	const int N = 64;
+	FFTProcessor fft(N, FFTMode::Real);
+	vector<float> packed(N + 2, NAN);
+	packed[0] = -3.0f * N;
+	packed[1] = 5.0f * N;
+	for (int k = 1; k < N / 2; ++k) {
+		packed[2 * k] = 3.0f * k;
+		packed[2 * k + 1] = -4.0f * k;
+	}
+
+	vector<float> magnitude(N / 2 + 1);
+	fft.complexToReal(magnitude.data(), packed.data(), N / 2 + 1, false);
+	assert(magnitude[0] == 3.0f * N);
+	assert(magnitude[N / 2] == 5.0f * N);
+	for (int k = 1; k < N / 2; ++k) {
+		assert(fabs(magnitude[k] - 5.0f * k) < 1e-4f * k);
+	}
+
+	// Normalized, the edges take the same 1/2N as every other bin
+	fft.complexToReal(magnitude.data(), packed.data(), N / 2 + 1, true);
+	assert(fabs(magnitude[0] - 1.5f) < 1e-6f);
+	assert(fabs(magnitude[N / 2] - 2.5f) < 1e-6f);
+	assert(fabs(magnitude[8] - 5.0f * 8 / (2 * N)) < 1e-6f);
+	cout << "   PASSED" << endl;
+}
+
+void PowerIsTwoSided() {
+	cout << "PowerIsTwoSided" << endl;
+
+	// Parseval: a unit complex tone has unit power, all of it in one bin
+	SpectrogramAnalyzer analyzer(FFT_SIZE, SAMPLE_RATE);
+	auto samples = Tone(50e3, FFT_SIZE);
+	analyzer.processSamples(samples.data(), samples.size());
+	analyzer.updateSpectrum();
+	const auto& psd = analyzer.latestSpectrum().psd;
+	double power = 0.0;
+	for (float bin : psd) {
+		power += bin * (SAMPLE_RATE / FFT_SIZE);
+	}
+	assert(fabs(power - 1.0) < 1e-3);
+
+	// Real mode keeps the one-sided half-band view
+	SpectrogramAnalyzer real(FFT_SIZE, SAMPLE_RATE, FFTMode::Real);
+	assert(real.getNumBins() == FFT_SIZE / 2 + 1);
+	real.processSamples(samples.data(), samples.size());
+	assert(real.updateSpectrum());
+	assert(Peak(real.latestSpectrum().magnitude_db) == 50);
+	cout << "   PASSED" << endl;
+}
+
+int main() {
+	cout << "=== FFTProcessor Test ===" << endl;
+	try {
+		TwoSidedBins();
+		RingMatchesPointer();
+		PowerIsTwoSided();
+		RealPackedEdges();
+		WindowTables();
+		WindowRevealsWeakTone();
+		WindowKeepsLevels();
+		cout << "\n=== ALL TESTS PASSED ===" << endl;
+		return 0;
+	} catch (const std::exception& e) {
+		cerr << "Test failed: " << e.what() << endl;
+		return -1;
+	}
+}
@@ -2,17 +2,29 @@
 #include "SDRDevice.h"
 #include "USRPDevice.h"
 #include "SimulationDevice.h"
+#include "BroadcastRing.h"
 #include <iostream>
 #include <iomanip>
 #include <thread>
 #include <chrono>
 #include <atomic>
+#include <mutex>
+#include <vector>
 
 std::atomic<size_t> g_sample_count{0};
 std::atomic<bool> g_stop_flag{false};
 
-void sample_callback(const std::complex<float>* samples, size_t count) {
+std::atomic<uint64_t> g_next_index{0};
+std::atomic<size_t> g_index_gaps{0};
+
+void sample_callback(const std::complex<float>* samples, size_t count,
+                     const SampleMetadata& metadata) {
     g_sample_count.fetch_add(count);
+    if (metadata.sample_index != g_next_index.load() ||
+            metadata.hasFlag(SampleMetadata::DISCONTINUITY)) {
+        g_index_gaps.fetch_add(1);
+    }
+    g_next_index.store(metadata.sample_index + count);
     
     // Debug first few samples
     static int print_count = 0;
@@ -109,6 +121,8 @@ void test_simulation_device() {
     
     std::cout << "\nTesting sample reception for 3 seconds..." << std::endl;
     g_sample_count.store(0);
+    g_next_index.store(0);
+    g_index_gaps.store(0);
     
     if (!device->startReceiving(sample_callback, 4096)) {
         std::cout << "✗ Failed to start receiving" << std::endl;
@@ -129,14 +143,270 @@ void test_simulation_device() {
     std::cout << "  Reception rate: " << std::fixed << std::setprecision(1) 
               << reception_rate << "%" << std::endl;
     std::cout << "  Device overflow count: " << device->getOverflowCount() << std::endl;
+    std::cout << "  Sample index gaps: " << g_index_gaps.load() << std::endl;
+    
+    // Telemetry snapshot must agree with the device's own counters
+    DeviceTelemetry telemetry = device->getTelemetry();
+    bool telemetry_ok = !telemetry.receiving &&
+                        telemetry.samples_received == device->getTotalSamplesReceived() &&
+                        telemetry.frequency == 433e6 && telemetry.sample_rate == 2e6;
+    std::cout << "  Telemetry: " << telemetry.samples_received << " samples in "
+              << telemetry.blocks_received << " blocks "
+              << (telemetry_ok ? "(consistent)" : "(MISMATCH)") << std::endl;
     
-    if (reception_rate > 95.0 && device->getOverflowCount() == 0) {
+    if (reception_rate > 95.0 && telemetry_ok && device->getOverflowCount() == 0 && g_index_gaps.load() == 0) {
         std::cout << "  Sample reception test PASSED" << std::endl;
     } else {
         std::cout << "  Sample reception test FAILED" << std::endl;
     }
 }
 
+void test_block_pool() {
+    std::cout << "\n=== Testing Sample Block Pool ===" << std::endl;
+    
+    SampleBlockPool pool(4, 1000);
+    std::vector<SampleBlockRef> held;
+    for (int i = 0; i < 4; ++i) {
+        held.push_back(pool.acquire());
+    }
+    bool aligned = true;
+    for (const auto& block : held) {
+        aligned &= reinterpret_cast<uintptr_t>(block->data) % 64 == 0;
+    }
+    bool exhausted = !pool.acquire() && pool.exhaustedCount() == 1;
+    
+    SampleBlockRef shared = held[0];
+    held.clear();
+    bool shared_kept = pool.freeBlocks() == 3 && shared.useCount() == 1;
+    shared.reset();
+    bool all_returned = pool.freeBlocks() == 4;
+    
+    if (aligned && exhausted && shared_kept && all_returned) {
+        std::cout << "  Block pool test PASSED" << std::endl;
+    } else {
+        std::cout << "  Block pool test FAILED" << std::endl;
+    }
+    
+    // Consumers keep blocks past the callback without copying
+    SDRConfig config;
+    config.device_type = "simulation";
+    auto device = SDRFactory::createAndInitialize(config);
+    if (!device) {
+        std::cout << "  Failed to create simulation device" << std::endl;
+        return;
+    }
+    std::mutex held_mutex;
+    std::vector<SampleBlockRef> kept;
+    uint64_t next_index = 0;
+    size_t metadata_errors = 0;
+    auto on_block = [&](const SampleBlockRef& block) {
+        std::lock_guard<std::mutex> lock(held_mutex);
+        const SampleMetadata& meta = block->metadata;
+        bool gap = meta.hasFlag(SampleMetadata::DISCONTINUITY);
+        if ((!gap && meta.sample_index != next_index) || meta.host_time_ns == 0 ||
+                !meta.hasFlag(SampleMetadata::HAS_DEVICE_TIME)) {
+            ++metadata_errors;
+        }
+        next_index = meta.sample_index + block->size;
+        kept.push_back(block);
+        if (kept.size() > 8) {
+            kept.erase(kept.begin());
+        }
+    };
+    if (!device->startReceivingBlocks(on_block, 4096, 16)) {
+        std::cout << "  Failed to start block reception" << std::endl;
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    device->stopReceiving();
+    
+    const SampleBlockPool* device_pool = device->getBlockPool();
+    size_t in_use = device_pool->numBlocks() - device_pool->freeBlocks();
+    std::cout << "  Blocks held downstream: " << in_use
+              << ", pool exhausted " << device_pool->exhaustedCount() << " times" << std::endl;
+    std::cout << "  Block metadata errors: " << metadata_errors << std::endl;
+    kept.clear();
+    if (in_use == 8 && device_pool->freeBlocks() == device_pool->numBlocks() &&
+            metadata_errors == 0) {
+        std::cout << "  Block reception test PASSED" << std::endl;
+    } else {
+        std::cout << "  Block reception test FAILED" << std::endl;
+    }
+}
+
+// Receives into a BroadcastRing the way SignalGui does
+class RingProvider : public RxBufferProvider {
+public:
+    explicit RingProvider(BroadcastRing<std::complex<float>>& ring) : ring_(ring) {}
+    Span acquire(size_t max_samples) override {
+        auto span = ring_.Reserve(max_samples);
+        Span out;
+        out.data = span.data;
+        out.size = span.size;
+        return out;
+    }
+    void commit(size_t count, const SampleMetadata& metadata) override {
+        if (metadata.sample_index != next_index) ++index_errors;
+        next_index = metadata.sample_index + count;
+        ring_.Commit(count);
+    }
+    uint64_t next_index = 0;
+    size_t index_errors = 0;
+private:
+    BroadcastRing<std::complex<float>>& ring_;
+};
+
+void test_buffer_provider() {
+    std::cout << "\n=== Testing RX Into Consumer Buffers ===" << std::endl;
+    
+    SDRConfig config;
+    config.device_type = "simulation";
+    auto device = SDRFactory::createAndInitialize(config);
+    if (!device) {
+        std::cout << "  Failed to create simulation device" << std::endl;
+        return;
+    }
+    // Block size does not divide the ring, so a flat ring gets short spans
+    BroadcastRing<std::complex<float>> ring(10000);
+    RingProvider provider(ring);
+    if (!device->startReceivingInto(&provider, 4096)) {
+        std::cout << "  Failed to start reception" << std::endl;
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    device->stopReceiving();
+    
+    std::cout << "  Ring samples: " << ring.TotalWritten()
+              << ", device samples: " << device->getTotalSamplesReceived()
+              << ", index errors: " << provider.index_errors << std::endl;
+    if (ring.TotalWritten() > 0 && ring.TotalWritten() == device->getTotalSamplesReceived() &&
+            provider.index_errors == 0) {
+        std::cout << "  Buffer provider test PASSED" << std::endl;
+    } else {
+        std::cout << "  Buffer provider test FAILED" << std::endl;
+    }
+}
+
+// Simulation device made to take the base class's copying path
+class CopyingSimulationDevice : public SimulationDevice {
+public:
+    bool startReceivingInto(RxBufferProvider* provider, size_t buffer_size = 4096) override {
+        return SDRDevice::startReceivingInto(provider, buffer_size);
+    }
+};
+
+// Refuses every third block; checks the block after each refusal is flagged
+class RefusingProvider : public RxBufferProvider {
+public:
+    Span acquire(size_t max_samples) override {
+        if (++calls % 3 == 0) {
+            refused = true;
+            return Span();
+        }
+        buffer.resize(max_samples);
+        Span out;
+        out.data = buffer.data();
+        out.size = max_samples;
+        return out;
+    }
+    void commit(size_t, const SampleMetadata& metadata) override {
+        bool flagged = metadata.hasFlag(SampleMetadata::DISCONTINUITY) &&
+                       metadata.hasFlag(SampleMetadata::DEVICE_OVERFLOW);
+        if (flagged != refused) ++flag_errors;
+        refused = false;
+        ++commits;
+    }
+    std::vector<std::complex<float>> buffer;
+    size_t calls = 0;
+    size_t commits = 0;
+    size_t flag_errors = 0;
+    bool refused = false;
+};
+
+void test_fallback_provider_drops() {
+    std::cout << "\n=== Testing Copying Fallback Drops ===" << std::endl;
+    
+    SDRConfig config;
+    config.device_type = "simulation";
+    CopyingSimulationDevice device;
+    if (!device.initialize(config)) {
+        std::cout << "  Failed to initialize simulation device" << std::endl;
+        return;
+    }
+    RefusingProvider provider;
+    if (!device.startReceivingInto(&provider, 1024)) {
+        std::cout << "  Failed to start reception" << std::endl;
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    device.stopReceiving();
+    
+    size_t drops = provider.calls / 3;
+    std::cout << "  Commits: " << provider.commits << ", drops: " << drops
+              << ", flag errors: " << provider.flag_errors
+              << ", overflows: " << device.getTelemetry().overflows << std::endl;
+    if (provider.commits > 0 && drops > 0 && provider.flag_errors == 0 &&
+            device.getTelemetry().overflows >= drops - 1) {
+        std::cout << "  Copying fallback drop test PASSED" << std::endl;
+    } else {
+        std::cout << "  Copying fallback drop test FAILED" << std::endl;
+    }
+}
+
+void test_pull_read() {
+    std::cout << "\n=== Testing Pull Read ===" << std::endl;
+    
+    SDRConfig config;
+    config.device_type = "simulation";
+    auto device = SDRFactory::createAndInitialize(config);
+    if (!device) {
+        std::cout << "  Failed to create simulation device" << std::endl;
+        return;
+    }
+    if (!device->startStreaming(4096, 1 << 16)) {
+        std::cout << "  Failed to start streaming" << std::endl;
+        return;
+    }
+    
+    // Odd read size so reads end mid-block
+    std::vector<std::complex<float>> samples(3000);
+    uint64_t next_index = 0;
+    size_t index_errors = 0;
+    size_t total = 0;
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+    while (std::chrono::steady_clock::now() < end) {
+        RxStream::ReadResult r = device->read(samples.data(), samples.size());
+        if (r.count > 0) {
+            if (r.metadata.sample_index != next_index &&
+                    !r.metadata.hasFlag(SampleMetadata::DISCONTINUITY)) {
+                ++index_errors;
+            }
+            next_index = r.metadata.sample_index + r.count;
+            total += r.count;
+        }
+    }
+    device->stopStreaming();
+    
+    // Drain what was still buffered, then end of stream
+    size_t reads_after_stop = 0;
+    while (reads_after_stop < 1000) {
+        RxStream::ReadResult r = device->read(samples.data(), samples.size());
+        if (r.end_of_stream) break;
+        total += r.count;
+        ++reads_after_stop;
+    }
+    
+    std::cout << "  Read samples: " << total
+              << ", device samples: " << device->getTotalSamplesReceived()
+              << ", index errors: " << index_errors << std::endl;
+    if (total > 0 && total == device->getTotalSamplesReceived() && index_errors == 0 &&
+            reads_after_stop < 1000) {
+        std::cout << "  Pull read test PASSED" << std::endl;
+    } else {
+        std::cout << "  Pull read test FAILED" << std::endl;
+    }
+}
+
 void test_usrp_device_creation() {
     std::cout << "\n=== Testing USRP Device Creation ===" << std::endl;
     
@@ -215,6 +485,10 @@ int main() {
     try {
         test_device_creation();
         test_simulation_device();
+        test_block_pool();
+        test_buffer_provider();
+        test_fallback_provider_drops();
+        test_pull_read();
         test_usrp_device_creation();
         test_device_polymorphism();
         
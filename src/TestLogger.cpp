@@ -0,0 +1,184 @@
+#include "Logger.h"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Collects what the logger thread writes instead of printing it
+struct Capture {
+	mutex lock;
+	vector<pair<LogLevel, string>> lines;
+
+	Capture() {
+		Logger::instance().setSink([this](LogLevel level, const string& line) {
+			lock_guard<mutex> guard(lock);
+			lines.emplace_back(level, line);
+		});
+	}
+	~Capture() {
+		Logger::instance().flush();
+		Logger::instance().setSink(nullptr);
+	}
+	vector<pair<LogLevel, string>> take() {
+		Logger::instance().flush();
+		lock_guard<mutex> guard(lock);
+		return std::move(lines);
+	}
+};
+
+void FormatsArguments() {
+	cout << "FormatsArguments" << endl;
+
+	Capture capture;
+	string name = "usrp";
+	LOG_INFO("{} at {} MHz, gain {} dB, locked {}, channel {}", name, 433.92, -3, true, 'A');
+	LOG_WARN("no placeholders");
+	LOG_ERROR("missing {} and {}", 7);
+	LOG_DEBUG("literal {}", "text");
+
+	auto lines = capture.take();
+	assert(lines.size() == 4);
+	assert(lines[0].second == "usrp at 433.92 MHz, gain -3 dB, locked true, channel A");
+	assert(lines[0].first == LogLevel::Info);
+	assert(lines[1].second == "no placeholders" && lines[1].first == LogLevel::Warning);
+	assert(lines[2].second == "missing 7 and {}" && lines[2].first == LogLevel::Error);
+	assert(lines[3].second == "literal text");
+
+	// Long strings are cut, not overflowed
+	LOG_INFO("{}", string(1000, 'x'));
+	lines = capture.take();
+	assert(lines.size() == 1 && lines[0].second == string(LogRecord::TEXT_BYTES, 'x'));
+	cout << "   PASSED" << endl;
+}
+
+void PerThreadOrder() {
+	cout << "PerThreadOrder" << endl;
+
+	Capture capture;
+	Logger::instance().setRateLimit(0);
+	const int num_threads = 4;
+	const int per_thread = 200;
+	vector<thread> threads;
+	for (int t = 0; t < num_threads; ++t) {
+		threads.emplace_back([t]() {
+			for (int i = 0; i < per_thread; ++i) {
+				LOG_INFO("{} {}", t, i);
+				if (i % 50 == 49) {
+					this_thread::sleep_for(chrono::milliseconds(20));
+				}
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	uint64_t dropped = Logger::instance().dropped();
+	auto lines = capture.take();
+	Logger::instance().setRateLimit(LogSite::DEFAULT_BURST);
+
+	// Every record arrives, each thread's in the order it wrote them
+	assert(dropped == 0);
+	assert(lines.size() == num_threads * per_thread);
+	vector<int> next(num_threads, 0);
+	for (const auto& line : lines) {
+		int t = stoi(line.second);
+		int i = stoi(line.second.substr(line.second.find(' ') + 1));
+		assert(i == next[t]);
+		++next[t];
+	}
+	cout << "   PASSED" << endl;
+}
+
+// One call site, as in a receive loop
+void ReportOverflow(int count) {
+	LOG_WARN("Overflow count: {}", count);
+}
+
+void RateLimitsSite() {
+	cout << "RateLimitsSite" << endl;
+
+	Capture capture;
+	for (int i = 0; i < 1000; ++i) {
+		ReportOverflow(i);
+	}
+	auto lines = capture.take();
+	assert(lines.size() == LogSite::DEFAULT_BURST);
+	assert(lines.back().second == "Overflow count: 9");
+
+	// Next window reports what was held back
+	this_thread::sleep_for(chrono::milliseconds(1100));
+	ReportOverflow(1000);
+	lines = capture.take();
+	assert(lines.size() == 1);
+	assert(lines[0].second == "Overflow count: 1000 (990 similar suppressed)");
+	cout << "   PASSED" << endl;
+}
+
+void DropsInsteadOfBlocking() {
+	cout << "DropsInsteadOfBlocking" << endl;
+
+	// Stall the logger thread inside the sink; producers must carry on
+	promise<void> entered;
+	promise<void> release;
+	shared_future<void> released = release.get_future().share();
+	atomic<bool> first{true};
+	mutex lock;
+	vector<string> lines;
+	Logger::instance().setSink([&](LogLevel, const string& line) {
+		if (first.exchange(false)) {
+			entered.set_value();
+			released.wait();
+		}
+		lock_guard<mutex> guard(lock);
+		lines.push_back(line);
+	});
+	Logger::instance().setRateLimit(0);
+
+	uint64_t dropped_before = Logger::instance().dropped();
+	LOG_INFO("stall");
+	entered.get_future().wait();
+
+	const int burst = 2000;
+	auto start = chrono::steady_clock::now();
+	for (int i = 0; i < burst; ++i) {
+		LOG_INFO("burst {}", i);
+	}
+	auto elapsed = chrono::steady_clock::now() - start;
+	uint64_t dropped = Logger::instance().dropped() - dropped_before;
+
+	release.set_value();
+	Logger::instance().flush();
+	Logger::instance().setSink(nullptr);
+	Logger::instance().setRateLimit(LogSite::DEFAULT_BURST);
+
+	assert(elapsed < chrono::milliseconds(100));
+	assert(dropped == burst - Logger::QUEUE_RECORDS);
+	assert(lines.size() == 1 + Logger::QUEUE_RECORDS + 1);
+	assert(lines[1] == "burst 0" && lines[Logger::QUEUE_RECORDS] == "burst " + to_string(Logger::QUEUE_RECORDS - 1));
+	assert(lines.back() == "Logger: " + to_string(dropped) + " records dropped, queue full");
+	cout << "   PASSED (" << burst << " writes in "
+	     << chrono::duration_cast<chrono::microseconds>(elapsed).count() << " us, "
+	     << dropped << " dropped)" << endl;
+}
+
+int main() {
+	cout << "=== Logger Test ===" << endl;
+	try {
+		FormatsArguments();
+		PerThreadOrder();
+		RateLimitsSite();
+		DropsInsteadOfBlocking();
+		cout << "\n=== ALL TESTS PASSED ===" << endl;
+		return 0;
+	} catch (const std::exception& e) {
+		cerr << "Test failed: " << e.what() << endl;
+		return -1;
+	}
+}
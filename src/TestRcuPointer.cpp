@@ -0,0 +1,150 @@
+#include "RcuPointer.h"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Stand-in for processing state; poisons itself when freed
+struct State {
+	static atomic<int> alive;
+	static constexpr uint64_t VALID = 0x600DF00D;
+
+	uint64_t magic = VALID;
+	int version;
+	vector<int> table;
+
+	explicit State(int v) : version(v), table(256, v) { alive.fetch_add(1); }
+	~State() { magic = 0; alive.fetch_sub(1); }
+};
+atomic<int> State::alive{0};
+
+void SwapAndReclaim() {
+	cout << "SwapAndReclaim" << endl;
+	{
+		RcuPointer<State> rcu(make_unique<State>(1));
+		RcuPointer<State>::Reader reader(rcu);
+
+		{
+			auto guard = reader.Read();
+			assert(guard && guard->version == 1);
+
+			// Swapped while in use: the open section keeps version 1
+			rcu.Publish(make_unique<State>(2));
+			assert(rcu.Current()->version == 2);
+			assert(rcu.Reclaim() == 1);
+			assert(guard->magic == State::VALID && guard->version == 1);
+			assert(State::alive.load() == 2);
+		}
+
+		// Section closed: nothing can hold version 1 any more
+		assert(rcu.Reclaim() == 0);
+		assert(State::alive.load() == 1);
+
+		// Any section open across a publish holds its version back; new
+		// sections see the new one
+		auto guard = reader.Read();
+		assert(guard->version == 2);
+		rcu.Publish(make_unique<State>(3));
+		assert(rcu.Reclaim() == 1);
+		assert(guard->version == 2);
+		RcuPointer<State>::Reader late_reader(rcu);
+		assert(late_reader.Read()->version == 3);
+		assert(rcu.Version() == 2);
+	}
+	assert(State::alive.load() == 0);
+	cout << "   PASSED" << endl;
+}
+
+void ReaderSlots() {
+	cout << "ReaderSlots" << endl;
+
+	RcuPointer<State> rcu;
+	assert(!RcuPointer<State>::Reader(rcu).Read());
+	{
+		vector<unique_ptr<RcuPointer<State>::Reader>> readers;
+		for (size_t i = 0; i < RcuPointer<State>::MAX_READERS; ++i) {
+			readers.push_back(make_unique<RcuPointer<State>::Reader>(rcu));
+		}
+		bool threw = false;
+		try {
+			RcuPointer<State>::Reader extra(rcu);
+		} catch (const runtime_error&) {
+			threw = true;
+		}
+		assert(threw);
+	}
+	// Slots come back with their readers
+	RcuPointer<State>::Reader again(rcu);
+	cout << "   PASSED" << endl;
+}
+
+void ConcurrentReaders() {
+	cout << "ConcurrentReaders" << endl;
+
+	// Readers use whatever is current per "block" while the writer swaps and
+	// reclaims as fast as it can; no reader may ever see freed state
+	const int num_readers = 3;
+	const auto duration = chrono::milliseconds(300);
+	atomic<bool> stop{false};
+	atomic<uint64_t> blocks{0};
+	{
+		RcuPointer<State> rcu(make_unique<State>(0));
+		vector<thread> readers;
+		for (int r = 0; r < num_readers; ++r) {
+			readers.emplace_back([&]() {
+				RcuPointer<State>::Reader reader(rcu);
+				int last_version = 0;
+				while (!stop.load()) {
+					auto state = reader.Read();
+					assert(state->magic == State::VALID);
+					assert(state->version >= last_version);	// Never goes back
+					last_version = state->version;
+					long sum = 0;
+					for (int value : state->table) {
+						sum += value;
+					}
+					assert(sum == 256L * state->version);
+					assert(state->magic == State::VALID);
+					blocks.fetch_add(1);
+				}
+			});
+		}
+
+		int version = 0;
+		size_t peak_retired = 0;
+		auto end = chrono::steady_clock::now() + duration;
+		while (chrono::steady_clock::now() < end) {
+			rcu.Publish(make_unique<State>(++version));
+			peak_retired = max(peak_retired, rcu.Retired());
+			rcu.Reclaim();
+			this_thread::yield();
+		}
+		stop.store(true);
+		for (auto& thread : readers) {
+			thread.join();
+		}
+		assert(rcu.Reclaim() == 0);
+		assert(State::alive.load() == 1);
+		cout << "   PASSED (" << version << " swaps, " << blocks.load() << " reader blocks, peak "
+		     << peak_retired << " retired)" << endl;
+	}
+	assert(State::alive.load() == 0);
+}
+
+int main() {
+	cout << "=== RcuPointer Test ===" << endl;
+	try {
+		SwapAndReclaim();
+		ReaderSlots();
+		ConcurrentReaders();
+		cout << "\n=== ALL TESTS PASSED ===" << endl;
+		return 0;
+	} catch (const std::exception& e) {
+		cerr << "Test failed: " << e.what() << endl;
+		return -1;
+	}
+}
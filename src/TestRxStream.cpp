@@ -0,0 +1,155 @@
+#include "RxStream.h"
+#include <iostream>
+#include <cassert>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+typedef complex<float> Sample;
+
+// Commits count samples valued from, from, ... like a device block
+static size_t Produce(RxStream& stream, uint64_t& index, size_t count, uint32_t flags = 0) {
+	RxBufferProvider::Span span = stream.acquire(count);
+	if (!span.data) {
+		return 0;
+	}
+	for (size_t i = 0; i < span.size; ++i) {
+		span.data[i] = Sample(static_cast<float>(index + i), 0.0f);
+	}
+	SampleMetadata meta;
+	meta.sample_index = index;
+	meta.flags = flags;
+	meta.host_time_ns = 1000 + index;
+	stream.commit(span.size, meta);
+	index += span.size;
+	return span.size;
+}
+
+void ReadsBlocksInOrder() {
+	cout << "ReadsBlocksInOrder" << endl;
+
+	RxStream stream(64, 8);
+	uint64_t index = 0;
+	Produce(stream, index, 10);
+	Produce(stream, index, 10);
+
+	// One read may span unflagged blocks; metadata follows dest[0]
+	vector<Sample> out(64);
+	RxStream::ReadResult r = stream.read(out.data(), 15, chrono::milliseconds(0));
+	assert(r.count == 15 && r.metadata.sample_index == 0 && r.block_offset == 0);
+	assert(out[14].real() == 14.0f);
+	r = stream.read(out.data(), 64, chrono::milliseconds(0));
+	assert(r.count == 5 && r.metadata.sample_index == 15 && r.block_offset == 5);
+	assert(r.metadata.host_time_ns == 1010);
+	assert(out[0].real() == 15.0f);
+
+	// Nothing there: times out, not end of stream
+	r = stream.read(out.data(), 64, chrono::milliseconds(1));
+	assert(r.count == 0 && !r.end_of_stream);
+	cout << "   PASSED" << endl;
+}
+
+void StopsAtFlaggedBlocks() {
+	cout << "StopsAtFlaggedBlocks" << endl;
+
+	RxStream stream(64, 8);
+	uint64_t index = 0;
+	Produce(stream, index, 8);
+	index += 100;	// Lost at the device
+	Produce(stream, index, 8, SampleMetadata::DISCONTINUITY);
+	Produce(stream, index, 8);
+
+	vector<Sample> out(64);
+	RxStream::ReadResult r = stream.read(out.data(), 64, chrono::milliseconds(0));
+	assert(r.count == 8 && r.metadata.flags == 0);
+	r = stream.read(out.data(), 4, chrono::milliseconds(0));
+	assert(r.count == 4 && r.metadata.sample_index == 108);
+	assert(r.metadata.hasFlag(SampleMetadata::DISCONTINUITY));
+	// Rest of the flagged block does not repeat the flag
+	r = stream.read(out.data(), 64, chrono::milliseconds(0));
+	assert(r.count == 12 && r.metadata.sample_index == 112 && r.metadata.flags == 0);
+	assert(out[11].real() == 123.0f);
+	cout << "   PASSED" << endl;
+}
+
+void FullRingDrops() {
+	cout << "FullRingDrops" << endl;
+
+	// Never overwrites what was not read yet
+	RxStream stream(16, 4);
+	uint64_t index = 0;
+	assert(Produce(stream, index, 16) == 16);
+	assert(Produce(stream, index, 4) == 0);
+	assert(stream.droppedBlocks() == 1);
+
+	// Block table full counts too
+	vector<Sample> out(16);
+	assert(stream.read(out.data(), 16, chrono::milliseconds(0)).count == 16);
+	for (int i = 0; i < 4; ++i) {
+		Produce(stream, index, 1);
+	}
+	assert(Produce(stream, index, 1) == 0);
+	assert(stream.droppedBlocks() == 2);
+
+	// Spans stop at the wrap; the read copies across it
+	assert(stream.read(out.data(), 16, chrono::milliseconds(0)).count == 4);
+	assert(Produce(stream, index, 16) == 12);
+	assert(Produce(stream, index, 16) == 4);
+	RxStream::ReadResult r = stream.read(out.data(), 16, chrono::milliseconds(0));
+	assert(r.count == 16 && out[0].real() == 20.0f && out[15].real() == 35.0f);
+	cout << "   PASSED" << endl;
+}
+
+void BlockingReader() {
+	cout << "BlockingReader" << endl;
+
+	// Reader on its own thread against a producer committing as fast as it can
+	const uint64_t total = 1 << 22;
+	RxStream stream(1 << 14, 256);
+	thread producer([&]() {
+		uint64_t index = 0;
+		while (index < total) {
+			if (Produce(stream, index, min<uint64_t>(1000, total - index)) == 0) {
+				this_thread::yield();
+			}
+		}
+		stream.close();
+	});
+
+	vector<Sample> out(4096);
+	uint64_t expected = 0;
+	size_t reads = 0;
+	while (true) {
+		RxStream::ReadResult r = stream.read(out.data(), out.size(), chrono::milliseconds(100));
+		if (r.end_of_stream) {
+			break;
+		}
+		assert(r.metadata.sample_index == expected);
+		for (size_t i = 0; i < r.count; ++i) {
+			assert(out[i].real() == static_cast<float>(expected + i));
+		}
+		expected += r.count;
+		++reads;
+	}
+	producer.join();
+	assert(expected == total);
+	assert(stream.isClosed() && stream.available() == 0);
+	cout << "   PASSED (" << reads << " reads)" << endl;
+}
+
+int main() {
+	cout << "=== RxStream Test ===" << endl;
+	try {
+		ReadsBlocksInOrder();
+		StopsAtFlaggedBlocks();
+		FullRingDrops();
+		BlockingReader();
+		cout << "\n=== ALL TESTS PASSED ===" << endl;
+		return 0;
+	} catch (const std::exception& e) {
+		cerr << "Test failed: " << e.what() << endl;
+		return -1;
+	}
+}
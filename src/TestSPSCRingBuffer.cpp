@@ -0,0 +1,145 @@
+#include "SPSCRingBuffer.h"
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <complex>
+#include <vector>
+
+using namespace std;
+
+void Basics() {
+	cout << "Basics:" << endl;
+
+	SPSCRingBuffer<float> buffer(5);
+
+	assert(buffer.IsEmpty());
+	assert(buffer.Capacity() == 8);		// Rounded to power of two
+	buffer.Push(1.0f);
+	buffer.Push(2.0f);
+	buffer.Push(3.0f);
+	assert(buffer.Size() == 3);
+	float value;
+	assert(buffer.Pop(value));
+	assert(value == 1.0f);
+	assert(buffer.Pop(value));
+	assert(value == 2.0f);
+	assert(buffer.Size() == 1);
+
+	cout << "   PASSED" << endl;
+}
+
+void Overflow() {
+	cout << "Overflow" << endl;
+
+	SPSCRingBuffer<int> buffer(4);
+	for (int i = 1; i <= 6; ++i) {
+		buffer.Push(i);
+	}
+	assert(buffer.IsFull());
+	int value;
+	assert(buffer.Pop(value));
+	assert(value == 3);
+	assert(buffer.Overruns() == 2);
+	assert(buffer.Size() == 3);
+	cout << "   PASSED" << endl;
+}
+
+void ReserveCommit() {
+	cout << "ReserveCommit" << endl;
+
+	SPSCRingBuffer<int> buffer(8);
+	int seed[6] = {0, 1, 2, 3, 4, 5};
+	buffer.PushBulk(seed, 6);
+
+	// Wraps: two spans
+	auto spans = buffer.Reserve(5);
+	assert(spans.first.size == 2);
+	assert(spans.second.size == 3);
+	for (size_t i = 0; i < spans.first.size; ++i) spans.first.data[i] = 6 + int(i);
+	for (size_t i = 0; i < spans.second.size; ++i) spans.second.data[i] = 8 + int(i);
+	buffer.Commit(4);	// Partial commit is allowed
+
+	// The uncommitted fifth slot still cost the oldest element
+	assert(buffer.Size() == 7);
+	int data[8];
+	buffer.CopyLatest(data, 8);
+	for (int i = 0; i < 7; ++i) {
+		assert(data[i] == i + 3);
+	}
+	assert(data[7] == 0);
+	cout << "   PASSED" << endl;
+}
+
+void Latest() {
+	cout << "Latest" << endl;
+
+	SPSCRingBuffer<float> buffer(4);
+	for (int i = 1; i <= 3; ++i) {
+		buffer.Push(float(i));
+	}
+	float big_data[6];
+	buffer.CopyLatest(big_data, 6);
+	for (int i = 0; i < 3; ++i) {
+		assert(big_data[i] == float(i + 1));
+	}
+	for (int i = 3; i < 6; ++i) {
+		assert(big_data[i] == 0.0f);
+	}
+	cout << "   PASSED" << endl;
+}
+
+void Concurrent() {
+	cout << "Concurrent" << endl;
+
+	// Consumer must see a gap free, strictly increasing sequence apart from
+	// overruns which are accounted for. The producer waits for room except on
+	// every 16th block, so most items are read and overruns still race reads
+	SPSCRingBuffer<size_t> buffer(1024);
+	const size_t total = 1 << 20;
+
+	std::thread producer([&]() {
+		std::vector<size_t> block(333);
+		size_t next = 0;
+		for (size_t blocks = 0; next < total; ++blocks) {
+			size_t n = std::min(block.size(), total - next);
+			for (size_t i = 0; i < n; ++i) block[i] = next++;
+			while (blocks % 16 != 0 && buffer.Size() + n > 1024) {
+				std::this_thread::yield();
+			}
+			buffer.PushBulk(block.data(), n);
+		}
+	});
+
+	std::vector<size_t> out(256);
+	size_t expected = 0;
+	size_t seen = 0;
+	while (expected < total) {
+		size_t n = buffer.Read(out.data(), out.size());
+		for (size_t i = 0; i < n; ++i) {
+			assert(out[i] >= expected);
+			expected = out[i] + 1;
+			++seen;
+		}
+	}
+	producer.join();
+	assert(seen + buffer.Overruns() == total);
+	assert(seen >= total / 2);
+	assert(buffer.Overruns() > 0);
+	cout << "   PASSED (" << seen << " seen, " << buffer.Overruns() << " overrun)" << endl;
+}
+
+int main() {
+	cout << "=== SPSCRingBuffer Test ===" << endl;
+	try {
+		Basics();
+		Overflow();
+		ReserveCommit();
+		Latest();
+		Concurrent();
+		cout << "\n=== ALL TESTS PASSED ===" << endl;
+		return 0;
+	} catch (const std::exception& e) {
+		cerr << "Test failed: " << e.what() << endl;
+		return -1;
+	}
+}
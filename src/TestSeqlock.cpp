@@ -0,0 +1,110 @@
+#include "Seqlock.h"
+#include "Telemetry.h"
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <atomic>
+
+using namespace std;
+
+// Big enough to span several words, every field carries the same value
+struct Snapshot {
+	uint64_t a = 0;
+	double b = 0.0;
+	uint64_t c = 0;
+	int64_t d = 0;
+	uint32_t e = 0;
+};
+
+void StoreLoad() {
+	cout << "StoreLoad" << endl;
+
+	Seqlock<Snapshot> lock;
+	assert(lock.Version() == 1);	// Default value counts as a write
+	Snapshot s = lock.Load();
+	assert(s.a == 0 && s.e == 0);
+
+	Snapshot t;
+	t.a = 1; t.b = 2.5; t.c = 3; t.d = -4; t.e = 5;
+	lock.Store(t);
+	s = lock.Load();
+	assert(s.a == 1 && s.b == 2.5 && s.c == 3 && s.d == -4 && s.e == 5);
+
+	lock.Update([](Snapshot& v) { v.c += 10; });
+	assert(lock.Load().c == 13 && lock.Load().a == 1);
+	assert(lock.Version() == 3);
+	cout << "   PASSED" << endl;
+}
+
+void NoTornReads() {
+	cout << "NoTornReads" << endl;
+
+	// Writer keeps going until the reader has checked enough snapshots
+	const size_t reads = 1000000;
+	Seqlock<Snapshot> lock;
+	atomic<bool> done{false};
+	atomic<uint64_t> written{0};
+
+	thread writer([&]() {
+		uint64_t i = 0;
+		while (!done.load(memory_order_relaxed)) {
+			++i;
+			Snapshot s;
+			s.a = i; s.b = double(i); s.c = i; s.d = int64_t(i); s.e = uint32_t(i);
+			lock.Store(s);
+		}
+		written.store(i);
+	});
+
+	uint64_t last = 0;
+	for (size_t r = 0; r < reads; ++r) {
+		Snapshot s = lock.Load();
+		assert(s.b == double(s.a) && s.c == s.a && s.d == int64_t(s.a) && s.e == uint32_t(s.a));
+		assert(s.a >= last);
+		last = s.a;
+	}
+	done.store(true);
+	writer.join();
+	assert(lock.Load().a == written.load());
+	cout << "   PASSED (" << reads << " reads, " << written.load() << " writes)" << endl;
+}
+
+void ConcurrentWriters() {
+	cout << "ConcurrentWriters" << endl;
+
+	// RX thread and a setter both writing the same block must not lose updates
+	StageProbe probe;
+	const int per_thread = 200000;
+	auto work = [&]() {
+		for (int i = 0; i < per_thread; ++i) {
+			probe.record(100, 1);
+		}
+	};
+	thread t1(work);
+	thread t2(work);
+	t1.join();
+	t2.join();
+
+	StageTelemetry stage = probe.snapshot();
+	assert(stage.runs == 2 * per_thread);
+	assert(stage.items == 2 * per_thread);
+	assert(stage.avg_ns == 100 && stage.max_ns == 100);
+
+	probe.reset();
+	assert(probe.snapshot().runs == 0);
+	cout << "   PASSED" << endl;
+}
+
+int main() {
+	cout << "=== Seqlock Test ===" << endl;
+	try {
+		StoreLoad();
+		NoTornReads();
+		ConcurrentWriters();
+		cout << "\n=== ALL TESTS PASSED ===" << endl;
+		return 0;
+	} catch (const std::exception& e) {
+		cerr << "Test failed: " << e.what() << endl;
+		return -1;
+	}
+}
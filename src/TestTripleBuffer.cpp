@@ -0,0 +1,78 @@
+#include "TripleBuffer.h"
+#include <iostream>
+#include <cassert>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+void LatestWins() {
+	cout << "LatestWins" << endl;
+
+	TripleBuffer<int> mailbox(0);
+	assert(!mailbox.Update());
+	assert(mailbox.Read() == 0);
+
+	for (int i = 1; i <= 5; ++i) {
+		mailbox.WriteBuffer() = i;
+		mailbox.Publish();
+	}
+	assert(mailbox.HasNew());
+	assert(mailbox.Update());
+	assert(mailbox.Read() == 5);
+
+	// Nothing new, front stays put
+	assert(!mailbox.Update());
+	assert(mailbox.Read() == 5);
+	assert(mailbox.Published() == 5);
+	cout << "   PASSED" << endl;
+}
+
+void CompleteFrames() {
+	cout << "CompleteFrames" << endl;
+
+	// Every element of a frame carries the frame number; a torn frame
+	// would mix two numbers
+	const size_t frame_size = 4096;
+	const int frames = 20000;
+	TripleBuffer<vector<int>> mailbox(vector<int>(frame_size, -1));
+
+	thread producer([&]() {
+		for (int f = 0; f < frames; ++f) {
+			vector<int>& frame = mailbox.WriteBuffer();
+			for (size_t i = 0; i < frame_size; ++i) frame[i] = f;
+			mailbox.Publish();
+		}
+	});
+
+	int last = -1;
+	size_t seen = 0;
+	while (last < frames - 1) {
+		if (!mailbox.Update()) {
+			this_thread::yield();
+			continue;
+		}
+		const vector<int>& frame = mailbox.Read();
+		for (size_t i = 1; i < frame_size; ++i) {
+			assert(frame[i] == frame[0]);
+		}
+		assert(frame[0] > last);
+		last = frame[0];
+		++seen;
+	}
+	producer.join();
+	cout << "   PASSED (" << seen << "/" << frames << " frames seen)" << endl;
+}
+
+int main() {
+	cout << "=== TripleBuffer Test ===" << endl;
+	try {
+		LatestWins();
+		CompleteFrames();
+		cout << "\n=== ALL TESTS PASSED ===" << endl;
+		return 0;
+	} catch (const std::exception& e) {
+		cerr << "Test failed: " << e.what() << endl;
+		return -1;
+	}
+}
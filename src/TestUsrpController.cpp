@@ -113,7 +113,8 @@ void TestRx(UsrpController& usrp) {
 	float max_magnitude = 0.0f;
 	float avg_magnitude = 0.0f;
 
-	auto callback = [&](const std::complex<float>* samples, size_t count) {
+	auto callback = [&](const std::complex<float>* samples, size_t count,
+			const SampleMetadata&) {
         samples_received += count;
         
         float batch_sum = 0.0f;
@@ -0,0 +1,239 @@
+#include "WorkStealingPool.h"
+#include "STFTSpectrogram.h"
+#include "STFTReference.h"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+void CoversEveryIndex() {
+	cout << "CoversEveryIndex" << endl;
+
+	// Every index exactly once, for counts that do and don't divide evenly
+	WorkStealingPool pool(4);
+	for (size_t count : {1, 3, 16, 17, 1000, 4099}) {
+		for (size_t grain : {1, 7, 64}) {
+			vector<atomic<int>> hits(count);
+			pool.parallelFor(count, grain, [&](size_t begin, size_t end, size_t worker) {
+				assert(worker < pool.numWorkers());
+				assert(end - begin <= grain);
+				for (size_t i = begin; i < end; ++i) {
+					hits[i].fetch_add(1);
+				}
+			});
+			for (size_t i = 0; i < count; ++i) {
+				assert(hits[i].load() == 1);
+			}
+		}
+	}
+	cout << "   PASSED" << endl;
+}
+
+void StealsFromSlowWorker() {
+	cout << "StealsFromSlowWorker" << endl;
+
+	// One slow chunk at the head of every worker's queue: the others finish
+	// their own and must take the rest off the slow queues
+	WorkStealingPool pool(4);
+	const size_t chunks = 64;
+	vector<atomic<int>> hits(chunks);
+	pool.parallelFor(chunks, 1, [&](size_t begin, size_t, size_t) {
+		if (begin % (chunks / 4) == 0) {
+			this_thread::sleep_for(chrono::milliseconds(20));
+		}
+		hits[begin].fetch_add(1);
+	});
+	for (size_t i = 0; i < chunks; ++i) {
+		assert(hits[i].load() == 1);
+	}
+	assert(pool.steals() > 0);
+	cout << "   PASSED (" << pool.steals() << " steals)" << endl;
+}
+
+void ConcurrentCallers() {
+	cout << "ConcurrentCallers" << endl;
+
+	// Callers from several threads are serialized, each sees its own job
+	// finish, and no worker index is in use twice at once, including on the
+	// single chunk path that runs inline
+	WorkStealingPool pool(3);
+	atomic<size_t> total{0};
+	atomic<bool> in_use[3] = {};
+	vector<thread> callers;
+	for (int c = 0; c < 4; ++c) {
+		callers.emplace_back([&]() {
+			for (int rep = 0; rep < 200; ++rep) {
+				size_t count = rep % 2 ? 100 : 3;
+				atomic<size_t> sum{0};
+				pool.parallelFor(count, 3, [&](size_t begin, size_t end, size_t worker) {
+					assert(!in_use[worker].exchange(true));
+					sum.fetch_add(end - begin);
+					this_thread::yield();
+					in_use[worker].store(false);
+				});
+				assert(sum.load() == count);
+				total.fetch_add(sum.load());
+			}
+		});
+	}
+	for (auto& caller : callers) {
+		caller.join();
+	}
+	assert(total.load() == 4 * 100 * (100 + 3));
+	cout << "   PASSED" << endl;
+}
+
+void STFTBitIdentical() {
+	cout << "STFTBitIdentical" << endl;
+
+	// Parallel frames must reproduce the serial image bit for bit
+	const int fft_size = 256;
+	const int stride = 128;
+	mt19937 rng(7);
+	normal_distribution<float> noise(0.0f, 1.0f);
+
+	for (int frames : {1, 15, 120, 333}) {
+		size_t num_samples = fft_size + static_cast<size_t>(frames - 1) * stride;
+		vector<complex<float>> iq(num_samples);
+		for (size_t i = 0; i < num_samples; ++i) {
+			float tone = cos(0.05f * i);
+			iq[i] = complex<float>(tone + 0.1f * noise(rng), 0.1f * noise(rng));
+		}
+
+		STFTSpectrogram stft(fft_size, stride, 1e6f);
+		vector<float> serial(fft_size * frames);
+		float* serial_ptr = serial.data();
+		int bins = 0;
+		int time_frames = 0;
+		assert(stft.computeSpectrogram(iq.data(), num_samples, &serial_ptr, &bins, &time_frames));
+		assert(bins == fft_size && time_frames == frames);
+
+		for (size_t workers : {2, 3, 8}) {
+			WorkStealingPool pool(workers);
+			stft.setThreadPool(&pool);
+			vector<float> parallel(fft_size * frames, -1.0f);
+			float* parallel_ptr = parallel.data();
+			assert(stft.computeSpectrogram(iq.data(), num_samples, &parallel_ptr, &bins, &time_frames));
+			assert(memcmp(serial.data(), parallel.data(), serial.size() * sizeof(float)) == 0);
+		}
+		stft.setThreadPool(nullptr);
+	}
+	cout << "   PASSED" << endl;
+}
+
+// Direct DFT of each Blackman windowed frame, DC centred, highest bin on top
+static vector<double> ReferenceSTFT(const vector<complex<float>>& iq, int fft_size, int stride,
+                                    int frames) {
+	vector<double> power(static_cast<size_t>(fft_size) * frames);
+	double peak = 0.0;
+	for (int frame = 0; frame < frames; ++frame) {
+		for (int k = 0; k < fft_size; ++k) {
+			complex<double> sum = 0.0;
+			for (int n = 0; n < fft_size; ++n) {
+				size_t i = static_cast<size_t>(frame) * stride + n;
+				if (i >= iq.size()) break;
+				double w = 0.42 - 0.5 * cos(2.0 * M_PI * n / (fft_size - 1)) +
+				           0.08 * cos(4.0 * M_PI * n / (fft_size - 1));
+				sum += w * complex<double>(iq[i]) * polar(1.0, -2.0 * M_PI * k * n / fft_size);
+			}
+			int shifted = (k + fft_size / 2) % fft_size;
+			power[static_cast<size_t>(fft_size - 1 - shifted) * frames + frame] = norm(sum);
+			peak = max(peak, norm(sum));
+		}
+	}
+	for (double& p : power) {
+		p = 10.0 * log10(max(p, peak * 1e-10));
+	}
+	return power;
+}
+
+void STFTMatchesReference() {
+	cout << "STFTMatchesReference" << endl;
+
+	// Shift, reversal and dB folded into the batched passes still land every
+	// bin where the textbook STFT puts it; the big tile first, so the smaller
+	// ones reuse its buffers, and a short one that is zero padded
+	const int fft_size = 64;
+	const int stride = 24;
+	mt19937 rng(11);
+	normal_distribution<float> noise(0.0f, 1.0f);
+	STFTSpectrogram stft(fft_size, stride, 1e6f);
+
+	for (size_t num_samples : {size_t(64 + 40 * 24), size_t(64 + 3 * 24 + 5), size_t(40)}) {
+		vector<complex<float>> iq(num_samples);
+		for (size_t i = 0; i < num_samples; ++i) {
+			iq[i] = polar(1.0f, 0.7f * i) + complex<float>(0.01f * noise(rng), 0.01f * noise(rng));
+		}
+		int frames = num_samples < static_cast<size_t>(fft_size)
+		           ? 1 : static_cast<int>((num_samples - fft_size) / stride) + 1;
+		vector<double> expected = ReferenceSTFT(iq, fft_size, stride, frames);
+
+		vector<float> image(fft_size * frames);
+		float* image_ptr = image.data();
+		int bins = 0;
+		int time_frames = 0;
+		assert(stft.computeSpectrogram(iq.data(), num_samples, &image_ptr, &bins, &time_frames));
+		assert(bins == fft_size && time_frames == frames);
+		for (size_t i = 0; i < image.size(); ++i) {
+			assert(fabs(image[i] - expected[i]) < 0.01);
+		}
+	}
+	cout << "   PASSED" << endl;
+}
+
+void STFTMatchesPerFrame() {
+	cout << "STFTMatchesPerFrame" << endl;
+
+	// The batched passes reproduce the old per-frame path bit for bit, whole
+	// tiles and short zero padded ones
+	mt19937 rng(5);
+	normal_distribution<float> noise(0.0f, 1.0f);
+	for (int fft_size : {64, 256, 1024}) {
+		const int stride = fft_size / 2;
+		STFTSpectrogram stft(fft_size, stride, 1e6f);
+		PerFrameSTFT reference(fft_size, stride);
+		for (size_t num_samples : {size_t(fft_size) + 119 * stride, size_t(fft_size) + 7 * stride + 3,
+		                           size_t(fft_size / 2)}) {
+			vector<complex<float>> iq(num_samples);
+			for (size_t i = 0; i < num_samples; ++i) {
+				iq[i] = polar(1.0f, 0.3f * i) + complex<float>(0.1f * noise(rng), 0.1f * noise(rng));
+			}
+			vector<float> expected(fft_size * 120);
+			int frames = reference.compute(iq.data(), num_samples, expected.data());
+
+			vector<float> image(fft_size * 120, -1.0f);
+			float* image_ptr = image.data();
+			int bins = 0;
+			int time_frames = 0;
+			assert(stft.computeSpectrogram(iq.data(), num_samples, &image_ptr, &bins, &time_frames));
+			assert(time_frames == frames);
+			assert(memcmp(image.data(), expected.data(), size_t(fft_size) * frames * sizeof(float)) == 0);
+		}
+	}
+	cout << "   PASSED" << endl;
+}
+
+int main() {
+	cout << "=== WorkStealingPool Test ===" << endl;
+	try {
+		CoversEveryIndex();
+		StealsFromSlowWorker();
+		ConcurrentCallers();
+		STFTBitIdentical();
+		STFTMatchesReference();
+		STFTMatchesPerFrame();
+		cout << "\n=== ALL TESTS PASSED ===" << endl;
+		return 0;
+	} catch (const std::exception& e) {
+		cerr << "Test failed: " << e.what() << endl;
+		return -1;
+	}
+}
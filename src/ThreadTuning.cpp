@@ -0,0 +1,177 @@
+#include "ThreadTuning.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+
+// Affinity of the process as launched (taskset, cgroup cpuset), taken during
+// static initialization before any thread could have been pinned
+cpu_set_t startupAffinity() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return set;
+}
+
+const cpu_set_t STARTUP_AFFINITY = startupAffinity();
+
+// Per-thread nice needs the kernel thread id, not the pthread handle
+pid_t currentTid() {
+    return static_cast<pid_t>(syscall(SYS_gettid));
+}
+
+}
+
+bool parseCpuList(const std::string& text, std::vector<int>& cpus) {
+    if (text.empty() || text.back() == ',') {
+        return false;
+    }
+    std::vector<int> parsed;
+    std::stringstream list(text);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        if (item.empty()) {
+            return false;
+        }
+        size_t dash = item.find('-');
+        try {
+            size_t used = 0;
+            int first = std::stoi(item.substr(0, dash), &used);
+            if (used != (dash == std::string::npos ? item.size() : dash)) {
+                return false;
+            }
+            int last = first;
+            if (dash != std::string::npos) {
+                std::string tail = item.substr(dash + 1);
+                last = std::stoi(tail, &used);
+                if (used != tail.size()) {
+                    return false;
+                }
+            }
+            if (first < 0 || last < first || last >= CPU_SETSIZE) {
+                return false;
+            }
+            for (int cpu = first; cpu <= last; ++cpu) {
+                parsed.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    if (parsed.empty()) {
+        return false;
+    }
+    std::sort(parsed.begin(), parsed.end());
+    parsed.erase(std::unique(parsed.begin(), parsed.end()), parsed.end());
+    cpus = parsed;
+    return true;
+}
+
+std::string formatCpuList(const std::vector<int>& cpus) {
+    if (cpus.empty()) {
+        return "any";
+    }
+    std::ostringstream out;
+    for (size_t i = 0; i < cpus.size(); ) {
+        size_t j = i;
+        while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) {
+            ++j;
+        }
+        out << (i ? "," : "") << cpus[i];
+        if (j > i) {
+            out << "-" << cpus[j];
+        }
+        i = j + 1;
+    }
+    return out.str();
+}
+
+std::string describeThreadPolicy(const ThreadPolicy& policy) {
+    std::ostringstream out;
+    out << "cpus " << formatCpuList(policy.cpus);
+    if (policy.fifo_priority > 0) {
+        out << ", SCHED_FIFO " << policy.fifo_priority;
+    } else {
+        out << ", nice " << policy.nice;
+    }
+    return out.str();
+}
+
+std::string describeCurrentThread() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+
+    std::ostringstream out;
+    out << "cpus " << formatCpuList(cpus);
+    int policy = SCHED_OTHER;
+    sched_param param{};
+    pthread_getschedparam(pthread_self(), &policy, &param);
+    if (policy == SCHED_FIFO || policy == SCHED_RR) {
+        out << (policy == SCHED_FIFO ? ", SCHED_FIFO " : ", SCHED_RR ") << param.sched_priority;
+    } else {
+        errno = 0;
+        int nice = getpriority(PRIO_PROCESS, currentTid());
+        out << ", nice " << (errno ? 0 : nice);
+    }
+    return out.str();
+}
+
+bool applyThreadPolicy(const ThreadPolicy& policy, const std::string& label) {
+    bool ok = true;
+
+    cpu_set_t set = STARTUP_AFFINITY;
+    if (!policy.cpus.empty()) {
+        CPU_ZERO(&set);
+        for (int cpu : policy.cpus) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (err != 0 && !policy.cpus.empty()) {
+        std::cerr << "Thread " << label << ": cannot pin to cpus " << formatCpuList(policy.cpus)
+                  << ": " << std::strerror(err) << std::endl;
+        ok = false;
+    }
+
+    if (policy.fifo_priority > 0) {
+        sched_param param{};
+        param.sched_priority = std::min(policy.fifo_priority, sched_get_priority_max(SCHED_FIFO));
+        err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (err != 0) {
+            std::cerr << "Thread " << label << ": SCHED_FIFO " << param.sched_priority
+                      << " refused: " << std::strerror(err) << std::endl;
+            ok = false;
+        }
+    } else if (policy.nice != 0) {
+        if (setpriority(PRIO_PROCESS, currentTid(), policy.nice) != 0) {
+            std::cerr << "Thread " << label << ": nice " << policy.nice
+                      << " refused: " << std::strerror(errno) << std::endl;
+            ok = false;
+        }
+    }
+
+    if (!policy.isDefault()) {
+        std::cout << "Thread " << label << ": " << describeCurrentThread() << std::endl;
+    }
+    return ok;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * Core placement and scheduling of one of the application's threads
+ *
+ * Applied by the thread itself when it starts. Real-time priority needs
+ * CAP_SYS_NICE or an rtprio limit (limits.conf), a negative nice level the
+ * same; without them the request is reported and the thread carries on with
+ * normal scheduling.
+ */
+struct ThreadPolicy {
+    std::vector<int> cpus;      // Cores the thread may run on, empty = any
+    int fifo_priority = 0;      // SCHED_FIFO priority 1-99, 0 = normal scheduling
+    int nice = 0;               // Nice level under normal scheduling
+
+    bool isDefault() const { return cpus.empty() && fifo_priority == 0 && nice == 0; }
+};
+
+/**
+ * Parse a core list such as "3", "0,2" or "4-7,9"
+ * @return false on malformed input, cpus is left untouched
+ */
+bool parseCpuList(const std::string& text, std::vector<int>& cpus);
+
+// Inverse of parseCpuList, ranges collapsed ("4-7,9"), "any" if empty
+std::string formatCpuList(const std::vector<int>& cpus);
+
+// Requested settings, for configuration summaries
+std::string describeThreadPolicy(const ThreadPolicy& policy);
+
+// Settings in effect for the calling thread, read back from the kernel
+std::string describeCurrentThread();
+
+/**
+ * Apply policy to the calling thread and log the effective settings
+ *
+ * A thread inherits its creator's affinity, so a policy without cpus resets
+ * the thread to the cores the process started with; a pinned GUI thread
+ * does not drag the RX or DSP threads it starts onto its own core.
+ * @param label Shown in the log line
+ * @return false if any part of the request was refused
+ */
+bool applyThreadPolicy(const ThreadPolicy& policy, const std::string& label);
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+/**
+ * Wait-free "latest value" mailbox between one producer and one consumer
+ *
+ * Three copies of T: the producer fills its back buffer and Publish()es it,
+ * the consumer Update()s to the newest published one and reads its front
+ * buffer. Neither side ever blocks or copies, frames the consumer did not get
+ * to are simply replaced, and the consumer always sees a complete frame
+ * because the producer can never touch the front buffer.
+ *
+ * Intended for DSP results handed to the GUI (spectra, STFT images), where
+ * only the newest frame matters.
+ */
+template<typename T>
+class TripleBuffer {
+public:
+	TripleBuffer() = default;
+
+	// All three slots start as copies of initial, e.g. a presized vector
+	explicit TripleBuffer(const T& initial)
+		: buffers_{initial, initial, initial} {
+	}
+
+	TripleBuffer(const TripleBuffer&) = delete;
+	TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+	/********************************PRODUCER**********************************/
+
+	// Producer's private slot; contents are whatever it held three frames ago
+	T& WriteBuffer() {
+		return buffers_[back_];
+	}
+
+	// Hand the write buffer to the consumer and take the spare one back
+	void Publish() {
+		uint8_t previous = middle_.exchange(back_ | FRESH, std::memory_order_acq_rel);
+		back_ = previous & INDEX_MASK;
+		published_.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	/********************************CONSUMER**********************************/
+
+	// Switch to the newest published frame, false if nothing new arrived
+	bool Update() {
+		if (!(middle_.load(std::memory_order_relaxed) & FRESH)) {
+			return false;
+		}
+		uint8_t previous = middle_.exchange(front_, std::memory_order_acq_rel);
+		front_ = previous & INDEX_MASK;
+		return true;
+	}
+
+	// Frame from the last successful Update(), stable until the next one
+	const T& Read() const {
+		return buffers_[front_];
+	}
+
+	// Frames published so far, readable from any thread
+	uint64_t Published() const {
+		return published_.load(std::memory_order_relaxed);
+	}
+
+	// Something was published that Update() has not picked up yet
+	bool HasNew() const {
+		return (middle_.load(std::memory_order_relaxed) & FRESH) != 0;
+	}
+
+private:
+	static constexpr uint8_t INDEX_MASK = 0x3;
+	static constexpr uint8_t FRESH = 0x4;	// Middle slot holds an unread frame
+
+	T buffers_[3];
+	uint8_t back_ = 0;						// Producer only
+	std::atomic<uint8_t> middle_{1};		// Exchanged by both sides
+	uint8_t front_ = 2;						// Consumer only
+	std::atomic<uint64_t> published_{0};
+};
@@ -33,6 +33,9 @@ bool USRPDevice::initialize(const SDRConfig& config) {
     if (!config.time_source.empty()) {
         controller_->SetTimeSource(config.time_source);
     }
+    controller_->SetThreadPolicy(config.rx_thread, config.uhd_thread_priority);
+    publishControllerTuning();
+    publishState(true, false);
     clearError();
     return true;
 }
@@ -42,6 +45,7 @@ void USRPDevice::shutdown() {
         controller_->Shutdown();
     }
     current_config_ = SDRConfig();
+    publishState(false, false);
 }
 
 bool USRPDevice::isInitialized() const {
@@ -53,17 +57,85 @@ bool USRPDevice::startReceiving(SampleCallback callback, size_t buffer_size) {
         setError("Device not initialized");
         return false;
     }
-    bool success = controller_->StartReceiving(callback, buffer_size);
+    publishState(true, true);
+    bool success = controller_->StartReceiving(
+        [this, callback](const std::complex<float>* samples, size_t count,
+                         const SampleMetadata& metadata) {
+            SampleMetadata tagged = metadata;
+            tagged.flags |= takeRetuneFlag();
+            callback(samples, count, tagged);
+            publishRxBlock(count, controller_->GetOverflowCount(), metadata.host_time_ns);
+        }, buffer_size);
     if (!success) {
+        publishState(isInitialized(), isReceiving());
         syncError();
     }
     return success;
 }
 
+bool USRPDevice::startReceivingBlocks(BlockCallback callback, size_t buffer_size,
+                                      size_t num_blocks) {
+    if (!controller_) {
+        setError("Device not initialized");
+        return false;
+    }
+    if (isReceiving()) {
+        setError("Already receiving");
+        return false;
+    }
+    if (!prepareBlockPool(num_blocks, buffer_size)) {
+        return false;
+    }
+    publishState(true, true);
+    bool success = controller_->StartReceivingBlocks(
+        [this, callback](const SampleBlockRef& block) {
+            block->metadata.flags |= takeRetuneFlag();
+            callback(block);
+            publishRxBlock(block->size, controller_->GetOverflowCount(),
+                           block->metadata.host_time_ns);
+        }, block_pool_.get());
+    if (!success) {
+        publishState(isInitialized(), isReceiving());
+        syncError();
+    }
+    return success;
+}
+
+bool USRPDevice::startReceivingInto(RxBufferProvider* provider, size_t buffer_size) {
+    if (!controller_) {
+        setError("Device not initialized");
+        return false;
+    }
+    if (!provider) {
+        setError("No RX buffer provider");
+        return false;
+    }
+    if (isReceiving()) {
+        setError("Already receiving");
+        return false;
+    }
+    counting_provider_.target_ = provider;
+    publishState(true, true);
+    bool success = controller_->StartReceivingInto(&counting_provider_, buffer_size);
+    if (!success) {
+        publishState(isInitialized(), isReceiving());
+        syncError();
+    }
+    return success;
+}
+
+void USRPDevice::CountingProvider::commit(size_t count, const SampleMetadata& metadata) {
+    SampleMetadata tagged = metadata;
+    tagged.flags |= device_.takeRetuneFlag();
+    target_->commit(count, tagged);
+    device_.publishRxBlock(count, device_.controller_->GetOverflowCount(), metadata.host_time_ns);
+}
+
 void USRPDevice::stopReceiving() {
     if (controller_) {
         controller_->StopReceiving();
     }
+    publishState(isInitialized(), false);
 }
 
 bool USRPDevice::isReceiving() const {
@@ -80,6 +152,7 @@ bool USRPDevice::setFrequency(double freq_hz, size_t channel) {
         syncError();
     } else {
         current_config_.frequency = freq_hz;
+        publishControllerTuning();
     }
     return success;
 }
@@ -94,6 +167,7 @@ bool USRPDevice::setSampleRate(double rate_sps, size_t channel) {
         syncError();
     } else {
         current_config_.sample_rate = rate_sps;
+        publishControllerTuning();
     }
     return success;
 }
@@ -108,6 +182,7 @@ bool USRPDevice::setGain(double gain_db, size_t channel) {
         syncError();
     } else {
         current_config_.gain = gain_db;
+        publishControllerTuning();
     }
     return success;
 }
@@ -122,6 +197,7 @@ bool USRPDevice::setBandwidth(double bandwidth_hz, size_t channel) {
         syncError();
     } else {
         current_config_.bandwidth = bandwidth_hz;
+        publishControllerTuning();
     }
     return success;
 }
@@ -185,24 +261,7 @@ SDRCapabilities USRPDevice::getCapabilities() const {
 }
 
 SDRStatus USRPDevice::getStatus() const {
-    SDRStatus status;
-    if (controller_) {
-        status.initialized = controller_->IsInitialized();
-        status.receiving = controller_->IsReceiving();
-        status.current_frequency = controller_->GetRxFrequency();
-        status.current_sample_rate = controller_->GetRxSampleRate();
-        status.current_gain = controller_->GetRxGain();
-        status.current_bandwidth = controller_->GetRxBandwidth();
-        status.samples_received = controller_->GetTotalSamplesReceived();
-        status.overflow_count = controller_->GetOverflowCount();
-        status.has_overflow = status.overflow_count > 0;
-		// This is fake stat
-        if (status.receiving && status.current_sample_rate > 0) {
-            double expected_samples = status.current_sample_rate * 5.0;
-            status.reception_rate = (status.samples_received / expected_samples) * 100.0;
-        }
-    }
-    return status;
+    return statusFromTelemetry();
 }
 
 size_t USRPDevice::getTotalSamplesReceived() const {
@@ -258,6 +317,11 @@ void USRPDevice::syncError() const {
     }
 }
 
+void USRPDevice::publishControllerTuning() {
+    publishTuning(controller_->GetRxFrequency(), controller_->GetRxSampleRate(),
+                  controller_->GetRxGain(), controller_->GetRxBandwidth());
+}
+
 std::vector<SDRConfig> USRPDevice::detectUSRPDevices() {
     std::vector<SDRConfig> configs;
     // TODO: Use UHD's device discovery API
@@ -20,6 +20,9 @@ public:
     
     // Rx
     bool startReceiving(SampleCallback callback, size_t buffer_size = 4096) override;
+    bool startReceivingBlocks(BlockCallback callback, size_t buffer_size = 4096,
+                              size_t num_blocks = 64) override;
+    bool startReceivingInto(RxBufferProvider* provider, size_t buffer_size = 4096) override;
     void stopReceiving() override;
     bool isReceiving() const override;
     
@@ -61,6 +64,20 @@ public:
 private:
     std::unique_ptr<UsrpController> controller_;
     SDRConfig current_config_;
+
+    // Forwards the controller's recv() spans to the consumer's provider and
+    // counts each committed block into the device telemetry
+    class CountingProvider : public RxBufferProvider {
+    public:
+        explicit CountingProvider(USRPDevice& device) : device_(device) {}
+        Span acquire(size_t max_samples) override { return target_->acquire(max_samples); }
+        void commit(size_t count, const SampleMetadata& metadata) override;
+        RxBufferProvider* target_ = nullptr;
+    private:
+        USRPDevice& device_;
+    };
+    CountingProvider counting_provider_{*this};
     
     void syncError() const;
+    void publishControllerTuning();
 };
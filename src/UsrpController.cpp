@@ -4,6 +4,7 @@
  */
 
 #include "UsrpController.h"
+#include "Logger.h"
 #include <uhd/utils/thread.hpp>
 #include <uhd/utils/safe_main.hpp>
 #include <iostream>
@@ -11,6 +12,7 @@
 #include <sstream>
 #include <thread>
 #include <chrono>
+#include <cmath>
 
 // Usrp Object
 UsrpController::UsrpController()
@@ -21,9 +23,13 @@ UsrpController::UsrpController()
 	, receiving_(false)
 	, stop_receiving_(false)
 	, receive_thread_(nullptr)
+	, block_pool_(nullptr)
+	, buffer_provider_(nullptr)
 	, buffer_size_(4096)
+	, uhd_thread_priority_(false)
 	, total_samples_received_(0)
-	, overflow_count_(0) {
+	, overflow_count_(0)
+	, rate_changed_(false) {
 }
 
 UsrpController::~UsrpController() {
@@ -191,6 +197,7 @@ bool UsrpController::SetRxSampleRate(double rate_sps, size_t channel) {
 	}
 	try {
 		usrp_device_->set_rx_rate(rate_sps, channel);
+		rate_changed_.store(true, std::memory_order_release);
 		double actual_rate = usrp_device_->get_rx_rate(channel);
 		// Check for any offset
 		if(std::abs(actual_rate - rate_sps) / rate_sps > 0.01) {
@@ -316,7 +323,7 @@ bool UsrpController::IsRxGainValid(double gain_db) const {
 void UsrpController::SetError(const std::string& error) const {
 	last_error_ = error;
 	if (!error.empty()) {
-		std::cerr << "USRP Error: " << error << std::endl;
+		LOG_ERROR("USRP Error: {}", error);
 	}
 }
 
@@ -339,12 +346,53 @@ bool UsrpController::ValidateDevice() const {
 /**************************************RX**************************************/
 
 bool UsrpController::StartReceiving(SampleCallback callback,size_t buffer_size){
-	if (!ValidateDevice()) return false;
 	if (receiving_.load()) {
 		SetError("Already receiving");
 		return false;
 	}
 	sample_callback_ = callback;
+	block_callback_ = nullptr;
+	block_pool_ = nullptr;
+	buffer_provider_ = nullptr;
+	return StartWorker(buffer_size);
+}
+
+bool UsrpController::StartReceivingBlocks(BlockCallback callback,
+		SampleBlockPool* pool) {
+	if (receiving_.load()) {
+		SetError("Already receiving");
+		return false;
+	}
+	if (!pool) {
+		SetError("No sample block pool");
+		return false;
+	}
+	sample_callback_ = nullptr;
+	block_callback_ = callback;
+	block_pool_ = pool;
+	buffer_provider_ = nullptr;
+	return StartWorker(pool->blockSamples());
+}
+
+bool UsrpController::StartReceivingInto(RxBufferProvider* provider,
+		size_t buffer_size) {
+	if (receiving_.load()) {
+		SetError("Already receiving");
+		return false;
+	}
+	if (!provider) {
+		SetError("No RX buffer provider");
+		return false;
+	}
+	sample_callback_ = nullptr;
+	block_callback_ = nullptr;
+	block_pool_ = nullptr;
+	buffer_provider_ = provider;
+	return StartWorker(buffer_size);
+}
+
+bool UsrpController::StartWorker(size_t buffer_size) {
+	if (!ValidateDevice()) return false;
 	buffer_size_ = buffer_size;
 	stop_receiving_.store(false);
 	total_samples_received_.store(0);
@@ -374,42 +422,129 @@ void UsrpController::StopReceiving() {
 		<< "\noverflows: " << overflow_count_.load() << std::endl;
 }
 
+void UsrpController::SetThreadPolicy(const ThreadPolicy& policy, bool uhd_priority) {
+	thread_policy_ = policy;
+	uhd_thread_priority_ = uhd_priority;
+}
+
 void UsrpController::ReceiveWorker() {
+	if (uhd_thread_priority_ && !uhd::set_thread_priority_safe()) {
+		LOG_WARN("UHD thread priority not granted");
+	}
+	applyThreadPolicy(thread_policy_, "usrp-rx");
 	try {
 		uhd::stream_args_t stream_args("fc32", "sc16");
 		stream_args.channels = {0};
 		auto rx_stream = usrp_device_->get_rx_stream(stream_args);
 		std::vector<std::complex<float>> buffer(buffer_size_);
 		uhd::rx_metadata_t md;
+
+		// Sample index follows the device clock when it is available so
+		// samples lost to an overflow still advance the index. The clock is
+		// measured from a base (start_time, base_index) that moves to the
+		// current block whenever the rate changes
+		rate_changed_.store(false, std::memory_order_relaxed);
+		double rate = usrp_device_->get_rx_rate();
+		uint64_t next_index = 0;
+		bool have_start_time = false;
+		double start_time = 0.0;
+		uint64_t base_index = 0;
+		uint32_t pending_flags = 0;
 		uhd::stream_cmd_t stream_cmd(
 				uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
 		stream_cmd.stream_now = true;
 		rx_stream->issue_stream_cmd(stream_cmd);
-		std::cout << "Rx worker start" << std::endl;
+		LOG_INFO("Rx worker start");
 		while (!stop_receiving_.load()) {
-			size_t num_rx_samps = rx_stream->recv(&buffer.front(),
-					buffer_size_, md, 1.0);
+			// Block and provider modes receive in place; scratch only if
+			// the consumer has no room
+			SampleBlockRef block;
+			RxBufferProvider::Span span;
+			std::complex<float>* dest = buffer.data();
+			size_t max_samps = buffer_size_;
+			if (block_callback_) {
+				block = block_pool_->acquire();
+				if (block) dest = block->data;
+			} else if (buffer_provider_) {
+				span = buffer_provider_->acquire(buffer_size_);
+				if (span.data && span.size > 0) {
+					dest = span.data;
+					max_samps = span.size;
+				}
+			}
+			size_t num_rx_samps = rx_stream->recv(dest,
+					max_samps, md, 1.0);
+			int64_t host_time_ns = monotonicTimeNs();
 
 			// Timeouts may or may not be okay, who the fuck knows
 			if (md.error_code == uhd::rx_metadata_t::ERROR_CODE_TIMEOUT) {
 				continue;
 			}
 			if (md.error_code == uhd::rx_metadata_t::ERROR_CODE_OVERFLOW) {
+				pending_flags |= SampleMetadata::DEVICE_OVERFLOW | SampleMetadata::DISCONTINUITY;
 				overflow_count_.fetch_add(1);
-				std::cout << "Overflow count: " << overflow_count_.load() << 
-					std::endl;
+				LOG_WARN("Overflow count: {}", overflow_count_.load());
 				continue;
 			}
 			if (md.error_code != uhd::rx_metadata_t::ERROR_CODE_NONE) {
-                std::cout << "Debug: error_code = " << (int)md.error_code
-                         << ", strerror = '" << md.strerror() << "'" << std::endl;
+                LOG_DEBUG("Debug: error_code = {}, strerror = '{}'", (int)md.error_code, md.strerror());
 
                 SetError("Receive error code " + std::to_string((int)md.error_code) + ": " + md.strerror());
+                pending_flags |= SampleMetadata::DISCONTINUITY;
                 continue;
             }
-			if (sample_callback_ && num_rx_samps > 0) {
-				sample_callback_(buffer.data(), num_rx_samps);
+			if (num_rx_samps == 0) {
+				continue;
+			}
+
+			SampleMetadata meta;
+			meta.host_time_ns = host_time_ns;
+			meta.sample_index = next_index;
+			if (md.has_time_spec) {
+				meta.device_time = md.time_spec.get_real_secs();
+				meta.flags |= SampleMetadata::HAS_DEVICE_TIME;
+				if (rate_changed_.exchange(false, std::memory_order_acq_rel)) {
+					// Counted at the old rate up to here, the new one from here
+					rate = usrp_device_->get_rx_rate();
+					have_start_time = false;
+				}
+				if (!have_start_time) {
+					start_time = meta.device_time;
+					base_index = next_index;
+					have_start_time = true;
+				}
+				double offset = meta.device_time - start_time;
+				if (offset < 0.0) {
+					// Device clock went backwards (time reset), restart from here
+					start_time = meta.device_time;
+					base_index = next_index;
+					offset = 0.0;
+					meta.flags |= SampleMetadata::DISCONTINUITY;
+				}
+				uint64_t index = base_index + static_cast<uint64_t>(std::llround(offset * rate));
+				if (index != next_index) {
+					meta.flags |= SampleMetadata::DISCONTINUITY;
+					meta.sample_index = index;
+				}
+			}
+			meta.flags |= pending_flags;
+			pending_flags = 0;
+			next_index = meta.sample_index + num_rx_samps;
+
+			if (block) {
+				block->size = num_rx_samps;
+				block->metadata = meta;
+				block_callback_(block);
+				total_samples_received_.fetch_add(num_rx_samps);
+			} else if (dest == span.data) {
+				buffer_provider_->commit(num_rx_samps, meta);
+				total_samples_received_.fetch_add(num_rx_samps);
+			} else if (sample_callback_) {
+				sample_callback_(buffer.data(), num_rx_samps, meta);
 				total_samples_received_.fetch_add(num_rx_samps);
+			} else if (block_callback_ || buffer_provider_) {
+				// Consumer had no room, this block's samples are gone
+				pending_flags |= SampleMetadata::DISCONTINUITY;
 			}
 		}
 		stream_cmd.stream_mode = uhd::stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS;
@@ -417,5 +552,5 @@ void UsrpController::ReceiveWorker() {
 	} catch (const std::exception& e) {
 		SetError("Receive thread error" + std::string(e.what()));
 	}
-	std::cout << "Rx worker done" << std::endl;
+	LOG_INFO("Rx worker done");
 }
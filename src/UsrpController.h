@@ -9,6 +9,11 @@
 #include <uhd/usrp/multi_usrp.hpp>
 #include <uhd/exception.hpp>
 
+#include "SampleBlockPool.h"
+#include "SampleMetadata.h"
+#include "RxBufferProvider.h"
+#include "ThreadTuning.h"
+
 class UsrpController {
 public:
 	UsrpController();
@@ -49,10 +54,19 @@ public:
 	bool IsRxGainValid(double gain_db) const;	
 
 	// Receiver
-	using SampleCallback = std::function<void(const std::complex<float>*, size_t)>;
+	using SampleCallback = std::function<void(const std::complex<float>*, size_t,
+			const SampleMetadata&)>;
 	bool StartReceiving(SampleCallback callback, size_t buffer_size = 4096);
+	// Zero-copy: recv() writes straight into blocks taken from pool
+	using BlockCallback = std::function<void(const SampleBlockRef&)>;
+	bool StartReceivingBlocks(BlockCallback callback, SampleBlockPool* pool);
+	// recv() writes into spans from provider, only received samples are committed
+	bool StartReceivingInto(RxBufferProvider* provider, size_t buffer_size = 4096);
 	bool IsReceiving() const { return receiving_.load(); };
 	void StopReceiving();
+	// Applied by the receive thread when it starts; uhd_priority first asks
+	// UHD for its usual real-time boost, an explicit fifo_priority wins over it
+	void SetThreadPolicy(const ThreadPolicy& policy, bool uhd_priority);
 
 	// Receiver getters
 	size_t GetTotalSamplesReceived() const { return total_samples_received_.load(); };
@@ -75,14 +89,22 @@ private:
 	// Receiver
 	std::atomic<size_t> total_samples_received_;
 	std::atomic<size_t> overflow_count_;
+	// Set by SetRxSampleRate, taken by the receive thread to rebase its index
+	std::atomic<bool> rate_changed_;
 	SampleCallback sample_callback_;
+	BlockCallback block_callback_;
+	SampleBlockPool* block_pool_;
+	RxBufferProvider* buffer_provider_;
 	size_t buffer_size_;
+	ThreadPolicy thread_policy_;
+	bool uhd_thread_priority_;
 
 	// Error tracker
 	mutable std::string last_error_;
 
 	// Helpers
 	void SetError(const std::string& error) const;
+	bool StartWorker(size_t buffer_size);
 	void ReceiveWorker();
 	bool ValidateChannel(size_t channel) const;
 	bool ValidateDevice() const;
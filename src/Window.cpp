@@ -0,0 +1,131 @@
+#include "Window.h"
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <stdexcept>
+
+namespace {
+
+struct WindowInfo {
+    WindowType type;
+    const char* name;
+    const char* option;
+};
+
+const WindowInfo WINDOWS[] = {
+    {WindowType::Rectangular,    "Rectangular",     "rectangular"},
+    {WindowType::Hann,           "Hann",            "hann"},
+    {WindowType::Blackman,       "Blackman",        "blackman"},
+    {WindowType::BlackmanHarris, "Blackman-Harris", "blackman-harris"},
+    {WindowType::FlatTop,        "Flat-top",        "flattop"},
+    {WindowType::Kaiser,         "Kaiser",          "kaiser"},
+};
+
+// w[n] = sum_k (-1)^k a[k] cos(2 pi k n / N)
+void cosineSum(std::vector<float>& w, std::initializer_list<double> a) {
+    const double n_total = static_cast<double>(w.size());
+    for (size_t n = 0; n < w.size(); ++n) {
+        double sum = 0.0;
+        double sign = 1.0;
+        int k = 0;
+        for (double coefficient : a) {
+            sum += sign * coefficient * std::cos(2.0 * M_PI * k * n / n_total);
+            sign = -sign;
+            ++k;
+        }
+        w[n] = static_cast<float>(sum);
+    }
+}
+
+// Modified Bessel function of the first kind, order 0, by its power series
+double besselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    const double quarter_x2 = 0.25 * x * x;
+    for (int k = 1; term > 1e-12 * sum; ++k) {
+        term *= quarter_x2 / (static_cast<double>(k) * k);
+        sum += term;
+    }
+    return sum;
+}
+
+void kaiser(std::vector<float>& w, double beta) {
+    const double n_total = static_cast<double>(w.size());
+    const double scale = 1.0 / besselI0(beta);
+    for (size_t n = 0; n < w.size(); ++n) {
+        double r = 2.0 * n / n_total - 1.0;
+        w[n] = static_cast<float>(besselI0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) * scale);
+    }
+}
+
+}
+
+WindowTable makeWindowTable(WindowType type, int size, float kaiser_beta) {
+    if (size <= 0) {
+        throw std::invalid_argument("Window size must be positive");
+    }
+    WindowTable table;
+    table.type = type;
+    table.coefficients.assign(size, 1.0f);
+    std::vector<float>& w = table.coefficients;
+
+    switch (type) {
+        case WindowType::Rectangular:
+            break;
+        case WindowType::Hann:
+            cosineSum(w, {0.5, 0.5});
+            break;
+        case WindowType::Blackman:
+            cosineSum(w, {0.42, 0.5, 0.08});
+            break;
+        case WindowType::BlackmanHarris:
+            cosineSum(w, {0.35875, 0.48829, 0.14128, 0.01168});
+            break;
+        case WindowType::FlatTop:
+            cosineSum(w, {0.21557895, 0.41663158, 0.277263158, 0.083578947, 0.006947368});
+            break;
+        case WindowType::Kaiser:
+            kaiser(w, kaiser_beta);
+            break;
+    }
+
+    double sum = 0.0;
+    double sum_squares = 0.0;
+    for (float v : w) {
+        sum += v;
+        sum_squares += static_cast<double>(v) * v;
+    }
+    table.coherent_gain = static_cast<float>(sum / size);
+    table.power_gain = static_cast<float>(sum_squares / size);
+    return table;
+}
+
+const char* windowName(WindowType type) {
+    for (const WindowInfo& info : WINDOWS) {
+        if (info.type == type) {
+            return info.name;
+        }
+    }
+    return "Unknown";
+}
+
+bool parseWindowType(const std::string& name, WindowType& type) {
+    for (const WindowInfo& info : WINDOWS) {
+        if (name == info.option) {
+            type = info.type;
+            return true;
+        }
+    }
+    return false;
+}
+
+const std::vector<WindowType>& windowTypes() {
+    static const std::vector<WindowType> types = []() {
+        std::vector<WindowType> all;
+        for (const WindowInfo& info : WINDOWS) {
+            all.push_back(info.type);
+        }
+        return all;
+    }();
+    return types;
+}
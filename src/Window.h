@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * Analysis windows for the spectrum analyzer, tapering each frame so a
+ * strong tone's leakage doesn't bury weak signals next to it.
+ * Rectangular is no window at all, the old behaviour.
+ */
+enum class WindowType {
+    Rectangular,
+    Hann,
+    Blackman,
+    BlackmanHarris,     // 4-term, -92 dB sidelobes
+    FlatTop,            // Amplitude accurate to ~0.01 dB anywhere in a bin
+    Kaiser
+};
+
+/**
+ * Coefficients of one window, computed once per analyzer and then only read
+ * Tables are periodic (DFT-even): w[n] = w[size - n], the form whose
+ * spectrum has its nulls on bin centres.
+ */
+struct WindowTable {
+    static constexpr float DEFAULT_KAISER_BETA = 8.6f;   // Sidelobes near Blackman's
+
+    WindowType type = WindowType::Rectangular;
+    std::vector<float> coefficients;
+    float coherent_gain = 1.0f;     // mean(w): scales a bin centred tone's amplitude
+    float power_gain = 1.0f;        // mean(w^2): scales noise power
+
+    // Equivalent noise bandwidth in bins
+    float enbw() const { return power_gain / (coherent_gain * coherent_gain); }
+};
+
+WindowTable makeWindowTable(WindowType type, int size,
+                            float kaiser_beta = WindowTable::DEFAULT_KAISER_BETA);
+
+// Display name, e.g. "Blackman-Harris"
+const char* windowName(WindowType type);
+
+// From the command line spelling (rectangular, hann, blackman, blackman-harris,
+// flattop, kaiser); false if unknown
+bool parseWindowType(const std::string& name, WindowType& type);
+
+// Every window, in menu order
+const std::vector<WindowType>& windowTypes();
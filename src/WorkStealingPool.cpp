@@ -0,0 +1,143 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+#include <string>
+#include <pthread.h>
+
+WorkStealingPool::WorkStealingPool(size_t num_workers, const ThreadPolicy& policy)
+    : policy_(policy) {
+    num_workers = std::max<size_t>(num_workers, 1);
+    for (size_t i = 0; i < num_workers; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+
+    try {
+        for (size_t i = 0; i + 1 < num_workers; ++i) {
+            threads_.emplace_back(&WorkStealingPool::runThread, this, i);
+            std::string name = "osprey-pool" + std::to_string(i);
+            pthread_setname_np(threads_.back().native_handle(), name.c_str());
+        }
+    } catch (...) {
+        shutdown();
+        throw;
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    shutdown();
+}
+
+void WorkStealingPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+    threads_.clear();
+}
+
+void WorkStealingPool::parallelFor(size_t count, size_t grain, const RangeTask& task) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    const size_t num_chunks = (count + grain - 1) / grain;
+    const size_t workers = queues_.size();
+
+    // Worker indices (and the per-worker scratch callers key on them) stay
+    // exclusive across callers, so the inline path serializes too
+    std::lock_guard<std::mutex> run_lock(run_mutex_);
+
+    // Nothing to share, skip the handoff
+    if (workers == 1 || num_chunks == 1) {
+        task(0, count, workers - 1);
+        return;
+    }
+
+    task_ = &task;
+    pending_.store(num_chunks, std::memory_order_relaxed);
+
+    // Deal contiguous runs of chunks so each worker starts on its own region
+    for (size_t w = 0; w < workers; ++w) {
+        Queue& queue = *queues_[w];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.chunks.clear();
+        size_t first = w * num_chunks / workers;
+        size_t last = (w + 1) * num_chunks / workers;
+        for (size_t c = first; c < last; ++c) {
+            queue.chunks.push_back({c * grain, std::min((c + 1) * grain, count)});
+        }
+        queue.head = 0;
+        queue.tail = queue.chunks.size();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        generation_++;
+    }
+    wake_.notify_all();
+
+    // Help until the queues run dry, then wait out chunks still in flight
+    while (runOne(workers - 1)) {
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this]() { return pending_.load(std::memory_order_acquire) == 0; });
+    task_ = nullptr;
+}
+
+bool WorkStealingPool::takeChunk(size_t worker, Chunk& chunk) {
+    {
+        Queue& own = *queues_[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.head < own.tail) {
+            chunk = own.chunks[own.head++];
+            return true;
+        }
+    }
+
+    const size_t workers = queues_.size();
+    for (size_t i = 1; i < workers; ++i) {
+        Queue& victim = *queues_[(worker + i) % workers];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.head < victim.tail) {
+            chunk = victim.chunks[--victim.tail];
+            steals_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WorkStealingPool::runOne(size_t worker) {
+    Chunk chunk;
+    if (!takeChunk(worker, chunk)) {
+        return false;
+    }
+    // task_ was set before the chunk was queued, the queue lock orders it
+    (*task_)(chunk.begin, chunk.end, worker);
+
+    if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        done_.notify_all();
+    }
+    return true;
+}
+
+void WorkStealingPool::runThread(size_t worker) {
+    applyThreadPolicy(policy_, "osprey-pool" + std::to_string(worker));
+    uint64_t seen = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this, seen]() { return stop_ || generation_ != seen; });
+            if (stop_) {
+                return;
+            }
+            seen = generation_;
+        }
+        while (runOne(worker)) {
+        }
+    }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ThreadTuning.h"
+
+/**
+ * Fork-join pool for data-parallel loops such as per-frame STFT work
+ *
+ * parallelFor() cuts [0, count) into chunks of grain items and deals each
+ * worker a contiguous run of them. Workers take their own chunks in order
+ * and, once out, steal single chunks from the far end of another worker's
+ * queue, so uneven chunks or a preempted thread only cost the tail. The
+ * calling thread takes part as the last worker and returns when every chunk
+ * has run.
+ *
+ * The task receives the worker index alongside its range so callers can keep
+ * per-worker scratch without locking. Which worker runs which chunk is not
+ * deterministic; results must depend on the range only. One parallelFor()
+ * runs at a time, further callers wait; the task must not throw or call
+ * back into the pool.
+ */
+class WorkStealingPool {
+public:
+    using RangeTask = std::function<void(size_t begin, size_t end, size_t worker)>;
+
+    // Spawns num_workers - 1 threads, the caller is the remaining worker
+    explicit WorkStealingPool(size_t num_workers, const ThreadPolicy& policy = ThreadPolicy());
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void parallelFor(size_t count, size_t grain, const RangeTask& task);
+
+    // Worker indices passed to tasks are below this
+    size_t numWorkers() const { return queues_.size(); }
+
+    // Chunks run by a worker other than the one they were dealt to
+    uint64_t steals() const { return steals_.load(std::memory_order_relaxed); }
+
+private:
+    struct Chunk {
+        size_t begin;
+        size_t end;
+    };
+
+    // Owner pops at head, thieves at tail
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::vector<Chunk> chunks;
+        size_t head = 0;
+        size_t tail = 0;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+    ThreadPolicy policy_;
+
+    std::mutex run_mutex_;                  // Serializes parallelFor() callers
+    std::mutex mutex_;
+    std::condition_variable wake_;          // New job or stop
+    std::condition_variable done_;          // Last chunk finished
+    uint64_t generation_ = 0;               // Bumped per job, under mutex_
+    bool stop_ = false;
+
+    const RangeTask* task_ = nullptr;       // Valid while chunks are pending
+    std::atomic<size_t> pending_{0};
+    std::atomic<uint64_t> steals_{0};
+
+    bool takeChunk(size_t worker, Chunk& chunk);
+    bool runOne(size_t worker);
+    void runThread(size_t worker);
+    void shutdown();
+};
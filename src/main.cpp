@@ -16,6 +16,7 @@
 
 #include "USRPDevice.h"
 #include "SimulationDevice.h"
+#include "SpectrumKernels.h"
 
 #include "theme.h"
 
@@ -41,6 +42,9 @@ int main(int argc, char* argv[]) {
     std::string mode_str;
     bool list_devices = false;
     bool auto_detect = false;
+    bool no_governor = false;
+    std::string window_name;
+    std::string rx_cpus, dsp_cpus, gui_cpus;
     
     po::options_description desc("Signal Processing Application - SDR GUI");
     desc.add_options()
@@ -69,6 +73,38 @@ int main(int argc, char* argv[]) {
         // Performance options
         ("buffer-size", po::value<size_t>(&config.buffer_size)->default_value(8192),
          "Buffer size in samples")
+        ("dsp-workers", po::value<size_t>(&config.dsp_workers)->default_value(1),
+         "DSP threads off the RX thread (0 = analyzer in the RX callback, 2 = separate STFT thread)")
+        ("stft-interval", po::value<int>(&config.stft_interval_ms)->default_value(500),
+         "Milliseconds between RFML spectrogram images (20-5000)")
+        ("stft-threads", po::value<size_t>(&config.stft_threads)->default_value(0),
+         "Threads sharing the STFT frames (0 = serial)")
+        ("fft-size", po::value<int>(&config.fft_size)->default_value(0),
+         "Analyzer FFT size, power of two 256-65536 (0 = largest that keeps up)")
+        ("window", po::value<std::string>(&window_name)->default_value("blackman"),
+         "Analyzer window: rectangular, hann, blackman, blackman-harris, flattop, kaiser")
+        ("no-governor", po::bool_switch(&no_governor),
+         "Keep full display quality even when the pipeline falls behind")
+        
+        // Thread placement and scheduling
+        ("rx-cpus", po::value<std::string>(&rx_cpus),
+         "Cores for the RX thread (e.g., 2 or 2,3 or 4-7)")
+        ("dsp-cpus", po::value<std::string>(&dsp_cpus),
+         "Cores for the DSP workers and STFT pool")
+        ("gui-cpus", po::value<std::string>(&gui_cpus),
+         "Cores for the GUI render loop")
+        ("rx-fifo", po::value<int>(&config.rx_thread.fifo_priority)->default_value(0),
+         "SCHED_FIFO priority for the RX thread (1-99, 0 = normal scheduling)")
+        ("dsp-fifo", po::value<int>(&config.dsp_threads.fifo_priority)->default_value(0),
+         "SCHED_FIFO priority for the DSP threads (1-99, 0 = normal scheduling)")
+        ("rx-nice", po::value<int>(&config.rx_thread.nice)->default_value(0),
+         "Nice level for the RX thread without SCHED_FIFO")
+        ("dsp-nice", po::value<int>(&config.dsp_threads.nice)->default_value(0),
+         "Nice level for the DSP threads without SCHED_FIFO")
+        ("gui-nice", po::value<int>(&config.gui_thread.nice)->default_value(0),
+         "Nice level for the GUI thread")
+        ("uhd-thread-priority", po::bool_switch(&config.uhd_thread_priority),
+         "Let UHD raise the USRP RX thread's priority (uhd::set_thread_priority_safe)")
         
         // Legacy option for backward compatibility
         ("mode", po::value<std::string>(&mode_str)->default_value(""),
@@ -79,6 +115,26 @@ int main(int argc, char* argv[]) {
         po::store(po::parse_command_line(argc, argv, desc), vm);
         po::notify(vm);
         
+        // Core lists
+        const std::pair<std::string*, ThreadPolicy*> cpu_options[] = {
+            {&rx_cpus, &config.rx_thread},
+            {&dsp_cpus, &config.dsp_threads},
+            {&gui_cpus, &config.gui_thread},
+        };
+        for (const auto& option : cpu_options) {
+            if (!option.first->empty() && !parseCpuList(*option.first, option.second->cpus)) {
+                throw po::error("invalid core list '" + *option.first + "'");
+            }
+        }
+        if (config.fft_size != 0 && (config.fft_size < 256 || config.fft_size > 65536 ||
+                                     (config.fft_size & (config.fft_size - 1)) != 0)) {
+            throw po::error("invalid FFT size " + std::to_string(config.fft_size));
+        }
+        if (!parseWindowType(window_name, config.window)) {
+            throw po::error("invalid window '" + window_name + "'");
+        }
+        config.budget_governor = !no_governor;
+        
         // Help
         if (vm.count("help")) {
             std::cout << "\n" << desc << std::endl;
@@ -158,6 +214,18 @@ int main(int argc, char* argv[]) {
         std::cout << "  Bandwidth:   " << config.bandwidth / 1e6 << " MHz" << std::endl;
     }
     std::cout << "  Buffer size: " << config.buffer_size << " samples" << std::endl;
+    std::cout << "  DSP workers: " << config.dsp_workers << std::endl;
+    std::cout << "  FFT size:    " << (config.fft_size ? std::to_string(config.fft_size) : "auto")
+              << (config.budget_governor ? ", budget governor on" : ", budget governor off") << std::endl;
+    std::cout << "  Window:      " << windowName(config.window) << std::endl;
+    std::cout << "  dB kernels:  " << spectrumKernels().name << std::endl;
+    if (config.stft_threads > 1) {
+        std::cout << "  STFT threads: " << config.stft_threads << std::endl;
+    }
+    std::cout << "  RX thread:   " << describeThreadPolicy(config.rx_thread)
+              << (config.uhd_thread_priority ? ", UHD priority" : "") << std::endl;
+    std::cout << "  DSP threads: " << describeThreadPolicy(config.dsp_threads) << std::endl;
+    std::cout << "  GUI thread:  " << describeThreadPolicy(config.gui_thread) << std::endl;
     std::cout << std::endl;
     
     // GLFW initialization
@@ -222,6 +290,10 @@ int main(int argc, char* argv[]) {
         }
     }
     
+    // Pin the render loop only now: device and UHD threads created during
+    // initialization keep the process-wide affinity
+    applyThreadPolicy(config.gui_thread, "gui");
+    
     // Main loop
     while (!glfwWindowShouldClose(window)) {
         // Poll events